@@ -1,4 +1,4 @@
-from .jlist import jlist  # noqa
+from .jlist import frozenjlist, jlist  # noqa
 from .ops import *  # noqa
 from .patch import (  # noqa
     overloaded_literals,
@@ -6,3 +6,13 @@ from .patch import (  # noqa
     patch_builtins,
     patch_literals,
 )
+from .table import jtable  # noqa
+from .categorical import categorical  # noqa
+from .compressed import compress, compressed, decompress  # noqa
+from .sketch import (  # noqa
+    approx_distinct,
+    approx_quantiles,
+    distinct_sketch,
+    quantile_sketch,
+)
+from .lazy import lazy  # noqa
@@ -0,0 +1,165 @@
+import jlist as jl
+
+
+class categorical:
+    """A dictionary encoded sequence of values.
+
+    The distinct values are stored once in ``categories`` and each position
+    holds an unboxed ``int`` code into ``categories``. This is much smaller than
+    a ``jlist`` of objects when there are few distinct values, and lookups like
+    ``count`` and ``index`` compare codes instead of objects.
+
+    Parameters
+    ----------
+    values : iterable
+        The values to encode. They must be hashable.
+
+    Examples
+    --------
+    >>> levels = categorical(['info', 'warn', 'info', 'error'])
+    >>> levels.codes
+    jlist([0, 1, 0, 2])
+
+    >>> levels.categories
+    jlist(['info', 'warn', 'error'])
+
+    >>> levels.count('info')
+    2
+    """
+    __slots__ = '_codes', '_categories', '_lookup'
+
+    def __init__(self, values=()):
+        codes, categories = jl.factorize(values)
+        self._init(codes, categories)
+
+    def _init(self, codes, categories):
+        self._codes = codes
+        self._categories = categories
+        self._lookup = None
+
+    @classmethod
+    def from_codes(cls, codes, categories):
+        """Build a categorical from codes into a sequence of distinct values.
+
+        Parameters
+        ----------
+        codes : iterable[int]
+            The index into ``categories`` of each value.
+        categories : iterable
+            The distinct values.
+
+        Returns
+        -------
+        categorical : categorical
+            The new categorical.
+        """
+        codes = jl.jlist(codes)
+        categories = jl.jlist(categories)
+        if len(codes) and (min(codes) < 0 or max(codes) >= len(categories)):
+            raise ValueError('codes must be in range(len(categories))')
+
+        self = cls.__new__(cls)
+        self._init(codes, categories)
+        return self
+
+    @property
+    def codes(self):
+        """The ``int`` ``jlist`` of codes into ``categories``.
+        """
+        return self._codes
+
+    @property
+    def categories(self):
+        """The ``jlist`` of distinct values.
+        """
+        return self._categories
+
+    def _code(self, value):
+        """Look up the code of ``value``, or ``None`` if it is not a category.
+        """
+        lookup = self._lookup
+        if lookup is None:
+            lookup = self._lookup = {
+                category: code for code, category in enumerate(self._categories)
+            }
+        try:
+            return lookup.get(value)
+        except TypeError:
+            # an unhashable value may still compare equal to a category
+            for code, category in enumerate(self._categories):
+                if category == value:
+                    return code
+            return None
+
+    def decode(self):
+        """Expand the categorical into a ``jlist`` of its values.
+        """
+        return jl.take(self._categories, self._codes)
+
+    def __len__(self):
+        return len(self._codes)
+
+    def __iter__(self):
+        return iter(self.decode())
+
+    def __getitem__(self, ix):
+        if isinstance(ix, slice):
+            return type(self).from_codes(self._codes[ix], self._categories)
+        return self._categories[self._codes[ix]]
+
+    def __contains__(self, value):
+        code = self._code(value)
+        return code is not None and code in self._codes
+
+    def count(self, value):
+        """Return the number of occurrences of ``value``.
+        """
+        code = self._code(value)
+        if code is None:
+            return 0
+        return self._codes.count(code)
+
+    def index(self, value):
+        """Return the first index of ``value``.
+
+        Raises
+        ------
+        ValueError
+            Raised when ``value`` is not present.
+        """
+        code = self._code(value)
+        if code is not None:
+            try:
+                return self._codes.index(code)
+            except ValueError:
+                pass
+        raise ValueError(f'{value!r} is not in categorical')
+
+    def sort(self, *, reverse=False):
+        """Sort the values in place.
+
+        The categories are sorted and the codes are renumbered to match, so
+        sorting the values is a sort of the unboxed codes.
+        """
+        order = jl.argsort(self._categories)
+        rank = jl.zeros(len(order))
+        for new_code, old_code in enumerate(order):
+            rank[old_code] = new_code
+
+        codes = jl.take(rank, self._codes)
+        codes.sort()
+        if reverse:
+            codes = codes[::-1]
+        self._init(codes, jl.take(self._categories, order))
+
+    def __eq__(self, other):
+        if isinstance(other, categorical):
+            if self._categories == other._categories:
+                return self._codes == other._codes
+            other = other.decode()
+        elif not isinstance(other, (list, jl.jlist)):
+            return NotImplemented
+        return len(self) == len(other) and self.decode() == jl.jlist(other)
+
+    def __repr__(self):
+        return f'{type(self).__name__}({list(self)!r})'
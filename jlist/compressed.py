@@ -0,0 +1,146 @@
+import jlist as jl
+from .ops import _decode_blocks, _encode_blocks
+
+
+class compressed:
+    """A read-only, compressed copy of an ``int`` or ``float`` ``jlist``.
+
+    The values are split into blocks which are compressed independently: ints
+    are delta encoded and bit-packed, and floats are XOR encoded against their
+    neighbour. Reductions, iteration, indexing, and slicing decompress one block
+    at a time instead of the whole list.
+
+    Parameters
+    ----------
+    values : iterable[int] or iterable[float]
+        The values to compress.
+    block_size : int, optional
+        The number of values in each block.
+
+    Examples
+    --------
+    >>> c = compressed(range(1000000))
+    >>> c.nbytes < 8 * len(c)
+    True
+
+    >>> c.sum()
+    499999500000
+
+    >>> c[10:13]
+    jlist([10, 11, 12])
+    """
+    __slots__ = '_tag', '_blocks', '_block_size', '_len'
+
+    def __init__(self, values, *, block_size=1024):
+        values = values if type(values) is jl.jlist else jl.jlist(values)
+        self._tag, self._blocks = _encode_blocks(values, block_size)
+        self._block_size = block_size
+        self._len = len(values)
+
+    @property
+    def tag(self):
+        """The tag of the decompressed values: ``'int'`` or ``'double'``.
+        """
+        return self._tag
+
+    @property
+    def nbytes(self):
+        """The number of bytes used by the compressed blocks.
+        """
+        return sum(map(len, self._blocks))
+
+    def _block(self, ix):
+        return _decode_blocks(self._tag, self._blocks[ix:ix + 1])
+
+    def decompress(self):
+        """Decompress all of the values into a new ``jlist``.
+        """
+        return _decode_blocks(self._tag, self._blocks)
+
+    def sum(self, start=0):
+        """Return the sum of the values plus ``start``.
+
+        Equivalent to ``jl.sum(self.decompress(), start)``.
+        """
+        total = start
+        for ix in range(len(self._blocks)):
+            total = jl.sum(self._block(ix), total)
+        return total
+
+    def __len__(self):
+        return self._len
+
+    def __iter__(self):
+        for ix in range(len(self._blocks)):
+            yield from self._block(ix)
+
+    def __getitem__(self, ix):
+        if isinstance(ix, slice):
+            indices = range(self._len)[ix]
+            if not indices:
+                return jl.jlist()
+
+            # only decompress the blocks which hold the selected values
+            low = min(indices[0], indices[-1])
+            high = max(indices[0], indices[-1]) + 1
+            first_block = low // self._block_size
+            last_block = (high - 1) // self._block_size + 1
+            values = _decode_blocks(
+                self._tag,
+                self._blocks[first_block:last_block],
+            )
+            offset = first_block * self._block_size
+            return jl.take(values, jl.range(indices.start - offset,
+                                            indices.stop - offset,
+                                            indices.step))
+
+        ix = range(self._len)[ix]
+        block, offset = divmod(ix, self._block_size)
+        return self._block(block)[offset]
+
+    def __reduce__(self):
+        return compress, (self.decompress(), self._block_size)
+
+    def __repr__(self):
+        return (
+            f'<{type(self).__name__} {self._tag} len={self._len}'
+            f' nbytes={self.nbytes}>'
+        )
+
+
+def compress(values, block_size=1024):
+    """Compress an ``int`` or ``float`` ``jlist``.
+
+    Parameters
+    ----------
+    values : iterable[int] or iterable[float]
+        The values to compress.
+    block_size : int, optional
+        The number of values in each independently compressed block.
+
+    Returns
+    -------
+    compressed : compressed
+        The compressed values.
+
+    See Also
+    --------
+    jlist.compressed
+    """
+    return compressed(values, block_size=block_size)
+
+
+def decompress(compressed):
+    """Decompress values compressed with ``jlist.compress``.
+
+    Parameters
+    ----------
+    compressed : compressed
+        The compressed values.
+
+    Returns
+    -------
+    values : jlist
+        The decompressed values.
+    """
+    return compressed.decompress()
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <Python.h>
+
+#include "jlist/mix64.h"
+
+namespace jl {
+/** An open addressing hash table from int64 keys to non-negative positions.
+ */
+class int_hash_table {
+private:
+    struct slot_type {
+        std::int64_t key;
+        Py_ssize_t value;
+    };
+
+    // keys and values are stored together so that a probe touches one cache line
+    std::vector<slot_type> m_slots;
+    std::size_t m_size = 0;
+
+    static std::size_t hash(std::int64_t key) {
+        // mix the key so that keys which differ only in their high bits don't collide
+        // under the mask
+        return mix64(key);
+    }
+
+    std::size_t slot(std::int64_t key) const {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t ix = hash(key) & mask;
+        while (m_slots[ix].value >= 0 && m_slots[ix].key != key) {
+            ix = (ix + 1) & mask;
+        }
+        return ix;
+    }
+
+    void grow() {
+        std::vector<slot_type> slots(m_slots.size() * 2, slot_type{0, -1});
+        std::swap(slots, m_slots);
+        for (const slot_type& s : slots) {
+            if (s.value >= 0) {
+                m_slots[slot(s.key)] = s;
+            }
+        }
+    }
+
+public:
+    int_hash_table() : m_slots(16, slot_type{0, -1}) {}
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    /** Look up `key`, inserting it with `value` if it is not already in the table.
+        Returns the value stored for `key`.
+     */
+    Py_ssize_t insert(std::int64_t key, Py_ssize_t value) {
+        std::size_t ix = slot(key);
+        if (m_slots[ix].value >= 0) {
+            return m_slots[ix].value;
+        }
+        if (2 * (m_size + 1) > m_slots.size()) {
+            grow();
+            ix = slot(key);
+        }
+        m_slots[ix] = {key, value};
+        ++m_size;
+        return value;
+    }
+
+    /** Look up `key`, returning -1 if it is not in the table.
+     */
+    Py_ssize_t find(std::int64_t key) const {
+        return m_slots[slot(key)].value;
+    }
+};
+}  // namespace jl
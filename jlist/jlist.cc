@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <array>
 #include <charconv>
+#include <cmath>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -19,6 +20,23 @@
 
 namespace jl {
 extern PyTypeObject jlist_type;
+extern PyTypeObject frozen_jlist_type;
+
+namespace iterobject {
+struct jlist_iter {
+    PyObject base;
+    Py_ssize_t ix;
+    jlist* list;
+};
+
+extern PyTypeObject type;
+}  // namespace iterobject
+
+namespace reviterobject {
+using iterobject::jlist_iter;
+
+extern PyTypeObject type;
+}  // namespace reviterobject
 
 template<typename UnboxedType>
 bool box_values(jlist& list) {
@@ -37,10 +55,10 @@ bool box_values(jlist& list) {
 
     if (unwind) {
         for (Py_ssize_t unwind_ix = 0; unwind_ix < ix; ++unwind_ix) {
-            PyObject* boxed = list.entries[ix].as_ob;
+            PyObject* boxed = list.entries[unwind_ix].as_ob;
             UnboxedType unboxed = unbox_value<UnboxedType>(boxed);
             Py_DECREF(boxed);
-            entry_value<UnboxedType>(list.entries[ix]) = unboxed;
+            entry_value<UnboxedType>(list.entries[unwind_ix]) = unboxed;
         }
     }
 
@@ -150,6 +168,37 @@ entry* get_entry(jlist& self, Py_ssize_t ix) {
     return &self.entries[ix];
 }
 
+/** Frozen jlists inherit the jlist methods, so `jlist.append(frozen, 1)` would
+    otherwise change a list whose hash is cached. Returns true with an exception
+    raised if `self` is frozen.
+ */
+bool check_mutable(PyObject* self) {
+    if (PyObject_TypeCheck(self, &frozen_jlist_type)) {
+        PyErr_SetString(PyExc_TypeError, "frozenjlist is immutable");
+        return true;
+    }
+    return false;
+}
+
+/** Return a new reference to the value stored in `e`, an entry of the non-empty
+    list `self`.
+ */
+PyObject* box_entry(const jlist& self, const entry& e) {
+    switch (self.tag()) {
+    case entry_tag::as_homogeneous_ob:
+    case entry_tag::as_heterogeneous_ob:
+        Py_INCREF(e.as_ob);
+        return e.as_ob;
+    case entry_tag::as_int:
+        return box_value(e.as_int);
+    case entry_tag::as_double:
+        return box_value(e.as_double);
+    default:
+        // entry_tag::unset means the list is empty, so there is no `e`
+        __builtin_unreachable();
+    }
+}
+
 template<typename T>
 bool box_and_extend(jlist& self, jlist& other) {
     std::size_t original_size = self.entries.size();
@@ -195,9 +244,9 @@ bool extend_helper(jlist& self, jlist& other) {
         self.entries.insert(self.entries.end(),
                             other.entries.begin(),
                             other.entries.end());
-        if (self.boxed()) {
+        if (other.boxed()) {
             // the type is object, so we need to add a new reference to all the
-            // items
+            // items; check `other` because `self` may still be `unset`
             for (entry& e : other.entries) {
                 Py_INCREF(e.as_ob);
             }
@@ -208,8 +257,9 @@ bool extend_helper(jlist& self, jlist& other) {
             }
         }
         else {
-            // update in case `tag` was `unset`
-            self.tag(other.tag());
+            // update in case `tag` was `unset`, this also carries over the homogeneous
+            // type
+            self.tagged_ptr = other.tagged_ptr;
         }
         return false;
     }
@@ -233,6 +283,68 @@ bool extend_helper(jlist& self, jlist& other) {
     }
 }
 
+/** Append `ob` to `self`, stealing the reference. Values which match how `self` is
+    already stored are appended without going through `setitem_helper`. Returns true
+    with an exception raised on failure; the reference is released either way.
+ */
+bool append_stolen(jlist& self, PyObject* ob) {
+    PyTypeObject* tp = Py_TYPE(ob);
+    switch (self.tag()) {
+    case entry_tag::as_int:
+        if (tp == &PyLong_Type) {
+            int overflow = 0;
+            std::int64_t value = PyLong_AsLongLongAndOverflow(ob, &overflow);
+            if (!overflow) {
+                Py_DECREF(ob);
+                self.entries.emplace_back().as_int = value;
+                return false;
+            }
+        }
+        break;
+    case entry_tag::as_double:
+        if (tp == &PyFloat_Type) {
+            double value = PyFloat_AS_DOUBLE(ob);
+            Py_DECREF(ob);
+            self.entries.emplace_back().as_double = value;
+            return false;
+        }
+        break;
+    case entry_tag::as_homogeneous_ob:
+        if (tp != self.homogeneous_type_ptr()) {
+            break;
+        }
+        [[fallthrough]];
+    case entry_tag::as_heterogeneous_ob:
+        // the list takes over the reference
+        self.entries.emplace_back().as_ob = ob;
+        return false;
+    default:
+        break;
+    }
+
+    // store into a separate entry: `setitem_helper` may box all of `self.entries`, and
+    // a slot appended up front would be boxed along with them
+    entry e;
+    bool err = setitem_helper(self, e, ob, false);
+    Py_DECREF(ob);
+    if (!err) {
+        self.entries.emplace_back(e);
+    }
+    return err;
+}
+
+/** Remove the entries appended after `original_size` by a failed extend.
+ */
+void unwind_extend(jlist& self, std::size_t original_size) {
+    original_size = std::min(original_size, self.entries.size());
+    if (self.boxed()) {
+        for (std::size_t ix = original_size; ix < self.entries.size(); ++ix) {
+            Py_DECREF(self.entries[ix].as_ob);
+        }
+    }
+    self.entries.erase(self.entries.begin() + original_size, self.entries.end());
+}
+
 bool extend_fast_sequence(jlist& self, PyObject* other) {
     Py_ssize_t size = PySequence_Fast_GET_SIZE(other);
     if (!size) {
@@ -241,20 +353,13 @@ bool extend_fast_sequence(jlist& self, PyObject* other) {
     }
 
     std::size_t original_size = self.entries.size();
-    self.entries.resize(original_size + size);
+    self.entries.reserve(original_size + size);
 
     PyObject** items = PySequence_Fast_ITEMS(other);
     for (Py_ssize_t ix = 0; ix < size; ++ix) {
-        if (detail::setitem_helper(self,
-                                   self.entries[original_size + ix],
-                                   items[ix],
-                                   false)) {
-            if (self.boxed()) {
-                for (std::size_t ix = original_size; ix < self.entries.size(); ++ix) {
-                    Py_DECREF(self.entries[ix].as_ob);
-                }
-            }
-            self.entries.erase(self.entries.begin() + original_size, self.entries.end());
+        Py_INCREF(items[ix]);
+        if (append_stolen(self, items[ix])) {
+            unwind_extend(self, original_size);
             return true;
         }
     }
@@ -267,34 +372,36 @@ bool extend_iterable(jlist& self, PyObject* other) {
     if (!it) {
         return true;
     }
+    scope_guard decref_it([&] { Py_DECREF(it); });
 
-    Py_ssize_t maybe_size = PySequence_Size(other);
-    if (maybe_size > 0) {
-        self.entries.reserve(self.size() + maybe_size);
+    Py_ssize_t hint = PyObject_LengthHint(other, 0);
+    if (hint < 0) {
+        return true;
     }
-    else {
-        PyErr_Clear();
+    std::size_t original_size = self.entries.size();
+    try {
+        self.entries.reserve(original_size + hint);
+    }
+    catch (...) {
+        // the hint is only a guess, and may be far larger than the real size
     }
 
-    Py_ssize_t ix = 0;
-    PyObject* ob;
-    while ((ob = PyIter_Next(it))) {
-        entry& e = self.entries.emplace_back();
-        bool err = detail::setitem_helper(self, e, ob, false);
-        Py_DECREF(ob);
-        if (err) {
-            if (self.boxed()) {
-                for (Py_ssize_t unwind_ix = 0; unwind_ix < ix; ++unwind_ix) {
-                    Py_DECREF(self.entries[unwind_ix].as_ob);
-                }
-            }
-            Py_DECREF(it);
+    // call the slot directly: `PyIter_Next` re-checks for errors on every value
+    iternextfunc iternext = Py_TYPE(it)->tp_iternext;
+    while (PyObject* ob = iternext(it)) {
+        if (append_stolen(self, ob)) {
+            unwind_extend(self, original_size);
+            return true;
+        }
+    }
+    if (PyErr_Occurred()) {
+        if (!PyErr_ExceptionMatches(PyExc_StopIteration)) {
+            unwind_extend(self, original_size);
             return true;
         }
-        ++ix;
+        PyErr_Clear();
     }
-    Py_DECREF(it);
-    return PyErr_Occurred();
+    return false;
 }
 
 bool extend_range(jlist& self, PyObject* other) {
@@ -398,8 +505,98 @@ bool extend_range(jlist& self, PyObject* other) {
     return false;
 }
 
+template<typename I>
+jlist* new_jlist(const jlist& like, I begin, I end);
+
+/** Append `count` entries of `source` starting at `start` and moving by `step`,
+    which is 1 or -1. The entries are gathered into a new list first when `source`
+    is `self` or the order is reversed.
+ */
+bool extend_positions(jlist& self,
+                      jlist& source,
+                      Py_ssize_t start,
+                      Py_ssize_t count,
+                      Py_ssize_t step) {
+    if (count <= 0) {
+        return false;
+    }
+    auto first = source.entries.begin() + start;
+    if (&source != &self && step == 1 &&
+        (self.tag() == source.tag() || self.tag() == entry_tag::unset)) {
+        // insert straight from `source`, like `extend_helper`, without a temporary
+        self.entries.insert(self.entries.end(), first, first + count);
+        if (source.boxed()) {
+            for (auto it = first; it != first + count; ++it) {
+                Py_INCREF(it->as_ob);
+            }
+        }
+        if (self.tag() == entry_tag::as_homogeneous_ob) {
+            if (self.homogeneous_type_ptr() != source.homogeneous_type_ptr()) {
+                self.tag(entry_tag::as_heterogeneous_ob);
+            }
+        }
+        else {
+            self.tagged_ptr = source.tagged_ptr;
+        }
+        return false;
+    }
+
+    jlist* gathered;
+    if (step == 1) {
+        gathered = new_jlist(source, first, first + count);
+    }
+    else {
+        auto reversed_first = std::make_reverse_iterator(first + 1);
+        gathered = new_jlist(source, reversed_first, reversed_first + count);
+    }
+    if (!gathered) {
+        return true;
+    }
+    scope_guard decref_gathered([&] { Py_DECREF(gathered); });
+
+    if (self.tag() == entry_tag::unset && self.entries.empty()) {
+        // take the gathered entries instead of copying them again
+        std::swap(self.entries, gathered->entries);
+        std::swap(self.tagged_ptr, gathered->tagged_ptr);
+        return false;
+    }
+    return extend_helper(self, *gathered);
+}
+
+/** Extend from the rest of a jlist iterator and exhaust it.
+ */
+bool extend_jlist_iter(jlist& self, iterobject::jlist_iter& it) {
+    if (!it.list) {
+        return false;
+    }
+    jlist* source = it.list;
+    it.list = nullptr;
+    scope_guard decref_source([&] { Py_DECREF(source); });
+
+    Py_ssize_t start = std::max<Py_ssize_t>(it.ix, 0);
+    it.ix = source->size();
+    return extend_positions(self, *source, start, source->size() - start, 1);
+}
+
+/** Extend from the rest of `reversed(jlist)` and exhaust it.
+ */
+bool extend_jlist_reviter(jlist& self, reviterobject::jlist_iter& it) {
+    if (!it.list) {
+        return false;
+    }
+    jlist* source = it.list;
+    it.list = nullptr;
+    scope_guard decref_source([&] { Py_DECREF(source); });
+
+    Py_ssize_t start = std::min(it.ix, source->size() - 1);
+    it.ix = -1;
+    return extend_positions(self, *source, start, start + 1, -1);
+}
+
 bool extend_helper(jlist& self, PyObject* other) {
-    if (Py_TYPE(other) == &jlist_type) {
+    self.invalidate_index();
+
+    if (PyObject_TypeCheck(other, &jlist_type)) {
         // fast path code when we know the rhs is also a jlist
         return extend_helper(self, *reinterpret_cast<jlist*>(other));
     }
@@ -412,6 +609,15 @@ bool extend_helper(jlist& self, PyObject* other) {
         return extend_range(self, other);
     }
 
+    // iterators over another jlist copy the entries instead of boxing them
+    if (Py_TYPE(other) == &iterobject::type) {
+        return extend_jlist_iter(self, *reinterpret_cast<iterobject::jlist_iter*>(other));
+    }
+    if (Py_TYPE(other) == &reviterobject::type) {
+        return extend_jlist_reviter(self,
+                                    *reinterpret_cast<reviterobject::jlist_iter*>(other));
+    }
+
     return extend_iterable(self, other);
 }
 
@@ -423,6 +629,7 @@ jlist* new_jlist(entry_tag tag, I begin, I end, PyTypeObject* cls = &jlist_type)
     }
     out->tag(tag);
     new (&out->entries) std::vector<entry>(begin, end);
+    out->index = nullptr;
     if (is_object_tag(tag)) {
         for (entry e : out->entries) {
             Py_INCREF(e.as_ob);
@@ -439,11 +646,32 @@ jlist* new_jlist(entry_tag tag, PyTypeObject* cls = &jlist_type) {
     }
     out->tag(tag);
     new (&out->entries) std::vector<entry>();
+    out->index = nullptr;
     PyObject_GC_Track(out);
     return out;
 }
 
+/** Create a new jlist with the same tag and homogeneous type as `like`.
+ */
+template<typename I>
+jlist* new_jlist(const jlist& like, I begin, I end) {
+    jlist* out = new_jlist(like.tag(), begin, end);
+    if (out) {
+        out->tagged_ptr = like.tagged_ptr;
+    }
+    return out;
+}
+
+jlist* new_jlist(const jlist& like) {
+    jlist* out = new_jlist(like.tag());
+    if (out) {
+        out->tagged_ptr = like.tagged_ptr;
+    }
+    return out;
+}
+
 void clear_helper(jlist& self) {
+    self.invalidate_index();
     if (self.boxed()) {
         for (entry e : self.entries) {
             Py_DECREF(e.as_ob);
@@ -451,6 +679,228 @@ void clear_helper(jlist& self) {
     }
     self.entries.clear();
 }
+
+/** The key of an unboxed value in a `jlist_index`, or std::nullopt for NaN, which
+    is never found.
+ */
+std::optional<std::int64_t> index_key(std::int64_t value) {
+    return value;
+}
+
+std::optional<std::int64_t> index_key(double value) {
+    if (std::isnan(value)) {
+        return std::nullopt;
+    }
+    if (value == 0) {
+        // -0.0 == 0.0
+        value = 0;
+    }
+    std::int64_t key;
+    std::memcpy(&key, &value, sizeof(key));
+    return key;
+}
+
+std::optional<std::int64_t> index_key(const jlist& self, entry e) {
+    if (self.tag() == entry_tag::as_int) {
+        return index_key(e.as_int);
+    }
+    return index_key(e.as_double);
+}
+
+/** Record that the value at `position` occurs in the list. For boxed lists this
+    must be called with `index.busy` set. Returns true with an exception raised if
+    the value can't be hashed or compared.
+ */
+bool index_record(const jlist& self, jlist_index& index, Py_ssize_t position) {
+    Py_ssize_t slot = index.values.size();
+    Py_ssize_t found;
+
+    if (!index.boxed) {
+        std::optional<std::int64_t> key = index_key(self, self.entries[position]);
+        if (!key) {
+            return false;
+        }
+        found = index.unboxed.insert(*key, slot);
+    }
+    else {
+        PyObject* slot_ob = PyLong_FromSsize_t(slot);
+        if (!slot_ob) {
+            return true;
+        }
+        // hold a reference in case hashing the value mutates the list
+        PyObject* ob = self.entries[position].as_ob;
+        Py_INCREF(ob);
+        PyObject* found_ob = PyDict_SetDefault(index.boxed, ob, slot_ob);
+        Py_DECREF(ob);
+        Py_DECREF(slot_ob);
+        if (!found_ob) {
+            return true;
+        }
+        found = PyLong_AsSsize_t(found_ob);
+    }
+
+    if (found == slot) {
+        index.values.push_back({position, 1});
+    }
+    else {
+        ++index.values[found].count;
+    }
+    return false;
+}
+
+/** Build a new index of the values in the list, replacing any existing index.
+    Returns true with an exception raised if a value is unhashable or the list was
+    mutated while hashing the values.
+ */
+bool build_index(jlist& self) {
+    self.invalidate_index();
+
+    jlist_index* index = new jlist_index;
+    self.index = index;
+    if (!self.boxed()) {
+        for (Py_ssize_t ix = 0; ix < self.size(); ++ix) {
+            index_record(self, *index, ix);
+        }
+        return false;
+    }
+
+    if (!(index->boxed = PyDict_New())) {
+        self.invalidate_index();
+        return true;
+    }
+
+    bool err = false;
+    index->busy = true;
+    for (Py_ssize_t ix = 0; ix < self.size() && self.index == index; ++ix) {
+        if ((err = index_record(self, *index, ix))) {
+            break;
+        }
+    }
+    index->busy = false;
+
+    if (self.index != index) {
+        delete index;
+        if (!err) {
+            PyErr_SetString(PyExc_RuntimeError, "jlist changed during build_index()");
+        }
+        return true;
+    }
+    if (err) {
+        self.invalidate_index();
+    }
+    return err;
+}
+
+/** Update the index after a value was appended to the list. The index is dropped if
+    it can't be updated.
+ */
+void index_append(jlist& self, entry_tag previous_tag) {
+    jlist_index* index = self.index;
+    if (!index) {
+        return;
+    }
+    if (index->busy) {
+        // appending from inside a hash or comparison used by the index
+        self.invalidate_index();
+        return;
+    }
+
+    if (self.tag() != previous_tag) {
+        // the index of an empty list can take on the tag of the first value; any
+        // other change of tag changes how the values are keyed
+        if (previous_tag != entry_tag::unset) {
+            self.invalidate_index();
+            return;
+        }
+        if (self.boxed() && !(index->boxed = PyDict_New())) {
+            PyErr_Clear();
+            self.invalidate_index();
+            return;
+        }
+    }
+
+    index->busy = true;
+    bool err = index_record(self, *index, self.size() - 1);
+    index->busy = false;
+
+    if (self.index != index) {
+        delete index;
+    }
+    else if (!err) {
+        return;
+    }
+    else {
+        self.invalidate_index();
+    }
+    // the append itself succeeded; lookups fall back to scanning
+    PyErr_Clear();
+}
+
+enum class index_lookup {
+    // the value is not in the list
+    missing,
+    found,
+    // there is no index, or it can't be used for this value
+    unknown,
+    error,
+};
+
+/** Look up a value in the list's index.
+ */
+index_lookup lookup_index(jlist& self, PyObject* value, jlist_index::occurrences& out) {
+    jlist_index* index = self.index;
+    if (!index || index->busy) {
+        return index_lookup::unknown;
+    }
+
+    Py_ssize_t slot;
+    if (!index->boxed) {
+        std::optional<std::int64_t> key;
+        if (self.tag() == entry_tag::as_int) {
+            auto maybe_unboxed = maybe_unbox<std::int64_t>(value);
+            if (!maybe_unboxed) {
+                return index_lookup::unknown;
+            }
+            key = index_key(*maybe_unboxed);
+        }
+        else if (self.tag() == entry_tag::as_double) {
+            auto maybe_unboxed = maybe_unbox<double>(value);
+            if (!maybe_unboxed) {
+                return index_lookup::unknown;
+            }
+            key = index_key(*maybe_unboxed);
+        }
+        else {
+            return index_lookup::unknown;
+        }
+        slot = key ? index->unboxed.find(*key) : -1;
+    }
+    else {
+        index->busy = true;
+        PyObject* slot_ob = PyDict_GetItemWithError(index->boxed, value);
+        slot = slot_ob ? PyLong_AsSsize_t(slot_ob) : -1;
+        index->busy = false;
+
+        if (self.index != index) {
+            delete index;
+            return PyErr_Occurred() ? index_lookup::error : index_lookup::unknown;
+        }
+        if (PyErr_Occurred()) {
+            if (!PyErr_ExceptionMatches(PyExc_TypeError)) {
+                return index_lookup::error;
+            }
+            // an unhashable value may still compare equal to a value in the list
+            PyErr_Clear();
+            return index_lookup::unknown;
+        }
+    }
+
+    if (slot < 0) {
+        return index_lookup::missing;
+    }
+    out = index->values[slot];
+    return index_lookup::found;
+}
 }  // namespace detail
 
 PyObject* new_(PyTypeObject* cls, PyObject*, PyObject*) {
@@ -458,6 +908,9 @@ PyObject* new_(PyTypeObject* cls, PyObject*, PyObject*) {
 }
 
 int init(PyObject* _self, PyObject* args, PyObject* kwargs) {
+    if (detail::check_mutable(_self)) {
+        return -1;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     if (kwargs && PyDict_Size(kwargs)) {
@@ -487,6 +940,7 @@ void deallocate(PyObject* _self) {
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     PyObject_GC_UnTrack(_self);
+    self.invalidate_index();
     if (self.boxed()) {
         for (entry& e : self.entries) {
             Py_DECREF(e.as_ob);
@@ -534,6 +988,9 @@ PyDoc_STRVAR(_reserve_doc,
              "Reserve space for elements. Does not change the length of the jlist.");
 
 PyObject* _reserve(PyObject* _self, PyObject* size_ob) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     Py_ssize_t size = PyNumber_AsSsize_t(size_ob, PyExc_OverflowError);
@@ -648,7 +1105,7 @@ PyObject* richcompare(PyObject* _self, PyObject* _other, int cmp) {
         Py_RETURN_NOTIMPLEMENTED;
     }
 
-    if (Py_TYPE(_other) != &jlist_type) {
+    if (!PyObject_TypeCheck(_other, &jlist_type)) {
         Py_RETURN_NOTIMPLEMENTED;
     }
 
@@ -814,20 +1271,47 @@ PyObject* richcompare(PyObject* _self, PyObject* _other, int cmp) {
 PyDoc_STRVAR(append_doc, "Append object to the end of the jlist.h");
 
 PyObject* append(PyObject* _self, PyObject* ob) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
+    entry_tag previous_tag = self.tag();
     entry& e = self.entries.emplace_back();
     if (detail::setitem_helper(self, e, ob, false)) {
         return nullptr;
     }
+    detail::index_append(self, previous_tag);
     Py_RETURN_NONE;
 }
 
 PyMethodDef append_method = {"append", append, METH_O, append_doc};
 
+PyDoc_STRVAR(build_index_doc,
+             "Build a hash index of the values in self, which index, count, and the in "
+             "operator use instead of scanning. Appending updates the index; any other "
+             "mutation drops it.");
+
+PyObject* build_index(PyObject* _self, PyObject*) {
+    jlist& self = *reinterpret_cast<jlist*>(_self);
+
+    if (detail::build_index(self)) {
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef build_index_method = {"build_index",
+                                  build_index,
+                                  METH_NOARGS,
+                                  build_index_doc};
+
 PyDoc_STRVAR(clear_doc, "Remove all items from self.");
 
 PyObject* clear(PyObject* _self, PyObject*) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     detail::clear_helper(self);
@@ -845,6 +1329,18 @@ PyObject* count(PyObject* _self, PyObject* value) {
         return PyLong_FromLong(0);
     }
 
+    jlist_index::occurrences occurrences;
+    switch (detail::lookup_index(self, value, occurrences)) {
+    case detail::index_lookup::missing:
+        return PyLong_FromLong(0);
+    case detail::index_lookup::found:
+        return PyLong_FromSsize_t(occurrences.count);
+    case detail::index_lookup::unknown:
+        break;
+    case detail::index_lookup::error:
+        return nullptr;
+    }
+
     Py_ssize_t count = 0;
 
     auto boxing_count = [&](auto type) {
@@ -923,7 +1419,7 @@ PyObject* count(PyObject* _self, PyObject* value) {
             }
         }
         else {
-            std::int64_t rhs = *maybe_unboxed;
+            double rhs = *maybe_unboxed;
             for (entry e : self.entries) {
                 count += e.as_double == rhs;
             }
@@ -945,7 +1441,7 @@ PyObject* copy(PyObject* _self, PyObject*) {
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     return reinterpret_cast<PyObject*>(
-        detail::new_jlist(self.tag(), self.entries.begin(), self.entries.end()));
+        detail::new_jlist(self, self.entries.begin(), self.entries.end()));
 }
 
 PyMethodDef copy_method = {"copy", copy, METH_NOARGS, copy_doc};
@@ -953,6 +1449,9 @@ PyMethodDef copy_method = {"copy", copy, METH_NOARGS, copy_doc};
 PyDoc_STRVAR(extend_doc, "Extend jlist by appending elements from the iterable.");
 
 PyObject* extend(PyObject* _self, PyObject* ob) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     if (detail::extend_helper(self, ob)) {
@@ -977,6 +1476,25 @@ Py_ssize_t index_helper(jlist& self,
     start = jl::detail::adjust_ix(start, self.size(), true);
     stop = jl::detail::adjust_ix(stop, self.size(), true);
 
+    jlist_index::occurrences occurrences;
+    switch (lookup_index(self, value, occurrences)) {
+    case index_lookup::missing:
+        return -1;
+    case index_lookup::found:
+        if (occurrences.first >= stop) {
+            return -1;
+        }
+        if (occurrences.first >= start) {
+            return occurrences.first;
+        }
+        // the first occurrence is before `start`, so scan for the next one
+        break;
+    case index_lookup::unknown:
+        break;
+    case index_lookup::error:
+        return -2;
+    }
+
     auto boxing_index = [&](auto type) -> Py_ssize_t {
         using T = decltype(type);
         // the comparison can cause the list to resize
@@ -1100,7 +1618,7 @@ PyObject* index(PyObject* _self, PyObject** args, int nargs, PyObject* kwnames)
 
     auto clamp_bound = [&](PyObject* ob, Py_ssize_t& value) {
         value = PyNumber_AsSsize_t(ob, PyExc_OverflowError);
-        if (value == -1) {
+        if (value == -1 && PyErr_Occurred()) {
             if (PyErr_Occurred() == PyExc_OverflowError) {
                 PyErr_Clear();
                 PyObject* zero = PyLong_FromSsize_t(0);
@@ -1169,7 +1687,11 @@ PyMethodDef index_method = {"index",
 PyDoc_STRVAR(insert_doc, "Insert object before index into self.");
 
 PyObject* insert(PyObject* _self, PyObject** args, int nargs, PyObject* kwnames) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     if (kwnames && PyTuple_GET_SIZE(kwnames)) {
         PyErr_SetString(PyExc_TypeError, "insert() takes no keyword arguments");
@@ -1210,7 +1732,11 @@ PyMethodDef insert_method = {"insert",
 PyDoc_STRVAR(pop_doc, "Remove and return item at index (default last).");
 
 PyObject* pop(PyObject* _self, PyObject** args, int nargs, PyObject* kwnames) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     if (kwnames && PyTuple_GET_SIZE(kwnames)) {
         PyErr_SetString(PyExc_TypeError, "pop() takes no keyword arguments");
@@ -1273,7 +1799,10 @@ PyMethodDef pop_method = {"pop",
 PyDoc_STRVAR(remove_doc, "Remove first occurrence of value.");
 
 PyObject* remove(PyObject* _self, PyObject* value) {
-    jlist& self = *reinterpret_cast<jlist*>(_self);
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
+    jlist& self = *reinterpret_cast<jlist*>(_self);
 
     Py_ssize_t ix = detail::index_helper(self, value);
     if (ix == -2) {
@@ -1283,6 +1812,7 @@ PyObject* remove(PyObject* _self, PyObject* value) {
         PyErr_SetString(PyExc_ValueError, "jlist.remove(x): x not in list");
         return nullptr;
     }
+    self.invalidate_index();
     if (self.boxed()) {
         Py_DECREF(self.entries[ix].as_ob);
     }
@@ -1295,7 +1825,11 @@ PyMethodDef remove_method = {"remove", remove, METH_O, remove_doc};
 PyDoc_STRVAR(reverse_doc, "Reverse *IN PLACE*.");
 
 PyObject* reverse(PyObject* _self, PyObject*) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     std::reverse(self.entries.begin(), self.entries.end());
     Py_RETURN_NONE;
@@ -1303,6 +1837,27 @@ PyObject* reverse(PyObject* _self, PyObject*) {
 
 PyMethodDef reverse_method = {"reverse", reverse, METH_NOARGS, reverse_doc};
 
+PyDoc_STRVAR(reversed_doc, "Return a reverse iterator over the list.");
+
+PyObject* reversed(PyObject* _self, PyObject*) {
+    jlist& self = *reinterpret_cast<jlist*>(_self);
+
+    reviterobject::jlist_iter* out = PyObject_GC_New(reviterobject::jlist_iter,
+                                                     &reviterobject::type);
+    if (!out) {
+        return nullptr;
+    }
+
+    Py_INCREF(_self);
+    out->list = &self;
+    out->ix = self.size() - 1;
+
+    PyObject_GC_Track(out);
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef reversed_method = {"__reversed__", reversed, METH_NOARGS, reversed_doc};
+
 PyDoc_STRVAR(sort_doc, "Stable sort *IN PLACE*.");
 
 namespace detail {
@@ -1457,7 +2012,11 @@ bool sort_with_key(jlist& self, PyObject* key) {
 }  // namespace detail
 
 PyObject* sort(PyObject* _self, PyObject** args, int nargs, PyObject* kwnames) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     if (nargs) {
         PyErr_SetString(PyExc_TypeError, "sort() takes no positional arguments");
@@ -1524,6 +2083,7 @@ PyMethodDef methods[] = {
     _from_starargs_method,
     _reserve_method,
     append_method,
+    build_index_method,
     clear_method,
     copy_method,
     count_method,
@@ -1535,6 +2095,7 @@ PyMethodDef methods[] = {
     reverse_method,
     sort_method,
     reduce_method,
+    reversed_method,
     {nullptr, nullptr, 0, nullptr},
 };
 
@@ -1560,7 +2121,7 @@ PyObject* concat(PyObject* self, PyObject* ob) {
 PyObject* repeat(PyObject* _self, Py_ssize_t times) {
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
-    jlist* out = detail::new_jlist(self.tag());
+    jlist* out = detail::new_jlist(self);
     if (!out) {
         return nullptr;
     }
@@ -1596,27 +2157,15 @@ PyObject* getitem(PyObject* _self, Py_ssize_t ix) {
         PyErr_SetString(PyExc_IndexError, "jlist index out of range");
         return nullptr;
     }
-    const entry& e = *maybe_e;
-
-    switch (self.tag()) {
-    case entry_tag::as_homogeneous_ob:
-    case entry_tag::as_heterogeneous_ob:
-        Py_INCREF(e.as_ob);
-        return e.as_ob;
-    case entry_tag::as_int:
-        return box_value(e.as_int);
-    case entry_tag::as_double:
-        return box_value(e.as_double);
-    default:
-        // we don't need to handle entry_tag::unset because that means the
-        // size is 0 and we will have already returned `nullptr` in the bounds
-        // check
-        __builtin_unreachable();
-    }
+    return detail::box_entry(self, *maybe_e);
 }
 
 int setitem(PyObject* _self, Py_ssize_t ix, PyObject* ob) {
+    if (detail::check_mutable(_self)) {
+        return -1;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     entry* maybe_e = detail::get_entry(self, ix);
     if (!maybe_e) {
@@ -1649,6 +2198,9 @@ int contains(PyObject* _self, PyObject* ob) {
 }
 
 PyObject* inplace_concat(PyObject* _self, PyObject* ob) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
 
     if (detail::extend_helper(self, ob)) {
@@ -1659,7 +2211,11 @@ PyObject* inplace_concat(PyObject* _self, PyObject* ob) {
 }
 
 PyObject* inplace_repeat(PyObject* _self, Py_ssize_t times) {
+    if (detail::check_mutable(_self)) {
+        return nullptr;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     if (times <= 0) {
         detail::clear_helper(self);
@@ -1732,12 +2288,12 @@ PyObject* subscript(PyObject* _self, PyObject* item) {
             start = stop;
         }
         return reinterpret_cast<PyObject*>(
-            detail::new_jlist(self.tag(),
+            detail::new_jlist(self,
                               self.entries.begin() + start,
                               self.entries.begin() + stop));
     }
 
-    jlist* out = detail::new_jlist(self.tag());
+    jlist* out = detail::new_jlist(self);
     if (!out) {
         return nullptr;
     }
@@ -1897,11 +2453,16 @@ int set_slice(jlist& self,
               Py_ssize_t slicelength,
               jlist* other) {
 
+    // every branch which doesn't return takes a reference to `other`
     if (&self == other) {
-        other = new_jlist(self.tag(), self.entries.begin(), self.entries.end());
+        other = new_jlist(self, self.entries.begin(), self.entries.end());
+        if (!other) {
+            return -1;
+        }
     }
     else if (self.size() == 0) {
-        self.tag(other->tag());
+        self.tagged_ptr = other->tagged_ptr;
+        Py_INCREF(other);
     }
     else if (other->size() == 0 && slicelength == 0) {
         return 0;
@@ -1912,7 +2473,11 @@ int set_slice(jlist& self,
         }
         if (!other->boxed()) {
             other = new_jlist(self.tag(), other->entries.begin(), other->entries.end());
-            if (!other || maybe_box_values(*other)) {
+            if (!other) {
+                return -1;
+            }
+            if (maybe_box_values(*other)) {
+                Py_DECREF(other);
                 return -1;
             }
         }
@@ -1923,6 +2488,7 @@ int set_slice(jlist& self,
     else {
         Py_INCREF(other);
     }
+    scope_guard decref_other([&] { Py_DECREF(other); });
 
     if (step == 1) {
         if (slicelength > other->size()) {
@@ -1973,8 +2539,6 @@ int set_slice(jlist& self,
     default:
         __builtin_unreachable();
     }
-
-    Py_DECREF(other);
     return 0;
 }
 
@@ -1989,6 +2553,7 @@ int set_slice(jlist& self,
     }
 
     if (extend_helper(*rhs, other)) {
+        Py_DECREF(rhs);
         return -1;
     }
 
@@ -1999,7 +2564,11 @@ int set_slice(jlist& self,
 }  // namespace detail
 
 int set_subscript(PyObject* _self, PyObject* item, PyObject* value) {
+    if (detail::check_mutable(_self)) {
+        return -1;
+    }
     jlist& self = *reinterpret_cast<jlist*>(_self);
+    self.invalidate_index();
 
     if (PyIndex_Check(item)) {
         Py_ssize_t ix = PyNumber_AsSsize_t(item, PyExc_IndexError);
@@ -2032,7 +2601,7 @@ int set_subscript(PyObject* _self, PyObject* item, PyObject* value) {
     if (!value) {
         return detail::delete_slice(self, start, stop, step, slicelength);
     }
-    else if (Py_TYPE(value) == &jlist_type) {
+    else if (PyObject_TypeCheck(value, &jlist_type)) {
         return detail::set_slice(self,
                                  start,
                                  step,
@@ -2072,8 +2641,23 @@ PyObject* get_tag(PyObject* _self, void*) {
 
 PyGetSetDef tag_getset = {const_cast<char*>("tag"), get_tag, nullptr, tag_doc, nullptr};
 
+PyDoc_STRVAR(indexed_doc, "Whether the sequence has an index built by build_index().");
+
+PyObject* get_indexed(PyObject* _self, void*) {
+    jlist& self = *reinterpret_cast<jlist*>(_self);
+
+    return PyBool_FromLong(self.index != nullptr);
+}
+
+PyGetSetDef indexed_getset = {const_cast<char*>("indexed"),
+                              get_indexed,
+                              nullptr,
+                              indexed_doc,
+                              nullptr};
+
 PyGetSetDef getsets[] = {
     tag_getset,
+    indexed_getset,
     {nullptr, 0, 0, 0, nullptr},
 };
 
@@ -2085,6 +2669,9 @@ int traverse(PyObject* _self, visitproc visit, void* arg) {
             Py_VISIT(e.as_ob);
         }
     }
+    if (self.index) {
+        Py_VISIT(self.index->boxed);
+    }
 
     return 0;
 }
@@ -2098,12 +2685,6 @@ int gc_clear(PyObject* _self) {
 }  // namespace methods
 
 namespace iterobject {
-struct jlist_iter {
-    PyObject base;
-    Py_ssize_t ix;
-    jlist* list;
-};
-
 void deallocate(PyObject* _self) {
     jlist_iter& self = *reinterpret_cast<jlist_iter*>(_self);
 
@@ -2119,12 +2700,12 @@ PyObject* next(PyObject* _self) {
         return nullptr;
     }
 
-    if (self.ix >= self.list->size()) {
+    if (self.ix < 0 || self.ix >= self.list->size()) {
         Py_CLEAR(self.list);
         return nullptr;
     }
 
-    return methods::getitem(reinterpret_cast<PyObject*>(self.list), self.ix++);
+    return methods::detail::box_entry(*self.list, self.list->entries[self.ix++]);
 }
 
 PyObject* length(PyObject* _self, PyObject*) {
@@ -2203,7 +2784,7 @@ PyTypeObject type = {
     PyVarObject_HEAD_INIT(&PyType_Type, 0)
     // clang-format: on
     "jlist.jlist_iterator",                   // tp_name
-    sizeof(jlist),                            // tp_basicsize
+    sizeof(jlist_iter),                       // tp_basicsize
     0,                                        // tp_itemsize
     deallocate,                               // tp_dealloc
     0,                                        // tp_print
@@ -2232,6 +2813,120 @@ PyTypeObject type = {
 };
 }  // namespace iterobject
 
+namespace reviterobject {
+PyObject* next(PyObject* _self) {
+    jlist_iter& self = *reinterpret_cast<jlist_iter*>(_self);
+
+    if (!self.list) {
+        return nullptr;
+    }
+
+    if (self.ix < 0 || self.ix >= self.list->size()) {
+        Py_CLEAR(self.list);
+        return nullptr;
+    }
+
+    return methods::detail::box_entry(*self.list, self.list->entries[self.ix--]);
+}
+
+PyObject* length(PyObject* _self, PyObject*) {
+    jlist_iter& self = *reinterpret_cast<jlist_iter*>(_self);
+
+    if (!self.list || self.list->size() < self.ix + 1) {
+        return PyLong_FromSsize_t(0);
+    }
+
+    return PyLong_FromSsize_t(self.ix + 1);
+}
+
+PyMethodDef length_method = {"__length_hint__", length, METH_NOARGS, nullptr};
+
+PyObject* reduce(PyObject* _self, PyObject*) {
+    jlist_iter& self = *reinterpret_cast<jlist_iter*>(_self);
+
+    PyObject* builtins = PyImport_ImportModule("builtins");
+    if (!builtins) {
+        return nullptr;
+    }
+    // an exhausted iterator is rebuilt as `iter([])`, like list_reverseiterator
+    PyObject* callable = PyObject_GetAttrString(builtins,
+                                                self.list ? "reversed" : "iter");
+    Py_DECREF(builtins);
+    if (!callable) {
+        return nullptr;
+    }
+
+    PyObject* out;
+    if (self.list) {
+        out = Py_BuildValue("(O(O)n)", callable, self.list, self.ix);
+    }
+    else {
+        out = Py_BuildValue("(O(N))", callable, PyList_New(0));
+    }
+    Py_DECREF(callable);
+    return out;
+}
+
+PyMethodDef reduce_method = {"__reduce__", reduce, METH_NOARGS, nullptr};
+
+PyObject* setstate(PyObject* _self, PyObject* _ix) {
+    jlist_iter& self = *reinterpret_cast<jlist_iter*>(_self);
+
+    Py_ssize_t ix = PyNumber_AsSsize_t(_ix, PyExc_TypeError);
+    if (ix == -1 && PyErr_Occurred()) {
+        return nullptr;
+    }
+
+    if (self.list) {
+        self.ix = std::clamp<Py_ssize_t>(ix, -1, self.list->size() - 1);
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef setstate_method = {"__setstate__", setstate, METH_O, nullptr};
+
+PyMethodDef methods[] = {
+    length_method,
+    reduce_method,
+    setstate_method,
+    {nullptr, nullptr, 0, nullptr},
+};
+
+// the layout is the same as the forward iterator, so dealloc and traverse are shared
+PyTypeObject type = {
+    // clang-format: off
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    // clang-format: on
+    "jlist.jlist_reverseiterator",            // tp_name
+    sizeof(jlist_iter),                       // tp_basicsize
+    0,                                        // tp_itemsize
+    iterobject::deallocate,                   // tp_dealloc
+    0,                                        // tp_print
+    0,                                        // tp_getattr
+    0,                                        // tp_setattr
+    0,                                        // tp_reserved
+    0,                                        // tp_repr
+    0,                                        // tp_as_number
+    0,                                        // tp_as_sequence
+    0,                                        // tp_as_mapping
+    0,                                        // tp_hash
+    0,                                        // tp_call
+    0,                                        // tp_str
+    0,                                        // tp_getattro
+    0,                                        // tp_setattro
+    0,                                        // tp_as_buffer
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,  // tp_flags
+    0,                                        // tp_doc
+    iterobject::traverse,                     // tp_traverse
+    0,                                        // tp_clear
+    0,                                        // tp_richcompare
+    0,                                        // tp_weaklistoffset
+    PyObject_SelfIter,                        // tp_iter
+    next,                                     // tp_iternext
+    methods,                                  // tp_methods,
+};
+}  // namespace reviterobject
+
 namespace methods {
 PyObject* iter(PyObject* _self) {
     jlist& self = *reinterpret_cast<jlist*>(_self);
@@ -2294,6 +2989,310 @@ PyTypeObject jlist_type = {
     methods::new_,                                                  // tp_new
 };
 
+namespace frozen {
+namespace detail {
+// The multipliers and rotation used by CPython's tuple hash, which is based on xxHash.
+constexpr Py_uhash_t xxprime_1 = 11400714785074694791ULL;
+constexpr Py_uhash_t xxprime_2 = 14029467366897019727ULL;
+constexpr Py_uhash_t xxprime_5 = 2870177450012600261ULL;
+
+inline Py_uhash_t xxrotate(Py_uhash_t x) {
+    return (x << 31) | (x >> 33);
+}
+
+/** Compute `hash(int(value))` without boxing the value.
+ */
+inline Py_hash_t hash_int(std::int64_t value) {
+    std::uint64_t magnitude = value < 0 ? -static_cast<std::uint64_t>(value) : value;
+    Py_hash_t out = static_cast<Py_hash_t>(magnitude % _PyHASH_MODULUS);
+    if (value < 0) {
+        out = -out;
+    }
+    return out == -1 ? -2 : out;
+}
+
+/** Compute `hash(float(value))` without boxing the value.
+
+    Python hashes a finite float to `value mod (2 ** 61 - 1)`. Writing the value as
+    `mantissa * 2 ** exponent` with an integer mantissa of at most 53 bits, that is
+    the mantissa rotated left by `exponent` within 61 bits. This skips the frexp loop
+    that CPython uses.
+
+    NaN hashes to 0. Python hashes a boxed NaN by identity, but unboxed NaNs have
+    no identity and never compare equal anyway.
+ */
+inline Py_hash_t hash_double(double value) {
+    if (!std::isfinite(value)) {
+        if (std::isinf(value)) {
+            return value > 0 ? _PyHASH_INF : -_PyHASH_INF;
+        }
+        return 0;
+    }
+
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    int biased_exponent = static_cast<int>((bits >> 52) & 0x7ff);
+    Py_uhash_t x = bits & ((std::uint64_t{1} << 52) - 1);
+    int exponent = -1074;
+    if (biased_exponent) {
+        // normal numbers have an implicit leading 1
+        x |= std::uint64_t{1} << 52;
+        exponent = biased_exponent - 1075;
+    }
+
+    int shift = ((exponent % _PyHASH_BITS) + _PyHASH_BITS) % _PyHASH_BITS;
+    x = ((x << shift) & _PyHASH_MODULUS) | (x >> (_PyHASH_BITS - shift));
+
+    Py_hash_t out = static_cast<Py_hash_t>(x);
+    if (bits >> 63) {
+        out = -out;
+    }
+    return out == -1 ? -2 : out;
+}
+
+/** Hash the entries of a list the same way `tuple.__hash__` hashes the boxed
+    values, so a frozen jlist hashes equal to any jlist or tuple it compares equal to.
+ */
+Py_hash_t hash_entries(const jlist& self) {
+    Py_uhash_t acc = xxprime_5;
+    auto combine = [&](Py_uhash_t lane) {
+        acc += lane * xxprime_2;
+        acc = xxrotate(acc);
+        acc *= xxprime_1;
+    };
+
+    switch (self.tag()) {
+    case entry_tag::as_homogeneous_ob:
+    case entry_tag::as_heterogeneous_ob:
+        for (entry e : self.entries) {
+            Py_hash_t lane = PyObject_Hash(e.as_ob);
+            if (lane == -1) {
+                return -1;
+            }
+            combine(lane);
+        }
+        break;
+    case entry_tag::as_int:
+        for (entry e : self.entries) {
+            combine(hash_int(e.as_int));
+        }
+        break;
+    case entry_tag::as_double:
+        for (entry e : self.entries) {
+            combine(hash_double(e.as_double));
+        }
+        break;
+    case entry_tag::unset:
+        break;
+    default:
+        __builtin_unreachable();
+    }
+
+    // mix in the length the same way as tuple, which keeps `hash(())` stable
+    acc += static_cast<Py_uhash_t>(self.size()) ^ (xxprime_5 ^ 3527539UL);
+    if (acc == static_cast<Py_uhash_t>(-1)) {
+        return 1546275796;
+    }
+    return static_cast<Py_hash_t>(acc);
+}
+
+/** Move the contents of a new reference to a jlist into a new frozen jlist.
+ */
+PyObject* freeze_result(PyObject* ob) {
+    if (!ob || Py_TYPE(ob) != &jlist_type) {
+        return ob;
+    }
+    jlist& list = *reinterpret_cast<jlist*>(ob);
+
+    jlist* out = methods::detail::new_jlist(list.tag(), &frozen_jlist_type);
+    if (out) {
+        out->tagged_ptr = list.tagged_ptr;
+        out->entries.swap(list.entries);
+        reinterpret_cast<frozen_jlist*>(out)->hash = -1;
+    }
+    Py_DECREF(ob);
+    return reinterpret_cast<PyObject*>(out);
+}
+
+int immutable_error() {
+    PyErr_SetString(PyExc_TypeError, "frozenjlist is immutable");
+    return -1;
+}
+}  // namespace detail
+
+PyObject* new_(PyTypeObject* cls, PyObject* args, PyObject* kwargs) {
+    if (kwargs && PyDict_Size(kwargs)) {
+        PyErr_SetString(PyExc_TypeError, "frozenjlist doesn't accept keywords");
+        return nullptr;
+    }
+    if (PyTuple_GET_SIZE(args) > 1) {
+        PyErr_SetString(PyExc_TypeError,
+                        "frozenjlist accepts either 0 or 1 positional argument");
+        return nullptr;
+    }
+
+    jlist* out = methods::detail::new_jlist(entry_tag::unset, cls);
+    if (!out) {
+        return nullptr;
+    }
+    reinterpret_cast<frozen_jlist*>(out)->hash = -1;
+
+    // the contents are filled in here instead of in `__init__` so that they can't be
+    // reset by calling `__init__` again
+    if (PyTuple_GET_SIZE(args) &&
+        methods::detail::extend_helper(*out, PyTuple_GET_ITEM(args, 0))) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+int init(PyObject*, PyObject*, PyObject*) {
+    return 0;
+}
+
+Py_hash_t hash(PyObject* _self) {
+    frozen_jlist& self = *reinterpret_cast<frozen_jlist*>(_self);
+
+    if (self.hash == -1) {
+        self.hash = detail::hash_entries(self.list);
+    }
+    return self.hash;
+}
+
+PyObject* repr(PyObject* self) {
+    PyObject* list_repr = methods::repr(self);
+    if (!list_repr) {
+        return nullptr;
+    }
+    PyObject* out = PyUnicode_FromFormat("frozen%U", list_repr);
+    Py_DECREF(list_repr);
+    return out;
+}
+
+PyObject* concat(PyObject* self, PyObject* ob) {
+    return detail::freeze_result(methods::concat(self, ob));
+}
+
+PyObject* repeat(PyObject* self, Py_ssize_t times) {
+    return detail::freeze_result(methods::repeat(self, times));
+}
+
+PyObject* subscript(PyObject* self, PyObject* item) {
+    return detail::freeze_result(methods::subscript(self, item));
+}
+
+int setitem(PyObject*, Py_ssize_t, PyObject*) {
+    return detail::immutable_error();
+}
+
+int set_subscript(PyObject*, PyObject*, PyObject*) {
+    return detail::immutable_error();
+}
+
+PyObject* mutate(PyObject*, PyObject*, PyObject*) {
+    detail::immutable_error();
+    return nullptr;
+}
+
+PyObject* reduce(PyObject* self, PyObject*) {
+    PyObject* as_list = PySequence_List(self);
+    if (!as_list) {
+        return nullptr;
+    }
+
+    PyObject* out = Py_BuildValue("(O(O))",
+                                  reinterpret_cast<PyObject*>(&frozen_jlist_type),
+                                  as_list);
+    Py_DECREF(as_list);
+    return out;
+}
+
+PySequenceMethods sq_methods = {
+    methods::length,    // sq_length
+    concat,             // sq_concat
+    repeat,             // sq_repeat
+    methods::getitem,   // sq_item
+    nullptr,            // sq_slice
+    setitem,            // sq_ass_item
+    nullptr,            // sq_ass_slice
+    methods::contains,  // sq_contains
+    concat,             // sq_inplace_concat
+    repeat,             // inplace_repeat
+};
+
+PyMappingMethods as_mapping = {
+    methods::length,  // mp_length
+    subscript,        // mp_subscript
+    set_subscript,    // mp_ass_subscript
+};
+
+constexpr int mutate_flags = METH_VARARGS | METH_KEYWORDS;
+
+// shadow the mutating methods of jlist
+PyMethodDef methods[] = {
+    {"_reserve", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"append", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"clear", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"extend", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"insert", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"pop", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"remove", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"reverse", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"sort", unsafe_cast_to_pycfunction(mutate), mutate_flags, nullptr},
+    {"__reduce__", reduce, METH_NOARGS, nullptr},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyDoc_STRVAR(doc,
+             "frozenjlist(iterable=(), /)\n\n"
+             "An immutable jlist. Frozen jlists are hashable and hash the same as a "
+             "tuple of the same values. The hash is cached after the first call.");
+}  // namespace frozen
+
+PyTypeObject frozen_jlist_type = {
+    // clang-format: off
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    // clang-format: on
+    "jlist.frozenjlist",                       // tp_name
+    sizeof(frozen_jlist),                      // tp_basicsize
+    0,                                         // tp_itemsize
+    methods::deallocate,                       // tp_dealloc
+    0,                                         // tp_print
+    0,                                         // tp_getattr
+    0,                                         // tp_setattr
+    0,                                         // tp_reserved
+    frozen::repr,                              // tp_repr
+    0,                                         // tp_as_number
+    &frozen::sq_methods,                       // tp_as_sequence
+    &frozen::as_mapping,                       // tp_as_mapping
+    frozen::hash,                              // tp_hash
+    0,                                         // tp_call
+    0,                                         // tp_str
+    0,                                         // tp_getattro
+    0,                                         // tp_setattro
+    0,                                         // tp_as_buffer
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,   // tp_flags
+    frozen::doc,                               // tp_doc
+    methods::traverse,                         // tp_traverse
+    methods::gc_clear,                         // tp_clear
+    methods::richcompare,                      // tp_richcompare
+    0,                                         // tp_weaklistoffset
+    methods::iter,                             // tp_iter
+    0,                                         // tp_iternext
+    frozen::methods,                           // tp_methods,
+    0,                                         // tp_members
+    0,                                         // tp_getset
+    &jlist_type,                               // tp_base
+    0,                                         // tp_dict
+    0,                                         // tp_descr_get
+    0,                                         // tp_descr_set
+    0,                                         // tp_dictoffset
+    frozen::init,                              // tp_init
+    0,                                         // tp_alloc
+    frozen::new_,                              // tp_new
+};
+
 PyModuleDef module = {
     PyModuleDef_HEAD_INIT,
     "jlist.jlist",
@@ -2311,10 +3310,18 @@ PyMODINIT_FUNC PyInit_jlist() {
         return nullptr;
     }
 
+    if (PyType_Ready(&frozen_jlist_type) < 0) {
+        return nullptr;
+    }
+
     if (PyType_Ready(&iterobject::type) < 0) {
         return nullptr;
     }
 
+    if (PyType_Ready(&reviterobject::type) < 0) {
+        return nullptr;
+    }
+
     PyObject* m = PyModule_Create(&module);
     if (!m) {
         return nullptr;
@@ -2323,6 +3330,12 @@ PyMODINIT_FUNC PyInit_jlist() {
         Py_DECREF(m);
         return nullptr;
     }
+    if (PyObject_SetAttrString(m,
+                               "frozenjlist",
+                               reinterpret_cast<PyObject*>(&frozen_jlist_type))) {
+        Py_DECREF(m);
+        return nullptr;
+    }
 
     return m;
 }
@@ -8,6 +8,8 @@
 
 #include <Python.h>
 
+#include "jlist/int_hash_table.h"
+
 namespace jl {
 enum class entry_tag : std::int8_t {
     as_homogeneous_ob = 0,
@@ -172,10 +174,45 @@ public:
 };
 }  // namespace detail
 
+/** A hash index from the values of a jlist to where they occur, built by
+    `jlist.build_index`.
+ */
+struct jlist_index {
+    struct occurrences {
+        Py_ssize_t first;
+        Py_ssize_t count;
+    };
+
+    /** The first position and number of occurrences of each distinct value.
+     */
+    std::vector<occurrences> values;
+
+    /** For unboxed lists, a map from each value to its index in `values`. Doubles
+        are keyed by their bits with -0.0 stored as 0.0, and NaNs are left out
+        because they never compare equal.
+     */
+    int_hash_table unboxed;
+
+    /** For boxed lists, a dict from each value to its index in `values`.
+     */
+    PyObject* boxed = nullptr;
+
+    /** Set while the dict is being used. Hashing and comparing values can run code
+        which mutates the list; the index is then detached but not freed until the
+        user of the dict is done.
+     */
+    bool busy = false;
+
+    ~jlist_index() {
+        Py_XDECREF(boxed);
+    }
+};
+
 struct jlist {
     PyObject base;
     detail::tagged_type_pointer tagged_ptr;
     std::vector<entry> entries;
+    jlist_index* index;
 
     entry_tag tag() const {
         return tagged_ptr.tag();
@@ -201,6 +238,28 @@ struct jlist {
     Py_ssize_t size() const {
         return static_cast<Py_ssize_t>(entries.size());
     }
+
+    /** Drop the index, if there is one. This must be called before any mutation
+        which doesn't keep the index up to date.
+     */
+    void invalidate_index() {
+        if (index) {
+            // detach first: freeing a boxed index can run arbitrary code
+            jlist_index* old = index;
+            index = nullptr;
+            if (!old->busy) {
+                delete old;
+            }
+        }
+    }
+};
+
+/** An immutable jlist. The hash is computed on first use and cached; -1 means it
+    has not been computed yet.
+ */
+struct frozen_jlist {
+    jlist list;
+    Py_hash_t hash;
 };
 
 template<typename F>
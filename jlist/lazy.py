@@ -0,0 +1,124 @@
+import numbers
+
+from .ops import _lazy_run
+
+
+class lazy:
+    """A deferred pipeline of elementwise stages over an iterable.
+
+    ``map``, ``filter``, negation, and arithmetic with a number operand return
+    a new ``lazy`` without doing any work. A terminal method like ``sum`` or
+    ``collect`` then runs every stage in one pass over the values, a block at a
+    time, instead of building a full ``jlist`` for each stage. Arithmetic on
+    ``int`` and ``float`` values runs on the unboxed values, and the results of
+    ``map`` are unboxed again when they are all ints or all floats.
+
+    Parameters
+    ----------
+    values : iterable
+        The values to run the pipeline over.
+
+    Examples
+    --------
+    >>> xs = jl.range(10)
+    >>> (jl.lazy(xs) * 3 + 1).filter(lambda x: x % 2).sum()
+    65
+
+    >>> jl.lazy(xs).map(str).filter(str.isdigit).collect()
+    jlist(['0', '1', '2', '3', '4', '5', '6', '7', '8', '9'])
+    """
+    __slots__ = '_values', '_stages'
+
+    def __init__(self, values):
+        self._values = values
+        self._stages = ()
+
+    def _then(self, name, arg):
+        out = type(self).__new__(type(self))
+        out._values = self._values
+        out._stages = self._stages + ((name, arg),)
+        return out
+
+    def _arithmetic(self, name, other):
+        # only scalars broadcast; `lazy + lazy` would add the pipeline object itself
+        if not isinstance(other, numbers.Number):
+            return NotImplemented
+        return self._then(name, other)
+
+    def map(self, f):
+        """Replace each value with ``f(value)``.
+        """
+        return self._then('map', f)
+
+    def filter(self, f):
+        """Keep the values where ``f(value)`` is true.
+        """
+        return self._then('filter', f)
+
+    def __add__(self, other):
+        return self._arithmetic('add', other)
+
+    def __radd__(self, other):
+        return self._arithmetic('radd', other)
+
+    def __sub__(self, other):
+        return self._arithmetic('sub', other)
+
+    def __rsub__(self, other):
+        return self._arithmetic('rsub', other)
+
+    def __mul__(self, other):
+        return self._arithmetic('mul', other)
+
+    def __rmul__(self, other):
+        return self._arithmetic('rmul', other)
+
+    def __truediv__(self, other):
+        return self._arithmetic('truediv', other)
+
+    def __rtruediv__(self, other):
+        return self._arithmetic('rtruediv', other)
+
+    def __neg__(self):
+        return self._then('neg', None)
+
+    def collect(self):
+        """Run the pipeline and return the results in a new ``jlist``.
+        """
+        return _lazy_run(self._values, self._stages, 'collect')
+
+    def __iter__(self):
+        return iter(self.collect())
+
+    def sum(self, start=0):
+        """Run the pipeline and return the sum of the results plus ``start``.
+        """
+        return _lazy_run(self._values, self._stages, 'sum', start)
+
+    def count(self):
+        """Run the pipeline and return the number of results.
+        """
+        return _lazy_run(self._values, self._stages, 'count')
+
+    def min(self):
+        """Run the pipeline and return the smallest result.
+        """
+        return _lazy_run(self._values, self._stages, 'min')
+
+    def max(self):
+        """Run the pipeline and return the largest result.
+        """
+        return _lazy_run(self._values, self._stages, 'max')
+
+    def __reduce__(self):
+        return _from_stages, (self._values, self._stages)
+
+    def __repr__(self):
+        stages = ''.join(f'.{name}({arg!r})' for name, arg in self._stages)
+        return f'{type(self).__name__}({self._values!r}){stages}'
+
+
+def _from_stages(values, stages):
+    out = lazy(values)
+    out._stages = stages
+    return out
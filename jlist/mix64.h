@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace jl {
+/** Mix the bits of a 64 bit value with the splitmix64 finalizer, so that values which
+    differ in only a few bits give unrelated results.
+ */
+constexpr std::uint64_t mix64(std::uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+    return h ^ (h >> 31);
+}
+}  // namespace jl
@@ -1,16 +1,42 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <Python.h>
 
 #include "jlist/jlist.h"
+#include "jlist/mix64.h"
 #include "jlist/scope_guard.h"
 
 namespace jl::ops {
 struct module_state {
     PyTypeObject* jlist_type;
+    PyTypeObject* frozen_jlist_type;
     PyObject* builtin_all;
     PyObject* builtin_any;
     PyObject* builtin_sum;
+    PyObject* builtin_round;
+    PyObject* math_sqrt;
+    PyObject* math_log;
+    PyObject* math_exp;
+    PyObject* math_floor;
+    PyObject* math_ceil;
+    PyObject* heapq_heapify;
+    PyObject* heapq_heappush;
+    PyObject* heapq_heappop;
+    PyObject* heapq_heapreplace;
+    PyObject* heapq_heappushpop;
+    PyObject* heapq_nsmallest;
+    PyObject* heapq_nlargest;
 };
 
 namespace detail {
@@ -22,10 +48,249 @@ jlist* new_jlist(PyObject* module, entry_tag tag) {
     }
     out->tag(tag);
     new (&out->entries) std::vector<entry>;
+    out->index = nullptr;
+    PyObject_GC_Track(out);
 
     return out;
 }
 
+/** Resize the entries of `out` to `size`, filling new entries with `value`. Returns
+    true with a MemoryError raised instead of throwing if they can't be allocated.
+ */
+bool resize_entries(jlist& out, Py_ssize_t size, entry value = {}) {
+    if (static_cast<std::size_t>(size) > out.entries.max_size()) {
+        PyErr_SetString(PyExc_MemoryError, "jlist would be too large");
+        return true;
+    }
+    try {
+        out.entries.resize(size, value);
+    }
+    catch (const std::bad_alloc&) {
+        PyErr_NoMemory();
+        return true;
+    }
+    return false;
+}
+
+bool is_jlist(PyObject* module, PyObject* ob) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    return Py_TYPE(ob) == state->jlist_type;
+}
+
+/** Get a new reference to `ob` as a jlist, copying it into a new jlist if it is some
+    other iterable. Frozen jlists are not copied, so the result must not be mutated;
+    ops which write in place only accept exact jlists through `is_jlist`.
+ */
+PyObject* as_jlist(PyObject* module, PyObject* ob) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    if (Py_TYPE(ob) == state->jlist_type || Py_TYPE(ob) == state->frozen_jlist_type) {
+        Py_INCREF(ob);
+        return ob;
+    }
+    return PyObject_CallFunctionObjArgs(reinterpret_cast<PyObject*>(state->jlist_type),
+                                        ob,
+                                        nullptr);
+}
+
+/** Check that a Python callback didn't resize or unbox a list we are holding entries
+    of. Returns true with an exception raised if the list was changed.
+ */
+bool changed_during_compare(jlist& self, Py_ssize_t size) {
+    if (self.size() != size || !self.boxed()) {
+        PyErr_SetString(PyExc_RuntimeError, "jlist changed size during iteration");
+        return true;
+    }
+    return false;
+}
+
+/** `a < b` for unboxed entries.
+ */
+template<typename T>
+struct unboxed_less {
+    int operator()(entry a, entry b) const {
+        return entry_value<T>(a) < entry_value<T>(b);
+    }
+};
+
+/** `a < b` for a list of objects of a single type, using the type's cached
+    `tp_richcompare` instead of going through `PyObject_RichCompare`.
+ */
+struct homogeneous_less {
+    jlist* self;
+    Py_ssize_t size;
+    PyTypeObject* tp;
+
+    int operator()(entry a, entry b) const {
+        richcmpfunc richcompare = tp->tp_richcompare;
+        if (!richcompare) {
+            unsupported();
+            return -1;
+        }
+
+        // the comparison may run arbitrary code which can drop the list's references
+        Py_INCREF(a.as_ob);
+        Py_INCREF(b.as_ob);
+        PyObject* result_ob = richcompare(a.as_ob, b.as_ob, Py_LT);
+        Py_DECREF(a.as_ob);
+        Py_DECREF(b.as_ob);
+        if (!result_ob) {
+            return -1;
+        }
+        if (result_ob == Py_NotImplemented) {
+            Py_DECREF(result_ob);
+            unsupported();
+            return -1;
+        }
+        int r = PyObject_IsTrue(result_ob);
+        Py_DECREF(result_ob);
+        if (r < 0 || changed_during_compare(*self, size)) {
+            return -1;
+        }
+        return r;
+    }
+
+private:
+    void unsupported() const {
+        PyErr_Format(PyExc_TypeError,
+                     "'<' not supported between instances of '%.200s' and '%.200s'",
+                     tp->tp_name,
+                     tp->tp_name);
+    }
+};
+
+/** `a < b` for a list of objects of any types.
+ */
+struct heterogeneous_less {
+    jlist* self;
+    Py_ssize_t size;
+
+    int operator()(entry a, entry b) const {
+        Py_INCREF(a.as_ob);
+        Py_INCREF(b.as_ob);
+        int r = PyObject_RichCompareBool(a.as_ob, b.as_ob, Py_LT);
+        Py_DECREF(a.as_ob);
+        Py_DECREF(b.as_ob);
+        if (r < 0 || changed_during_compare(*self, size)) {
+            return -1;
+        }
+        return r;
+    }
+};
+
+/** Call `f` with the `less` comparator specialized for the tag of `self`.
+
+    The comparators return 1 if `a < b`, 0 if not, and -1 with a Python exception
+    raised on failure.
+ */
+template<typename F>
+auto with_less(jlist& self, F&& f) {
+    switch (self.tag()) {
+    case entry_tag::as_homogeneous_ob:
+        return f(homogeneous_less{&self, self.size(), self.homogeneous_type_ptr()});
+    case entry_tag::as_heterogeneous_ob:
+        return f(heterogeneous_less{&self, self.size()});
+    case entry_tag::as_int:
+    case entry_tag::unset:
+        return f(unboxed_less<std::int64_t>{});
+    case entry_tag::as_double:
+        return f(unboxed_less<double>{});
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Box the value at `e`, or return a new reference to it for object tags.
+ */
+PyObject* box_entry(jlist& self, entry e) {
+    switch (self.tag()) {
+    case entry_tag::as_homogeneous_ob:
+    case entry_tag::as_heterogeneous_ob:
+        return box_value(e.as_ob);
+    case entry_tag::as_int:
+        return box_value(e.as_int);
+    case entry_tag::as_double:
+        return box_value(e.as_double);
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Store `ob` into `e` if it can be done without changing the tag of `self`.
+
+    If `clear` is true, `e` currently holds a value which should be released. Returns
+    false if `ob` doesn't fit in the current tag, and `e` is left unchanged.
+ */
+bool try_store(jlist& self, entry& e, PyObject* ob, bool clear) {
+    switch (self.tag()) {
+    case entry_tag::as_homogeneous_ob:
+        if (Py_TYPE(ob) != self.homogeneous_type_ptr()) {
+            return false;
+        }
+        [[fallthrough]];
+    case entry_tag::as_heterogeneous_ob: {
+        PyObject* old = e.as_ob;
+        Py_INCREF(ob);
+        e.as_ob = ob;
+        if (clear) {
+            Py_DECREF(old);
+        }
+        return true;
+    }
+    case entry_tag::as_int: {
+        auto maybe_unboxed = maybe_unbox<std::int64_t>(ob);
+        if (!maybe_unboxed) {
+            return false;
+        }
+        e.as_int = *maybe_unboxed;
+        return true;
+    }
+    case entry_tag::as_double: {
+        auto maybe_unboxed = maybe_unbox<double>(ob);
+        if (!maybe_unboxed) {
+            return false;
+        }
+        e.as_double = *maybe_unboxed;
+        return true;
+    }
+    case entry_tag::unset:
+        return false;
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Append `ob` to `list_ob`, going through `jlist.append` when the value would change
+    the tag. Returns true with an exception raised on failure.
+ */
+bool append_value(PyObject* list_ob, PyObject* ob) {
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    entry e;
+    if (try_store(self, e, ob, false)) {
+        self.entries.emplace_back(e);
+        return false;
+    }
+
+    PyObject* result = PyObject_CallMethod(list_ob, "append", "O", ob);
+    if (!result) {
+        return true;
+    }
+    Py_DECREF(result);
+    return false;
+}
+
+/** Assign `ob` to `list_ob[ix]`, going through `jlist.__setitem__` when the value would
+    change the tag. Returns true with an exception raised on failure.
+ */
+bool set_value(PyObject* list_ob, Py_ssize_t ix, PyObject* ob) {
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (try_store(self, self.entries[ix], ob, true)) {
+        return false;
+    }
+    return PySequence_SetItem(list_ob, ix, ob) < 0;
+}
+
 template<bool any, typename T>
 struct any_all;
 
@@ -494,86 +759,7668 @@ PyObject* zeros(PyObject* module, PyObject* size_ob) {
 
 PyMethodDef zeros_method = {"zeros", zeros, METH_O, zeros_doc};
 
-PyMethodDef methods[] = {
-    all_method,
-    any_method,
-    sum_method,
-    range_method,
-    zeros_method,
-    {nullptr, nullptr, 0, nullptr},
-};
+namespace detail {
+/** Move the entry at `pos` towards the root until its parent is not greater than it.
 
-int module_traverse(PyObject* self, visitproc visit, void* arg) {
-    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(self));
-    if (!state) {
-        return 0;
+    This is the same algorithm as `heapq._siftdown`, so the resulting layout matches
+    `heapq` exactly.
+ */
+template<typename Less>
+bool siftdown(jlist& self, Less less, Py_ssize_t startpos, Py_ssize_t pos) {
+    while (pos > startpos) {
+        Py_ssize_t parentpos = (pos - 1) >> 1;
+        int r = less(self.entries[pos], self.entries[parentpos]);
+        if (r < 0) {
+            return true;
+        }
+        if (!r) {
+            break;
+        }
+        std::swap(self.entries[pos], self.entries[parentpos]);
+        pos = parentpos;
     }
+    return false;
+}
 
-    Py_VISIT(state->jlist_type);
-    Py_VISIT(state->builtin_sum);
-    return 0;
+/** Move the smaller child of `pos` up until hitting a leaf, then sift the original
+    entry back into place. This is the same algorithm as `heapq._siftup`.
+ */
+template<typename Less>
+bool siftup(jlist& self, Less less, Py_ssize_t pos) {
+    Py_ssize_t endpos = self.size();
+    Py_ssize_t startpos = pos;
+    Py_ssize_t limit = endpos >> 1;
+    while (pos < limit) {
+        Py_ssize_t childpos = 2 * pos + 1;
+        if (childpos + 1 < endpos) {
+            int r = less(self.entries[childpos], self.entries[childpos + 1]);
+            if (r < 0) {
+                return true;
+            }
+            childpos += r ^ 1;
+        }
+        std::swap(self.entries[pos], self.entries[childpos]);
+        pos = childpos;
+    }
+    return siftdown(self, less, startpos, pos);
 }
 
-void module_free(PyObject* self) {
-    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(self));
-    if (state) {
-        Py_CLEAR(state->jlist_type);
-        Py_CLEAR(state->builtin_sum);
+bool heapify(jlist& self) {
+    return with_less(self, [&](auto less) {
+        for (Py_ssize_t ix = (self.size() >> 1) - 1; ix >= 0; --ix) {
+            if (siftup(self, less, ix)) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+}  // namespace detail
+
+PyDoc_STRVAR(heapify_doc,
+             "Transform list into a heap, in-place, in O(len(heap)) time.\n"
+             "\n"
+             "When the input is a jlist, the comparisons are done on the unboxed\n"
+             "values directly.");
+
+PyObject* heapify(PyObject* module, PyObject* heap) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+
+    if (Py_TYPE(heap) != state->jlist_type) {
+        return PyObject_CallFunctionObjArgs(state->heapq_heapify, heap, nullptr);
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(heap);
+    self.invalidate_index();
+    if (detail::heapify(self)) {
+        return nullptr;
     }
+    Py_RETURN_NONE;
 }
 
-PyModuleDef module = {
-    PyModuleDef_HEAD_INIT,
-    "jlist.ops",
-    nullptr,
-    sizeof(module_state),
-    methods,
-    nullptr,
-    module_traverse,
-    nullptr,
-    reinterpret_cast<freefunc>(module_free),
-};
+PyMethodDef heapify_method = {"heapify", heapify, METH_O, heapify_doc};
 
-PyMODINIT_FUNC PyInit_ops() {
-    PyObject* builtins = PyImport_ImportModule("builtins");
-    if (!builtins) {
+PyDoc_STRVAR(heappush_doc, "Push item onto heap, maintaining the heap invariant.");
+
+PyObject* heappush(PyObject* module, PyObject* args) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    PyObject* heap;
+    PyObject* item;
+
+    if (!PyArg_UnpackTuple(args, "heappush", 2, 2, &heap, &item)) {
         return nullptr;
     }
-    scope_guard decref_builtins([&] { Py_DECREF(builtins); });
 
-    PyObject* m = PyModule_Create(&module);
-    if (!m) {
+    if (Py_TYPE(heap) != state->jlist_type) {
+        return PyObject_Call(state->heapq_heappush, args, nullptr);
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(heap);
+    self.invalidate_index();
+    if (detail::append_value(heap, item)) {
         return nullptr;
     }
-    scope_guard decref_m([&] { Py_DECREF(m); });
 
-    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(m));
+    if (detail::with_less(self, [&](auto less) {
+            return detail::siftdown(self, less, 0, self.size() - 1);
+        })) {
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
 
-    PyObject* jlist_mod = PyImport_ImportModule("jlist.jlist");
-    if (!jlist_mod) {
+PyMethodDef heappush_method = {"heappush", heappush, METH_VARARGS, heappush_doc};
+
+PyDoc_STRVAR(heappop_doc,
+             "Pop the smallest item off the heap, maintaining the heap invariant.");
+
+PyObject* heappop(PyObject* module, PyObject* heap) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+
+    if (Py_TYPE(heap) != state->jlist_type) {
+        return PyObject_CallFunctionObjArgs(state->heapq_heappop, heap, nullptr);
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(heap);
+    self.invalidate_index();
+    if (!self.size()) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
         return nullptr;
     }
 
-    state->jlist_type = reinterpret_cast<PyTypeObject*>(
-        PyObject_GetAttrString(jlist_mod, "jlist"));
-    Py_DECREF(jlist_mod);
-    if (!state->jlist_type) {
+    // move the last entry to the root and let `siftup` put it back in place; for
+    // object tags, the list's reference to the root is moved into `out`
+    PyObject* out;
+    if (self.boxed()) {
+        out = self.entries.front().as_ob;
+    }
+    else if (!(out = detail::box_entry(self, self.entries.front()))) {
         return nullptr;
     }
+    self.entries.front() = self.entries.back();
+    self.entries.pop_back();
 
-    if (!(state->builtin_all = PyObject_GetAttrString(builtins, "all"))) {
+    if (self.size() && detail::with_less(self, [&](auto less) {
+            return detail::siftup(self, less, 0);
+        })) {
+        Py_DECREF(out);
         return nullptr;
     }
-    scope_guard decref_builtin_all([&] { Py_DECREF(state->builtin_all); });
+    return out;
+}
 
-    if (!(state->builtin_any = PyObject_GetAttrString(builtins, "any"))) {
+PyMethodDef heappop_method = {"heappop", heappop, METH_O, heappop_doc};
+
+namespace detail {
+/** Replace the root of the heap with `item` and restore the heap invariant. Returns a
+    new reference to the old root.
+ */
+PyObject* replace_root(PyObject* heap, PyObject* item) {
+    jlist& self = *reinterpret_cast<jlist*>(heap);
+
+    PyObject* out = box_entry(self, self.entries.front());
+    if (!out) {
         return nullptr;
     }
-    scope_guard decref_builtin_any([&] { Py_DECREF(state->builtin_any); });
 
-    if (!(state->builtin_sum = PyObject_GetAttrString(builtins, "sum"))) {
+    if (set_value(heap, 0, item) || with_less(self, [&](auto less) {
+            return siftup(self, less, 0);
+        })) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    return out;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(heapreplace_doc,
+             "Pop and return the current smallest value, and add the new item.\n"
+             "\n"
+             "This is more efficient than heappop() followed by heappush(), and can be\n"
+             "more appropriate when using a fixed-size heap.  Note that the value\n"
+             "returned may be larger than item!");
+
+PyObject* heapreplace(PyObject* module, PyObject* args) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    PyObject* heap;
+    PyObject* item;
+
+    if (!PyArg_UnpackTuple(args, "heapreplace", 2, 2, &heap, &item)) {
+        return nullptr;
+    }
+
+    if (Py_TYPE(heap) != state->jlist_type) {
+        return PyObject_Call(state->heapq_heapreplace, args, nullptr);
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(heap);
+    if (!self.size()) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return nullptr;
+    }
+    self.invalidate_index();
+
+    return detail::replace_root(heap, item);
+}
+
+PyMethodDef heapreplace_method = {"heapreplace",
+                                  heapreplace,
+                                  METH_VARARGS,
+                                  heapreplace_doc};
+
+PyDoc_STRVAR(heappushpop_doc,
+             "Push item on the heap, then pop and return the smallest item from the\n"
+             "heap.\n"
+             "\n"
+             "The combined action runs more efficiently than heappush() followed by\n"
+             "a separate call to heappop().");
+
+PyObject* heappushpop(PyObject* module, PyObject* args) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    PyObject* heap;
+    PyObject* item;
+
+    if (!PyArg_UnpackTuple(args, "heappushpop", 2, 2, &heap, &item)) {
+        return nullptr;
+    }
+
+    if (Py_TYPE(heap) != state->jlist_type) {
+        return PyObject_Call(state->heapq_heappushpop, args, nullptr);
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(heap);
+    self.invalidate_index();
+    if (!self.size()) {
+        Py_INCREF(item);
+        return item;
+    }
+
+    PyObject* top = detail::box_entry(self, self.entries.front());
+    if (!top) {
+        return nullptr;
+    }
+    int r = PyObject_RichCompareBool(top, item, Py_LT);
+    Py_DECREF(top);
+    if (r < 0) {
+        return nullptr;
+    }
+    if (!r) {
+        Py_INCREF(item);
+        return item;
+    }
+
+    if (!self.size()) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return nullptr;
+    }
+    return detail::replace_root(heap, item);
+}
+
+PyMethodDef heappushpop_method = {"heappushpop",
+                                  heappushpop,
+                                  METH_VARARGS,
+                                  heappushpop_doc};
+
+namespace detail {
+/** Wrap a `less` comparator to compare positions into `self`, breaking ties between
+    equal values by position. Selecting with this ordering gives the same result as a
+    stable sort. The returned comparator throws when a comparison fails, so it may be
+    passed to the standard algorithms.
+ */
+template<bool reverse, typename Less>
+auto stable_position_less(jlist& self, Less less) {
+    return [&self, less](Py_ssize_t a, Py_ssize_t b) {
+        entry lhs = self.entries[a];
+        entry rhs = self.entries[b];
+        int r = (reverse) ? less(rhs, lhs) : less(lhs, rhs);
+        if (r < 0) {
+            throw std::runtime_error("bad compare");
+        }
+        if (r) {
+            return true;
+        }
+        r = (reverse) ? less(lhs, rhs) : less(rhs, lhs);
+        if (r < 0) {
+            throw std::runtime_error("bad compare");
+        }
+        return !r && a < b;
+    };
+}
+
+/** Run `f(positions, cmp)` where `positions` is `[0, len(self))` and `cmp` is a
+    `stable_position_less` ordering for the objects in `self`. Returns true with a
+    Python exception raised if a comparison failed.
+ */
+template<bool reverse, typename F>
+bool with_object_positions(jlist& self, std::vector<Py_ssize_t>& positions, F&& f) {
+    // Select positions rather than the entries themselves so that the comparisons
+    // can break ties on the original position and so that a comparison which mutates
+    // the list can't leave us holding borrowed references.
+    positions.resize(self.size());
+    for (Py_ssize_t ix = 0; ix < self.size(); ++ix) {
+        positions[ix] = ix;
+    }
+
+    return with_less(self, [&](auto less) {
+        try {
+            f(positions, stable_position_less<reverse>(self, less));
+        }
+        catch (...) {
+            return true;
+        }
+        return false;
+    });
+}
+
+/** Copy the first `n` unboxed entries in the order given by `cmp` into `out`.
+
+    When `n` is a small fraction of the input, a bounded heap over the input is cheaper
+    than copying it; otherwise we copy, `nth_element` and sort only the prefix.
+ */
+template<typename Compare>
+void unboxed_select_n(jlist& self, Py_ssize_t n, Compare cmp, jlist& out) {
+    if (n <= self.size() / 64) {
+        out.entries.resize(n);
+        std::partial_sort_copy(self.entries.begin(),
+                               self.entries.end(),
+                               out.entries.begin(),
+                               out.entries.end(),
+                               cmp);
+        return;
+    }
+
+    out.entries = self.entries;
+    if (n < self.size()) {
+        std::nth_element(out.entries.begin(),
+                         out.entries.begin() + n,
+                         out.entries.end(),
+                         cmp);
+        out.entries.resize(n);
+    }
+    std::sort(out.entries.begin(), out.entries.end(), cmp);
+}
+
+/** Select the `n` smallest (or largest) entries of `self` in sorted order.
+
+    Like `sorted(self, reverse=largest)[:n]`, equal objects keep their original relative
+    order.
+ */
+template<bool largest>
+jlist* select_n(PyObject* module, jlist& self, Py_ssize_t n) {
+    n = std::clamp<Py_ssize_t>(n, 0, self.size());
+
+    jlist* out = new_jlist(module, self.tag());
+    if (!out) {
         return nullptr;
     }
+    if (self.tag() == entry_tag::as_homogeneous_ob) {
+        out->homogeneous_type_ptr(self.homogeneous_type_ptr());
+    }
+
+    auto ordered = [](auto less) {
+        return [less](entry a, entry b) { return (largest) ? less(b, a) : less(a, b); };
+    };
+
+    switch (self.tag()) {
+    case entry_tag::as_int:
+        unboxed_select_n(self, n, ordered(unboxed_less<std::int64_t>{}), *out);
+        return out;
+    case entry_tag::as_double:
+        unboxed_select_n(self, n, ordered(unboxed_less<double>{}), *out);
+        return out;
+    default:
+        break;
+    }
+
+    std::vector<Py_ssize_t> positions;
+    bool err = with_object_positions<largest>(self, positions, [&](auto& pos, auto cmp) {
+        std::partial_sort(pos.begin(), pos.begin() + n, pos.end(), cmp);
+    });
+    if (err) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+
+    out->entries.reserve(n);
+    for (Py_ssize_t ix = 0; ix < n; ++ix) {
+        entry e = self.entries[positions[ix]];
+        Py_INCREF(e.as_ob);
+        out->entries.emplace_back(e);
+    }
+    return out;
+}
+
+template<bool largest>
+PyObject* nsmallest_nlargest(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    PyObject* fallback = (largest) ? state->heapq_nlargest : state->heapq_nsmallest;
+
+    static const char* keywords[] = {"n", "iterable", "key", nullptr};
+    PyObject* n_ob;
+    PyObject* iterable;
+    PyObject* key = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     (largest) ? "OO|O:nlargest" : "OO|O:nsmallest",
+                                     const_cast<char**>(keywords),
+                                     &n_ob,
+                                     &iterable,
+                                     &key)) {
+        return nullptr;
+    }
+
+    if (Py_TYPE(iterable) != state->jlist_type || key != Py_None) {
+        return PyObject_Call(fallback, args, kwargs);
+    }
+
+    Py_ssize_t n = PyNumber_AsSsize_t(n_ob, PyExc_OverflowError);
+    if (n == -1 && PyErr_Occurred()) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<PyObject*>(
+        select_n<largest>(module, *reinterpret_cast<jlist*>(iterable), n));
+}
+}  // namespace detail
+
+PyDoc_STRVAR(nsmallest_doc,
+             "Find the n smallest elements in a dataset.\n"
+             "\n"
+             "Equivalent to:  sorted(iterable, key=key)[:n]\n"
+             "\n"
+             "When the input is a jlist and no key is given, the result is a jlist.");
+
+PyMethodDef nsmallest_method = {
+    "nsmallest",
+    unsafe_cast_to_pycfunction(detail::nsmallest_nlargest<false>),
+    METH_VARARGS | METH_KEYWORDS,
+    nsmallest_doc};
+
+PyDoc_STRVAR(nlargest_doc,
+             "Find the n largest elements in a dataset.\n"
+             "\n"
+             "Equivalent to:  sorted(iterable, key=key, reverse=True)[:n]\n"
+             "\n"
+             "When the input is a jlist and no key is given, the result is a jlist.");
+
+PyMethodDef nlargest_method = {
+    "nlargest",
+    unsafe_cast_to_pycfunction(detail::nsmallest_nlargest<true>),
+    METH_VARARGS | METH_KEYWORDS,
+    nlargest_doc};
+
+namespace detail {
+/** Move the `k`th smallest value of `self` into `self[k]`, with all of the values before
+    it not greater, and all of the values after it not less.
+
+    `partitioned` holds the entries to rearrange, which may be `self.entries` or a copy
+    of them. Objects are ordered with `stable_position_less`, so `self[k]` is the same
+    object `sorted(self)[k]` would be. Returns true with a Python exception raised on
+    failure.
+ */
+bool nth_element(jlist& self, Py_ssize_t k, std::vector<entry>& partitioned) {
+    switch (self.tag()) {
+    case entry_tag::as_int:
+        std::nth_element(partitioned.begin(),
+                         partitioned.begin() + k,
+                         partitioned.end(),
+                         unboxed_less<std::int64_t>{});
+        return false;
+    case entry_tag::as_double:
+        std::nth_element(partitioned.begin(),
+                         partitioned.begin() + k,
+                         partitioned.end(),
+                         unboxed_less<double>{});
+        return false;
+    default:
+        break;
+    }
+
+    std::vector<Py_ssize_t> positions;
+    bool err = with_object_positions<false>(self, positions, [&](auto& pos, auto cmp) {
+        std::nth_element(pos.begin(), pos.begin() + k, pos.end(), cmp);
+    });
+    if (err) {
+        return true;
+    }
+
+    // `partitioned` may alias `self.entries`, so gather the new order before writing it
+    std::vector<entry> entries(positions.size());
+    for (std::size_t ix = 0; ix < positions.size(); ++ix) {
+        entries[ix] = self.entries[positions[ix]];
+    }
+    partitioned = std::move(entries);
+    return false;
+}
+
+/** Parse a `k` argument as an index into a list of length `size`, supporting negative
+    indices. Returns -1 with an exception raised if `k` is out of range.
+ */
+Py_ssize_t select_index(PyObject* k_ob, Py_ssize_t size, const char* name) {
+    Py_ssize_t k = PyNumber_AsSsize_t(k_ob, PyExc_IndexError);
+    if (k == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (k < 0) {
+        k += size;
+    }
+    if (k < 0 || k >= size) {
+        PyErr_Format(PyExc_IndexError, "%s index out of range", name);
+        return -1;
+    }
+    return k;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(partition_doc,
+             "partition(jlist, k)\n"
+             "\n"
+             "Rearrange the jlist *IN PLACE* so that jlist[k] holds the value that\n"
+             "would be there if the jlist were sorted. All of the values before k are\n"
+             "less than or equal to it, and all of the values after k are greater than\n"
+             "or equal to it. This runs in O(len(jlist)) time.");
+
+PyObject* partition(PyObject* module, PyObject* args) {
+    PyObject* list_ob;
+    PyObject* k_ob;
+
+    if (!PyArg_UnpackTuple(args, "partition", 2, 2, &list_ob, &k_ob)) {
+        return nullptr;
+    }
+
+    if (!detail::is_jlist(module, list_ob)) {
+        PyErr_Format(PyExc_TypeError,
+                     "partition() argument must be a jlist, not %.200s",
+                     Py_TYPE(list_ob)->tp_name);
+        return nullptr;
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+    self.invalidate_index();
+    Py_ssize_t k = detail::select_index(k_ob, self.size(), "partition");
+    if (k < 0) {
+        return nullptr;
+    }
+
+    if (detail::nth_element(self, k, self.entries)) {
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef partition_method = {"partition", partition, METH_VARARGS, partition_doc};
+
+PyDoc_STRVAR(nth_doc,
+             "nth(iterable, k)\n"
+             "\n"
+             "Return the value that would be at index k if the iterable were sorted.\n"
+             "\n"
+             "Equivalent to:  sorted(iterable)[k]\n"
+             "\n"
+             "but runs in O(len(iterable)) time.");
+
+PyObject* nth(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* k_ob;
+
+    if (!PyArg_UnpackTuple(args, "nth", 2, 2, &iterable, &k_ob)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    Py_ssize_t k = detail::select_index(k_ob, self.size(), "nth");
+    if (k < 0) {
+        return nullptr;
+    }
+
+    // objects are selected by position, so only unboxed values need to be copied
+    std::vector<entry> partitioned;
+    if (!self.boxed()) {
+        partitioned = self.entries;
+    }
+
+    if (detail::nth_element(self, k, partitioned)) {
+        return nullptr;
+    }
+    return detail::box_entry(self, partitioned[k]);
+}
+
+PyMethodDef nth_method = {"nth", nth, METH_VARARGS, nth_doc};
+
+namespace detail {
+/** Compute the `q` quantiles of the unboxed values in `values`, using linear
+    interpolation between the closest ranks (numpy's default method).
+
+    `qs` must be sorted; `values` is rearranged as each quantile is selected so that
+    every selection only needs to look at the values which are not yet ordered.
+ */
+template<typename T>
+void quantiles(std::vector<entry>& values,
+               const std::vector<std::pair<double, Py_ssize_t>>& qs,
+               std::vector<double>& out) {
+    Py_ssize_t size = values.size();
+    auto begin = values.begin();
+    for (auto [q, out_ix] : qs) {
+        double pos = q * (size - 1);
+        Py_ssize_t low = static_cast<Py_ssize_t>(pos);
+        double frac = pos - low;
+
+        std::nth_element(begin, values.begin() + low, values.end(), unboxed_less<T>{});
+        begin = values.begin() + low;
+
+        double result = entry_value<T>(values[low]);
+        if (frac > 0 && low + 1 < size) {
+            double next = entry_value<T>(
+                *std::min_element(begin + 1, values.end(), unboxed_less<T>{}));
+            result += (next - result) * frac;
+        }
+        out[out_ix] = result;
+    }
+}
+
+/** Parse a single `q` and check that it is in [0, 1]. Returns true with an exception
+    raised on failure.
+ */
+bool parse_q(PyObject* q_ob, double& q) {
+    q = PyFloat_AsDouble(q_ob);
+    if (q == -1.0 && PyErr_Occurred()) {
+        return true;
+    }
+    if (!(q >= 0 && q <= 1)) {
+        PyErr_SetString(PyExc_ValueError, "quantiles must be in the range [0, 1]");
+        return true;
+    }
+    return false;
+}
+
+PyObject* quantile(PyObject* module, PyObject* iterable, PyObject* q_ob) {
+    PyObject* list_ob = as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (self.boxed()) {
+        PyErr_SetString(PyExc_TypeError, "quantile() requires an int or float jlist");
+        return nullptr;
+    }
+    if (!self.size()) {
+        PyErr_SetString(PyExc_ValueError, "quantile() of an empty jlist");
+        return nullptr;
+    }
+
+    bool scalar = PyNumber_Check(q_ob);
+    std::vector<std::pair<double, Py_ssize_t>> qs;
+    if (scalar) {
+        double q;
+        if (parse_q(q_ob, q)) {
+            return nullptr;
+        }
+        qs.emplace_back(q, 0);
+    }
+    else {
+        PyObject* fast = PySequence_Fast(q_ob, "q must be a number or a sequence");
+        if (!fast) {
+            return nullptr;
+        }
+        scope_guard decref_fast([&] { Py_DECREF(fast); });
+
+        Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+        qs.resize(size);
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            if (parse_q(PySequence_Fast_GET_ITEM(fast, ix), qs[ix].first)) {
+                return nullptr;
+            }
+            qs[ix].second = ix;
+        }
+        std::sort(qs.begin(), qs.end());
+    }
+
+    std::vector<entry> values(self.entries);
+    std::vector<double> results(qs.size());
+    if (self.tag() == entry_tag::as_int) {
+        quantiles<std::int64_t>(values, qs, results);
+    }
+    else {
+        quantiles<double>(values, qs, results);
+    }
+
+    if (scalar) {
+        return PyFloat_FromDouble(results[0]);
+    }
+
+    jlist* out = new_jlist(module, entry_tag::as_double);
+    if (!out) {
+        return nullptr;
+    }
+    out->entries.resize(results.size());
+    for (std::size_t ix = 0; ix < results.size(); ++ix) {
+        out->entries[ix].as_double = results[ix];
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(quantile_doc,
+             "quantile(iterable, q)\n"
+             "\n"
+             "Compute the q-th quantile of the int or float values in the iterable.\n"
+             "\n"
+             "q may be a single number in [0, 1], in which case a float is returned, or\n"
+             "a sequence of numbers, in which case a jlist of floats is returned.\n"
+             "Values between two data points are linearly interpolated. This runs in\n"
+             "O(len(iterable)) time for each quantile instead of sorting.");
+
+PyObject* quantile(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* q_ob;
+
+    if (!PyArg_UnpackTuple(args, "quantile", 2, 2, &iterable, &q_ob)) {
+        return nullptr;
+    }
+    return detail::quantile(module, iterable, q_ob);
+}
+
+PyMethodDef quantile_method = {"quantile", quantile, METH_VARARGS, quantile_doc};
+
+PyDoc_STRVAR(median_doc,
+             "median(iterable)\n"
+             "\n"
+             "Return the median of the int or float values in the iterable as a float.\n"
+             "\n"
+             "When the number of values is even, the median is the mean of the two\n"
+             "middle values.");
+
+PyObject* median(PyObject* module, PyObject* iterable) {
+    PyObject* half = PyFloat_FromDouble(0.5);
+    if (!half) {
+        return nullptr;
+    }
+    PyObject* out = detail::quantile(module, iterable, half);
+    Py_DECREF(half);
+    return out;
+}
+
+PyMethodDef median_method = {"median", median, METH_O, median_doc};
+
+PyDoc_STRVAR(topk_doc,
+             "topk(iterable, k)\n"
+             "\n"
+             "Return a jlist of the k largest values in the iterable, largest first.\n"
+             "\n"
+             "Equivalent to:  jlist(sorted(iterable, reverse=True)[:k])");
+
+PyObject* topk(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* k_ob;
+
+    if (!PyArg_UnpackTuple(args, "topk", 2, 2, &iterable, &k_ob)) {
+        return nullptr;
+    }
+
+    Py_ssize_t k = PyNumber_AsSsize_t(k_ob, PyExc_OverflowError);
+    if (k == -1 && PyErr_Occurred()) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    PyObject* out = reinterpret_cast<PyObject*>(
+        detail::select_n<true>(module, *reinterpret_cast<jlist*>(list_ob), k));
+    Py_DECREF(list_ob);
+    return out;
+}
+
+PyMethodDef topk_method = {"topk", topk, METH_VARARGS, topk_doc};
+
+namespace detail {
+/** Map an unboxed value to an unsigned key which sorts in the same order.
+ */
+inline std::uint64_t radix_key(std::int64_t value) {
+    return static_cast<std::uint64_t>(value) ^ (std::uint64_t{1} << 63);
+}
+
+inline std::uint64_t radix_key(double value) {
+    if (value == 0) {
+        // -0.0 and 0.0 compare equal, so they must have the same key to be stable
+        value = 0;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // negative values sort in reverse order of their magnitude bits
+    return (bits >> 63) ? ~bits : bits | (std::uint64_t{1} << 63);
+}
+
+/** Stable LSD radix sort of the positions of the unboxed entries, one byte per pass.
+
+    All of the byte histograms are computed in a single pass over the input, and
+    passes where every key has the same byte are skipped, so small ranges of values
+    take fewer passes.
+ */
+template<typename T>
+void radix_argsort(const std::vector<entry>& entries, std::vector<Py_ssize_t>& out) {
+    struct keyed {
+        std::uint64_t key;
+        Py_ssize_t ix;
+    };
+
+    std::size_t size = entries.size();
+    std::vector<keyed> items(size);
+    std::vector<keyed> scratch(size);
+    std::array<std::array<std::size_t, 256>, sizeof(std::uint64_t)> counts{};
+
+    for (std::size_t ix = 0; ix < size; ++ix) {
+        std::uint64_t key = radix_key(entry_value<T>(entries[ix]));
+        items[ix] = {key, static_cast<Py_ssize_t>(ix)};
+        for (std::size_t byte = 0; byte < counts.size(); ++byte) {
+            ++counts[byte][(key >> (byte * 8)) & 0xff];
+        }
+    }
+
+    for (std::size_t byte = 0; byte < counts.size(); ++byte) {
+        std::array<std::size_t, 256>& count = counts[byte];
+        if (std::find(count.begin(), count.end(), size) != count.end()) {
+            continue;
+        }
+
+        std::size_t offset = 0;
+        for (std::size_t& c : count) {
+            std::size_t next = offset + c;
+            c = offset;
+            offset = next;
+        }
+        for (const keyed& item : items) {
+            scratch[count[(item.key >> (byte * 8)) & 0xff]++] = item;
+        }
+        std::swap(items, scratch);
+    }
+
+    out.resize(size);
+    for (std::size_t ix = 0; ix < size; ++ix) {
+        out[ix] = items[ix].ix;
+    }
+}
+
+/** Compute the permutation which sorts `self`. Returns true with a Python exception
+    raised if a comparison failed.
+ */
+bool argsort(jlist& self, bool stable, std::vector<Py_ssize_t>& positions) {
+    // below this size the histogram setup costs more than the comparisons
+    constexpr Py_ssize_t radix_threshold = 256;
+
+    if (!self.boxed() && self.size() >= radix_threshold) {
+        if (self.tag() == entry_tag::as_int) {
+            radix_argsort<std::int64_t>(self.entries, positions);
+        }
+        else {
+            radix_argsort<double>(self.entries, positions);
+        }
+        return false;
+    }
+
+    positions.resize(self.size());
+    for (Py_ssize_t ix = 0; ix < self.size(); ++ix) {
+        positions[ix] = ix;
+    }
+
+    return with_less(self, [&](auto less) {
+        auto cmp = [&](Py_ssize_t a, Py_ssize_t b) {
+            int r = less(self.entries[a], self.entries[b]);
+            if (r < 0) {
+                throw std::runtime_error("bad compare");
+            }
+            return r;
+        };
+
+        try {
+            // unboxed values are always sorted stably, their identity doesn't matter
+            // but their positions do
+            if (stable || !self.boxed()) {
+                std::stable_sort(positions.begin(), positions.end(), cmp);
+            }
+            else {
+                std::sort(positions.begin(), positions.end(), cmp);
+            }
+        }
+        catch (...) {
+            return true;
+        }
+        return false;
+    });
+}
+}  // namespace detail
+
+PyDoc_STRVAR(argsort_doc,
+             "argsort(iterable, stable=True)\n"
+             "\n"
+             "Return a jlist of the indices which would sort the iterable.\n"
+             "\n"
+             "Equivalent to:  jlist(sorted(range(len(x)), key=x.__getitem__))\n"
+             "\n"
+             "Integers and floats are sorted with a stable radix sort. When stable is\n"
+             "False, the order of indices of equal objects is unspecified.");
+
+PyObject* argsort(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"iterable", "stable", nullptr};
+    PyObject* iterable;
+    int stable = true;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|p:argsort",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &stable)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    std::vector<Py_ssize_t> positions;
+    if (detail::argsort(self, stable, positions)) {
+        return nullptr;
+    }
+
+    jlist* out = detail::new_jlist(module, entry_tag::as_int);
+    if (!out) {
+        return nullptr;
+    }
+    out->entries.resize(positions.size());
+    for (std::size_t ix = 0; ix < positions.size(); ++ix) {
+        out->entries[ix].as_int = positions[ix];
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef argsort_method = {"argsort",
+                              unsafe_cast_to_pycfunction(argsort),
+                              METH_VARARGS | METH_KEYWORDS,
+                              argsort_doc};
+
+PyDoc_STRVAR(take_doc,
+             "take(iterable, indices)\n"
+             "\n"
+             "Return a jlist of the values of the iterable at each of the indices.\n"
+             "\n"
+             "Equivalent to:  jlist(x[ix] for ix in indices)\n"
+             "\n"
+             "Negative indices count from the end, like normal indexing. This can be\n"
+             "used to apply the result of argsort to parallel jlists.");
+
+PyObject* take(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* indices_ob;
+
+    if (!PyArg_UnpackTuple(args, "take", 2, 2, &iterable, &indices_ob)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    PyObject* indices_list_ob = detail::as_jlist(module, indices_ob);
+    if (!indices_list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_indices([&] { Py_DECREF(indices_list_ob); });
+    jlist& indices = *reinterpret_cast<jlist*>(indices_list_ob);
+
+    if (indices.size() && indices.tag() != entry_tag::as_int) {
+        PyErr_SetString(PyExc_TypeError, "take() indices must be integers");
+        return nullptr;
+    }
+
+    jlist* out = detail::new_jlist(module, self.tag());
+    if (!out) {
+        return nullptr;
+    }
+    if (self.tag() == entry_tag::as_homogeneous_ob) {
+        out->homogeneous_type_ptr(self.homogeneous_type_ptr());
+    }
+
+    out->entries.resize(indices.size());
+    for (Py_ssize_t ix = 0; ix < indices.size(); ++ix) {
+        std::int64_t source_ix = indices.entries[ix].as_int;
+        if (source_ix < 0) {
+            source_ix += self.size();
+        }
+        if (source_ix < 0 || source_ix >= self.size()) {
+            out->entries.resize(ix);
+            Py_DECREF(out);
+            PyErr_SetString(PyExc_IndexError, "take() index out of range");
+            return nullptr;
+        }
+        out->entries[ix] = self.entries[source_ix];
+        if (self.boxed()) {
+            Py_INCREF(out->entries[ix].as_ob);
+        }
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef take_method = {"take", take, METH_VARARGS, take_doc};
+
+namespace detail {
+/** Find the first position in `[0, size)` where `pred` is false, assuming `pred` is
+    true for a prefix of the positions. This is `bisect` over a predicate.
+
+    This is written without a data dependent branch so the loads for the next step can
+    be issued before the comparison finishes. It only works for predicates which cannot
+    fail.
+ */
+template<typename Pred>
+Py_ssize_t branchless_partition_point(Py_ssize_t size, Pred pred) {
+    if (!size) {
+        return 0;
+    }
+    Py_ssize_t base = 0;
+    while (size > 1) {
+        Py_ssize_t half = size / 2;
+        base = pred(base + half) ? base + half : base;
+        size -= half;
+    }
+    return base + pred(base);
+}
+
+/** Like `branchless_partition_point`, but for predicates which may fail. Returns -1
+    with a Python exception raised on failure.
+ */
+template<typename Pred>
+Py_ssize_t partition_point(Py_ssize_t low, Py_ssize_t high, Pred pred) {
+    while (low < high) {
+        Py_ssize_t mid = low + (high - low) / 2;
+        int r = pred(mid);
+        if (r < 0) {
+            return -1;
+        }
+        if (r) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/** Predicate for `bisect_left` (`a[ix] < x`) or `bisect_right` (`not x < a[ix]`),
+    given a `less` comparator.
+ */
+template<bool right, typename Less>
+auto bisect_pred(jlist& self, Less less, entry x) {
+    return [&self, less, x](Py_ssize_t ix) -> int {
+        if constexpr (right) {
+            int r = less(x, self.entries[ix]);
+            return (r < 0) ? r : !r;
+        }
+        else {
+            return less(self.entries[ix], x);
+        }
+    };
+}
+
+/** Try to convert a probe into the same unboxed representation as a sorted jlist so
+    that it can be compared natively, without changing the result of the comparison.
+ */
+std::optional<entry> native_probe(jlist& self, PyObject* ob) {
+    // doubles can exactly represent integers of up to 53 bits
+    constexpr std::int64_t max_exact_double = std::int64_t{1} << 53;
+
+    entry e;
+    switch (self.tag()) {
+    case entry_tag::as_int:
+        if (auto maybe_int = maybe_unbox<std::int64_t>(ob)) {
+            e.as_int = *maybe_int;
+            return e;
+        }
+        return std::nullopt;
+    case entry_tag::as_double:
+        if (auto maybe_double = maybe_unbox<double>(ob)) {
+            e.as_double = *maybe_double;
+            return e;
+        }
+        if (auto maybe_int = maybe_unbox<std::int64_t>(ob)) {
+            if (*maybe_int >= -max_exact_double && *maybe_int <= max_exact_double) {
+                e.as_double = *maybe_int;
+                return e;
+            }
+        }
+        return std::nullopt;
+    default:
+        return std::nullopt;
+    }
+}
+
+/** Compute the insertion point of a single probe. Returns -1 with a Python exception
+    raised on failure.
+ */
+template<bool right>
+Py_ssize_t search_one(jlist& self, PyObject* ob) {
+    if (auto maybe_native = native_probe(self, ob)) {
+        entry x = *maybe_native;
+        if (self.tag() == entry_tag::as_int) {
+            return branchless_partition_point(
+                self.size(), bisect_pred<right>(self, unboxed_less<std::int64_t>{}, x));
+        }
+        return branchless_partition_point(
+            self.size(), bisect_pred<right>(self, unboxed_less<double>{}, x));
+    }
+
+    entry x;
+    x.as_ob = ob;
+    switch (self.tag()) {
+    case entry_tag::as_homogeneous_ob:
+        if (Py_TYPE(ob) == self.homogeneous_type_ptr()) {
+            homogeneous_less less{&self, self.size(), self.homogeneous_type_ptr()};
+            return partition_point(0, self.size(), bisect_pred<right>(self, less, x));
+        }
+        [[fallthrough]];
+    case entry_tag::as_heterogeneous_ob: {
+        heterogeneous_less less{&self, self.size()};
+        return partition_point(0, self.size(), bisect_pred<right>(self, less, x));
+    }
+    case entry_tag::unset:
+        return 0;
+    default:
+        break;
+    }
+
+    // the probe can't be compared natively with the unboxed values, box each value
+    // we visit
+    return partition_point(0, self.size(), [&](Py_ssize_t ix) -> int {
+        PyObject* boxed = box_entry(self, self.entries[ix]);
+        if (!boxed) {
+            return -1;
+        }
+        int r = (right) ? PyObject_RichCompareBool(ob, boxed, Py_LT)
+                        : PyObject_RichCompareBool(boxed, ob, Py_LT);
+        Py_DECREF(boxed);
+        if (r < 0) {
+            return r;
+        }
+        return (right) ? !r : r;
+    });
+}
+
+/** Compute the insertion points of probes with the same unboxed type as `self`.
+
+    When the probes are themselves sorted, each search starts where the previous one
+    ended and gallops forward, so the whole search is a merge of the two lists which
+    costs O(len(probes) * log(len(self) / len(probes))).
+ */
+template<bool right, typename T>
+void search_many(jlist& self, jlist& probes, jlist& out) {
+    out.entries.resize(probes.size());
+
+    bool sorted = std::is_sorted(probes.entries.begin(),
+                                 probes.entries.end(),
+                                 unboxed_less<T>{});
+    if (!sorted) {
+        for (Py_ssize_t ix = 0; ix < probes.size(); ++ix) {
+            out.entries[ix].as_int = branchless_partition_point(
+                self.size(),
+                bisect_pred<right>(self, unboxed_less<T>{}, probes.entries[ix]));
+        }
+        return;
+    }
+
+    Py_ssize_t low = 0;
+    for (Py_ssize_t ix = 0; ix < probes.size(); ++ix) {
+        auto pred = bisect_pred<right>(self, unboxed_less<T>{}, probes.entries[ix]);
+
+        // gallop to find a window containing the insertion point
+        Py_ssize_t step = 1;
+        Py_ssize_t high = low;
+        while (high < self.size() && pred(high)) {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        high = std::min(high, self.size());
+
+        low += branchless_partition_point(high - low, [&](Py_ssize_t offset) {
+            return pred(low + offset);
+        });
+        out.entries[ix].as_int = low;
+    }
+}
+
+template<bool right>
+PyObject* searchsorted(PyObject* module, jlist& self, PyObject* values) {
+    if (!(is_jlist(module, values) || PyList_CheckExact(values) ||
+          PyTuple_CheckExact(values))) {
+        Py_ssize_t ix = search_one<right>(self, values);
+        if (ix < 0) {
+            return nullptr;
+        }
+        return PyLong_FromSsize_t(ix);
+    }
+
+    PyObject* probes_ob = as_jlist(module, values);
+    if (!probes_ob) {
+        return nullptr;
+    }
+    scope_guard decref_probes([&] { Py_DECREF(probes_ob); });
+    jlist& probes = *reinterpret_cast<jlist*>(probes_ob);
+
+    jlist* out = new_jlist(module, entry_tag::as_int);
+    if (!out) {
+        return nullptr;
+    }
+
+    if (probes.tag() == self.tag() && self.tag() == entry_tag::as_int) {
+        search_many<right, std::int64_t>(self, probes, *out);
+    }
+    else if (probes.tag() == self.tag() && self.tag() == entry_tag::as_double) {
+        search_many<right, double>(self, probes, *out);
+    }
+    else {
+        out->entries.resize(probes.size());
+        for (Py_ssize_t ix = 0; ix < probes.size(); ++ix) {
+            PyObject* probe = box_entry(probes, probes.entries[ix]);
+            if (!probe) {
+                Py_DECREF(out);
+                return nullptr;
+            }
+            Py_ssize_t result = search_one<right>(self, probe);
+            Py_DECREF(probe);
+            if (result < 0) {
+                Py_DECREF(out);
+                return nullptr;
+            }
+            out->entries[ix].as_int = result;
+        }
+    }
+
+    return reinterpret_cast<PyObject*>(out);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(searchsorted_doc,
+             "searchsorted(sorted_jlist, values, side='left')\n"
+             "\n"
+             "Find the indices where values should be inserted to keep sorted_jlist\n"
+             "sorted.\n"
+             "\n"
+             "values may be a single value, in which case an int is returned, or a\n"
+             "jlist, list, or tuple of values, in which case an int jlist is returned.\n"
+             "side='left' gives the same result as bisect.bisect_left, side='right'\n"
+             "gives the same result as bisect.bisect_right.");
+
+PyObject* searchsorted(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"sorted_jlist", "values", "side", nullptr};
+    PyObject* list_ob;
+    PyObject* values;
+    const char* side = "left";
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "OO|s:searchsorted",
+                                     const_cast<char**>(keywords),
+                                     &list_ob,
+                                     &values,
+                                     &side)) {
+        return nullptr;
+    }
+
+    if (!detail::is_jlist(module, list_ob)) {
+        PyErr_Format(PyExc_TypeError,
+                     "searchsorted() argument must be a jlist, not %.200s",
+                     Py_TYPE(list_ob)->tp_name);
+        return nullptr;
+    }
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (!std::strcmp(side, "left")) {
+        return detail::searchsorted<false>(module, self, values);
+    }
+    else if (!std::strcmp(side, "right")) {
+        return detail::searchsorted<true>(module, self, values);
+    }
+
+    PyErr_Format(PyExc_ValueError, "side must be 'left' or 'right', got: '%s'", side);
+    return nullptr;
+}
+
+PyMethodDef searchsorted_method = {"searchsorted",
+                                   unsafe_cast_to_pycfunction(searchsorted),
+                                   METH_VARARGS | METH_KEYWORDS,
+                                   searchsorted_doc};
+
+namespace detail {
+/** A sorted range of entries being merged.
+ */
+struct run {
+    const entry* begin;
+    const entry* end;
+
+    bool empty() const {
+        return begin == end;
+    }
+};
+
+/** A tournament tree of losers for merging `k` sorted runs with `O(log k)`
+    comparisons per value.
+
+    Ties go to the run which came first, so the merge is stable. `Less` is one of the
+    comparators from `with_less`; a failed comparison throws so that the merge can be
+    driven by a plain loop.
+ */
+template<typename Less>
+class loser_tree {
+private:
+    std::vector<run>& m_runs;
+    Less m_less;
+    // m_tree[0] is the current winner, m_tree[1:] are the losers of each internal node;
+    // run `ix` is the leaf at `ix + k`
+    std::vector<Py_ssize_t> m_tree;
+
+    int less(entry a, entry b) const {
+        int r = m_less(a, b);
+        if (r < 0) {
+            throw std::runtime_error("bad compare");
+        }
+        return r;
+    }
+
+    /** Does run `a` come out before run `b`?
+     */
+    bool beats(Py_ssize_t a, Py_ssize_t b) const {
+        const run& lhs = m_runs[a];
+        const run& rhs = m_runs[b];
+        if (lhs.empty()) {
+            return false;
+        }
+        if (rhs.empty()) {
+            return true;
+        }
+        if (less(*rhs.begin, *lhs.begin)) {
+            return false;
+        }
+        // a <= b, so `a` only loses to an equal value from an earlier run
+        return a < b || less(*lhs.begin, *rhs.begin);
+    }
+
+    Py_ssize_t k() const {
+        return m_runs.size();
+    }
+
+public:
+    loser_tree(std::vector<run>& runs, Less less)
+        : m_runs(runs), m_less(less), m_tree(runs.size(), -1) {
+        for (Py_ssize_t leaf = 0; leaf < k(); ++leaf) {
+            Py_ssize_t candidate = leaf;
+            Py_ssize_t node = (leaf + k()) / 2;
+            for (; node > 0; node /= 2) {
+                if (m_tree[node] < 0) {
+                    // the first value to reach this node waits for its opponent
+                    m_tree[node] = candidate;
+                    break;
+                }
+                if (beats(m_tree[node], candidate)) {
+                    std::swap(m_tree[node], candidate);
+                }
+            }
+            if (!node) {
+                m_tree[0] = candidate;
+            }
+        }
+    }
+
+    /** Remove and return the smallest value. The runs must not all be empty.
+     */
+    entry pop() {
+        Py_ssize_t candidate = m_tree[0];
+        entry out = *m_runs[candidate].begin++;
+        for (Py_ssize_t node = (candidate + k()) / 2; node > 0; node /= 2) {
+            if (beats(m_tree[node], candidate)) {
+                std::swap(m_tree[node], candidate);
+            }
+        }
+        m_tree[0] = candidate;
+        return out;
+    }
+};
+
+/** If the unboxed runs don't overlap, copy them end to end into `out` and return true.
+ */
+template<typename T>
+bool concat_disjoint_runs(std::vector<run>& runs, std::vector<entry>& out) {
+    std::vector<run> ordered;
+    for (const run& r : runs) {
+        if (!r.empty()) {
+            ordered.emplace_back(r);
+        }
+    }
+
+    // stable so that runs with the same first value stay in argument order
+    std::stable_sort(ordered.begin(), ordered.end(), [](const run& a, const run& b) {
+        return entry_value<T>(*a.begin) < entry_value<T>(*b.begin);
+    });
+    for (std::size_t ix = 1; ix < ordered.size(); ++ix) {
+        T previous_last = entry_value<T>(*(ordered[ix - 1].end - 1));
+        if (entry_value<T>(*ordered[ix].begin) < previous_last) {
+            return false;
+        }
+    }
+
+    for (const run& r : ordered) {
+        out.insert(out.end(), r.begin, r.end);
+    }
+    return true;
+}
+
+/** Merge the `runs` into `out`. Returns true with a Python exception raised if a
+    comparison failed.
+ */
+template<typename Less>
+bool merge_runs(std::vector<run>& runs, Less less, std::vector<entry>& out) {
+    std::size_t size = 0;
+    for (const run& r : runs) {
+        size += r.end - r.begin;
+    }
+    out.reserve(size);
+
+    try {
+        loser_tree<Less> tree(runs, less);
+        for (std::size_t ix = 0; ix < size; ++ix) {
+            out.emplace_back(tree.pop());
+        }
+    }
+    catch (...) {
+        out.clear();
+        return true;
+    }
+    return false;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(merge_doc,
+             "merge(*iterables)\n"
+             "\n"
+             "Merge multiple sorted inputs into a single sorted jlist.\n"
+             "\n"
+             "Equivalent to:  jlist(heapq.merge(*iterables))\n"
+             "\n"
+             "Inputs which hold only ints or only floats are merged on the unboxed\n"
+             "values, and are simply concatenated when their ranges don't overlap.");
+
+PyObject* merge(PyObject* module, PyObject* args) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+
+    Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+    std::vector<PyObject*> inputs;
+    scope_guard decref_inputs([&] {
+        for (PyObject* ob : inputs) {
+            Py_DECREF(ob);
+        }
+    });
+    for (Py_ssize_t ix = 0; ix < nargs; ++ix) {
+        PyObject* list_ob = detail::as_jlist(module, PyTuple_GET_ITEM(args, ix));
+        if (!list_ob) {
+            return nullptr;
+        }
+        inputs.emplace_back(list_ob);
+    }
+
+    // when the inputs all have the same unboxed tag, merge directly out of them
+    entry_tag tag = entry_tag::unset;
+    bool same_unboxed_tag = true;
+    for (PyObject* ob : inputs) {
+        jlist& list = *reinterpret_cast<jlist*>(ob);
+        if (!list.size()) {
+            continue;
+        }
+        if (list.boxed() || (tag != entry_tag::unset && tag != list.tag())) {
+            same_unboxed_tag = false;
+            break;
+        }
+        tag = list.tag();
+    }
+
+    if (same_unboxed_tag) {
+        std::vector<detail::run> runs;
+        for (PyObject* ob : inputs) {
+            jlist& list = *reinterpret_cast<jlist*>(ob);
+            runs.push_back({list.entries.data(), list.entries.data() + list.size()});
+        }
+
+        jlist* out = detail::new_jlist(module, tag);
+        if (!out) {
+            return nullptr;
+        }
+        if (tag == entry_tag::as_int) {
+            if (!detail::concat_disjoint_runs<std::int64_t>(runs, out->entries)) {
+                detail::merge_runs(runs,
+                                   detail::unboxed_less<std::int64_t>{},
+                                   out->entries);
+            }
+        }
+        else if (tag == entry_tag::as_double) {
+            if (!detail::concat_disjoint_runs<double>(runs, out->entries)) {
+                detail::merge_runs(runs, detail::unboxed_less<double>{}, out->entries);
+            }
+        }
+        return reinterpret_cast<PyObject*>(out);
+    }
+
+    // Otherwise, concatenate the inputs to get a common representation and merge the
+    // runs out of that. This list is private so the comparisons can't mutate it.
+    PyObject* all_ob = PyObject_CallFunctionObjArgs(
+        reinterpret_cast<PyObject*>(state->jlist_type), nullptr);
+    if (!all_ob) {
+        return nullptr;
+    }
+    scope_guard decref_all([&] { Py_DECREF(all_ob); });
+
+    std::vector<Py_ssize_t> sizes;
+    for (PyObject* ob : inputs) {
+        PyObject* result = PySequence_InPlaceConcat(all_ob, ob);
+        if (!result) {
+            return nullptr;
+        }
+        Py_DECREF(result);
+        sizes.emplace_back(reinterpret_cast<jlist*>(ob)->size());
+    }
+    jlist& all = *reinterpret_cast<jlist*>(all_ob);
+
+    std::vector<detail::run> runs;
+    const entry* begin = all.entries.data();
+    for (Py_ssize_t size : sizes) {
+        runs.push_back({begin, begin + size});
+        begin += size;
+    }
+
+    jlist* out = detail::new_jlist(module, all.tag());
+    if (!out) {
+        return nullptr;
+    }
+    if (all.tag() == entry_tag::as_homogeneous_ob) {
+        out->homogeneous_type_ptr(all.homogeneous_type_ptr());
+    }
+
+    if (detail::with_less(all, [&](auto less) {
+            return detail::merge_runs(runs, less, out->entries);
+        })) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    for (entry e : out->entries) {
+        Py_INCREF(e.as_ob);
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef merge_method = {"merge", merge, METH_VARARGS, merge_doc};
+
+namespace detail {
+/** Parse the window size of a rolling aggregation. Returns true with an exception
+    raised on failure.
+ */
+bool parse_window(PyObject* window_ob, Py_ssize_t& window) {
+    window = PyNumber_AsSsize_t(window_ob, PyExc_OverflowError);
+    if (window == -1 && PyErr_Occurred()) {
+        return true;
+    }
+    if (window < 1) {
+        PyErr_SetString(PyExc_ValueError, "window must be at least 1");
+        return true;
+    }
+    return false;
+}
+
+/** Box an `__int128` as a Python int.
+ */
+PyObject* box_int128(__int128 value) {
+    if (value >= std::numeric_limits<std::int64_t>::min() &&
+        value <= std::numeric_limits<std::int64_t>::max()) {
+        return PyLong_FromLongLong(static_cast<std::int64_t>(value));
+    }
+    unsigned char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    return _PyLong_FromByteArray(bytes, sizeof(bytes), /* little_endian */ 1,
+                                 /* is_signed */ 1);
+}
+
+/** A running sum of floats which can also remove values.
+
+    Finite values are summed with Neumaier's compensated summation so that values
+    leaving the window don't leave rounding error behind. Infinities and NaNs are
+    counted instead of summed so that they stop affecting the result once they leave
+    the window.
+ */
+class sliding_sum {
+private:
+    double m_sum = 0;
+    double m_compensation = 0;
+    Py_ssize_t m_pos_inf = 0;
+    Py_ssize_t m_neg_inf = 0;
+    Py_ssize_t m_nan = 0;
+
+    void add_finite(double value) {
+        double t = m_sum + value;
+        if (std::abs(m_sum) >= std::abs(value)) {
+            m_compensation += (m_sum - t) + value;
+        }
+        else {
+            m_compensation += (value - t) + m_sum;
+        }
+        m_sum = t;
+    }
+
+    void count(double value, Py_ssize_t direction) {
+        if (std::isnan(value)) {
+            m_nan += direction;
+        }
+        else if (value > 0) {
+            m_pos_inf += direction;
+        }
+        else {
+            m_neg_inf += direction;
+        }
+    }
+
+public:
+    void add(double value) {
+        if (std::isfinite(value)) {
+            add_finite(value);
+        }
+        else {
+            count(value, 1);
+        }
+    }
+
+    void remove(double value) {
+        if (std::isfinite(value)) {
+            add_finite(-value);
+        }
+        else {
+            count(value, -1);
+        }
+    }
+
+    double value() const {
+        if (m_nan || (m_pos_inf && m_neg_inf)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (m_pos_inf) {
+            return std::numeric_limits<double>::infinity();
+        }
+        if (m_neg_inf) {
+            return -std::numeric_limits<double>::infinity();
+        }
+        return m_sum + m_compensation;
+    }
+};
+
+/** Sum each window of ints exactly. The sums stay unboxed unless one doesn't fit in
+    an int64; then, like `sum`, they are all Python ints. Returns true with an
+    exception raised on failure.
+ */
+bool rolling_sum(const std::vector<entry>& values,
+                 Py_ssize_t window,
+                 std::int64_t,
+                 jlist& out) {
+    // call `emit` with each window's sum, stopping if it returns true
+    auto windows = [&](auto&& emit) {
+        __int128 sum = 0;
+        for (std::size_t ix = 0; ix < values.size(); ++ix) {
+            sum += values[ix].as_int;
+            if (ix < static_cast<std::size_t>(window) - 1) {
+                continue;
+            }
+            if (emit(sum)) {
+                return true;
+            }
+            sum -= values[ix + 1 - window].as_int;
+        }
+        return false;
+    };
+
+    bool overflowed = windows([&](__int128 sum) {
+        if (sum > std::numeric_limits<std::int64_t>::max() ||
+            sum < std::numeric_limits<std::int64_t>::min()) {
+            return true;
+        }
+        out.entries.emplace_back().as_int = static_cast<std::int64_t>(sum);
+        return false;
+    });
+    if (!overflowed) {
+        return false;
+    }
+
+    out.entries.clear();
+    out.homogeneous_type_ptr(&PyLong_Type);
+    return windows([&](__int128 sum) {
+        PyObject* ob = box_int128(sum);
+        if (!ob) {
+            return true;
+        }
+        out.entries.emplace_back().as_ob = ob;
+        return false;
+    });
+}
+
+bool rolling_sum(const std::vector<entry>& values,
+                 Py_ssize_t window,
+                 double,
+                 jlist& out) {
+    sliding_sum sum;
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        sum.add(values[ix].as_double);
+        if (ix < static_cast<std::size_t>(window) - 1) {
+            continue;
+        }
+        out.entries.emplace_back().as_double = sum.value();
+        sum.remove(values[ix + 1 - window].as_double);
+    }
+    return false;
+}
+
+void rolling_mean(const std::vector<entry>& values,
+                  Py_ssize_t window,
+                  std::int64_t,
+                  std::vector<entry>& out) {
+    __int128 sum = 0;
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        sum += values[ix].as_int;
+        if (ix < static_cast<std::size_t>(window) - 1) {
+            continue;
+        }
+        out.emplace_back().as_double = static_cast<double>(sum) / window;
+        sum -= values[ix + 1 - window].as_int;
+    }
+}
+
+void rolling_mean(const std::vector<entry>& values,
+                  Py_ssize_t window,
+                  double,
+                  std::vector<entry>& out) {
+    sliding_sum sum;
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        sum.add(values[ix].as_double);
+        if (ix < static_cast<std::size_t>(window) - 1) {
+            continue;
+        }
+        out.emplace_back().as_double = sum.value() / window;
+        sum.remove(values[ix + 1 - window].as_double);
+    }
+}
+
+/** Compute the min (or max) of each window with a monotonic deque of positions.
+
+    The deque holds the positions of the values which may still become the extreme of
+    a later window, with their values in increasing (or decreasing) order; each
+    position is pushed and popped at most once.
+ */
+template<bool max, typename T>
+void rolling_extreme(const std::vector<entry>& values,
+                     Py_ssize_t window,
+                     std::vector<entry>& out) {
+    std::vector<Py_ssize_t> deque(values.size());
+    Py_ssize_t head = 0;
+    Py_ssize_t tail = 0;
+    for (Py_ssize_t ix = 0; ix < static_cast<Py_ssize_t>(values.size()); ++ix) {
+        T value = entry_value<T>(values[ix]);
+        while (tail > head) {
+            T back = entry_value<T>(values[deque[tail - 1]]);
+            if (max ? back > value : back < value) {
+                break;
+            }
+            --tail;
+        }
+        deque[tail++] = ix;
+        if (deque[head] <= ix - window) {
+            ++head;
+        }
+        if (ix >= window - 1) {
+            out.emplace_back(values[deque[head]]);
+        }
+    }
+}
+
+/** Compute the standard deviation of each window from sliding sums of the values and
+    their squares.
+
+    The values are shifted by a value near the mean so that the squares don't cancel
+    out. When the mean of a window drifts far from the shift relative to its spread,
+    the window is summed again around its own mean. This happens at most once per
+    `window` values so the total work stays O(len(values)).
+ */
+template<typename T>
+void rolling_std(const std::vector<entry>& values,
+                 Py_ssize_t window,
+                 Py_ssize_t ddof,
+                 std::vector<entry>& out) {
+    double shift = 0;
+    sliding_sum sum;
+    sliding_sum sum_sq;
+    Py_ssize_t non_finite = 0;
+
+    auto update = [&](double value, bool add) {
+        if (!std::isfinite(value)) {
+            non_finite += (add) ? 1 : -1;
+            return;
+        }
+        double delta = value - shift;
+        if (add) {
+            sum.add(delta);
+            sum_sq.add(delta * delta);
+        }
+        else {
+            sum.remove(delta);
+            sum_sq.remove(delta * delta);
+        }
+    };
+    auto reshift = [&](double new_shift, std::size_t begin, std::size_t end) {
+        shift = new_shift;
+        sum = {};
+        sum_sq = {};
+        for (std::size_t ix = begin; ix < end; ++ix) {
+            double value = entry_value<T>(values[ix]);
+            if (std::isfinite(value)) {
+                update(value, true);
+            }
+        }
+    };
+
+    for (entry e : values) {
+        double value = entry_value<T>(e);
+        if (std::isfinite(value)) {
+            shift = value;
+            break;
+        }
+    }
+
+    Py_ssize_t since_shift = 0;
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        update(entry_value<T>(values[ix]), true);
+        if (ix < static_cast<std::size_t>(window) - 1) {
+            continue;
+        }
+
+        double mean = sum.value() / window;
+        double m2 = sum_sq.value() - sum.value() * mean;
+        if (!non_finite && ++since_shift >= window && mean * mean * window > 64 * m2) {
+            reshift(shift + mean, ix + 1 - window, ix + 1);
+            since_shift = 0;
+            m2 = sum_sq.value() - sum.value() * (sum.value() / window);
+        }
+
+        out.emplace_back().as_double =
+            non_finite ? std::numeric_limits<double>::quiet_NaN()
+                       : std::sqrt(std::max(m2, 0.0) / (window - ddof));
+        update(entry_value<T>(values[ix + 1 - window]), false);
+    }
+}
+
+/** Run a rolling aggregation `f(values, window, T{}, out)` over the int or float values
+    of `iterable`, where `out` is the result jlist.
+
+    `out_tag` is the tag of the result for int inputs; float inputs always produce
+    floats. `f` returns true with an exception raised on failure.
+ */
+template<typename F>
+PyObject* rolling(PyObject* module,
+                  const char* name,
+                  PyObject* iterable,
+                  PyObject* window_ob,
+                  entry_tag out_tag,
+                  F&& f) {
+    Py_ssize_t window;
+    if (parse_window(window_ob, window)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (self.boxed()) {
+        PyErr_Format(PyExc_TypeError, "%s() requires an int or float jlist", name);
+        return nullptr;
+    }
+
+    jlist* out = new_jlist(module,
+                           (self.tag() == entry_tag::as_double) ? entry_tag::as_double
+                                                                : out_tag);
+    if (!out) {
+        return nullptr;
+    }
+    if (self.size() < window) {
+        return reinterpret_cast<PyObject*>(out);
+    }
+    out->entries.reserve(self.size() - window + 1);
+
+    bool err;
+    if (self.tag() == entry_tag::as_int) {
+        err = f(self.entries, window, std::int64_t{}, *out);
+    }
+    else {
+        err = f(self.entries, window, double{}, *out);
+    }
+    if (err) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(rolling_sum_doc,
+             "rolling_sum(iterable, window)\n"
+             "\n"
+             "Return a jlist of the sums of each window of consecutive values.\n"
+             "\n"
+             "Equivalent to:\n"
+             "    jlist(sum(x[i:i + window]) for i in range(len(x) - window + 1))\n"
+             "\n"
+             "The values must all be ints or all be floats. Int sums are exact; if\n"
+             "one doesn't fit in 64 bits, the sums are returned as Python ints.");
+
+PyObject* rolling_sum(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* window_ob;
+
+    if (!PyArg_UnpackTuple(args, "rolling_sum", 2, 2, &iterable, &window_ob)) {
+        return nullptr;
+    }
+    return detail::rolling(module,
+                           "rolling_sum",
+                           iterable,
+                           window_ob,
+                           entry_tag::as_int,
+                           [](const std::vector<entry>& values,
+                              Py_ssize_t window,
+                              auto type,
+                              jlist& out) {
+                               return detail::rolling_sum(values, window, type, out);
+                           });
+}
+
+PyMethodDef rolling_sum_method = {"rolling_sum",
+                                  rolling_sum,
+                                  METH_VARARGS,
+                                  rolling_sum_doc};
+
+PyDoc_STRVAR(rolling_mean_doc,
+             "rolling_mean(iterable, window)\n"
+             "\n"
+             "Return a jlist of the means of each window of consecutive values.\n"
+             "\n"
+             "Equivalent to:\n"
+             "    jlist(statistics.fmean(x[i:i + window])\n"
+             "          for i in range(len(x) - window + 1))");
+
+PyObject* rolling_mean(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* window_ob;
+
+    if (!PyArg_UnpackTuple(args, "rolling_mean", 2, 2, &iterable, &window_ob)) {
+        return nullptr;
+    }
+    return detail::rolling(module,
+                           "rolling_mean",
+                           iterable,
+                           window_ob,
+                           entry_tag::as_double,
+                           [](const std::vector<entry>& values,
+                              Py_ssize_t window,
+                              auto type,
+                              jlist& out) {
+                               detail::rolling_mean(values, window, type, out.entries);
+                               return false;
+                           });
+}
+
+PyMethodDef rolling_mean_method = {"rolling_mean",
+                                   rolling_mean,
+                                   METH_VARARGS,
+                                   rolling_mean_doc};
+
+template<bool max>
+PyObject* rolling_extreme(PyObject* module, PyObject* args) {
+    const char* name = (max) ? "rolling_max" : "rolling_min";
+    PyObject* iterable;
+    PyObject* window_ob;
+
+    if (!PyArg_UnpackTuple(args, name, 2, 2, &iterable, &window_ob)) {
+        return nullptr;
+    }
+    return detail::rolling(module,
+                           name,
+                           iterable,
+                           window_ob,
+                           entry_tag::as_int,
+                           [](const std::vector<entry>& values,
+                              Py_ssize_t window,
+                              auto type,
+                              jlist& out) {
+                               detail::rolling_extreme<max, decltype(type)>(values,
+                                                                            window,
+                                                                            out.entries);
+                               return false;
+                           });
+}
+
+PyDoc_STRVAR(rolling_min_doc,
+             "rolling_min(iterable, window)\n"
+             "\n"
+             "Return a jlist of the minimums of each window of consecutive values.\n"
+             "\n"
+             "Equivalent to:\n"
+             "    jlist(min(x[i:i + window]) for i in range(len(x) - window + 1))\n"
+             "\n"
+             "This runs in O(len(iterable)) time regardless of the window size.");
+
+PyMethodDef rolling_min_method = {"rolling_min",
+                                  rolling_extreme<false>,
+                                  METH_VARARGS,
+                                  rolling_min_doc};
+
+PyDoc_STRVAR(rolling_max_doc,
+             "rolling_max(iterable, window)\n"
+             "\n"
+             "Return a jlist of the maximums of each window of consecutive values.\n"
+             "\n"
+             "Equivalent to:\n"
+             "    jlist(max(x[i:i + window]) for i in range(len(x) - window + 1))\n"
+             "\n"
+             "This runs in O(len(iterable)) time regardless of the window size.");
+
+PyMethodDef rolling_max_method = {"rolling_max",
+                                  rolling_extreme<true>,
+                                  METH_VARARGS,
+                                  rolling_max_doc};
+
+PyDoc_STRVAR(rolling_std_doc,
+             "rolling_std(iterable, window, ddof=0)\n"
+             "\n"
+             "Return a jlist of the standard deviations of each window of consecutive\n"
+             "values.\n"
+             "\n"
+             "The sum of squared deviations is divided by window - ddof, so ddof=0\n"
+             "gives the population standard deviation and ddof=1 gives the sample\n"
+             "standard deviation. Windows which contain an infinity or NaN are NaN.");
+
+PyObject* rolling_std(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"iterable", "window", "ddof", nullptr};
+    PyObject* iterable;
+    PyObject* window_ob;
+    Py_ssize_t ddof = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "OO|n:rolling_std",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &window_ob,
+                                     &ddof)) {
+        return nullptr;
+    }
+    if (ddof < 0) {
+        PyErr_SetString(PyExc_ValueError, "ddof must be non-negative");
+        return nullptr;
+    }
+    // check the window here so that inputs shorter than the window are rejected too
+    Py_ssize_t window;
+    if (detail::parse_window(window_ob, window)) {
+        return nullptr;
+    }
+    if (window <= ddof) {
+        PyErr_SetString(PyExc_ValueError, "window must be greater than ddof");
+        return nullptr;
+    }
+    return detail::rolling(module,
+                           "rolling_std",
+                           iterable,
+                           window_ob,
+                           entry_tag::as_double,
+                           [&](const std::vector<entry>& values,
+                               Py_ssize_t window,
+                               auto type,
+                               jlist& out) {
+                               detail::rolling_std<decltype(type)>(values,
+                                                                   window,
+                                                                   ddof,
+                                                                   out.entries);
+                               return false;
+                           });
+}
+
+PyMethodDef rolling_std_method = {"rolling_std",
+                                  unsafe_cast_to_pycfunction(rolling_std),
+                                  METH_VARARGS | METH_KEYWORDS,
+                                  rolling_std_doc};
+
+namespace detail {
+/** The groups of an int key column.
+ */
+struct groups {
+    /** The distinct keys in ascending order.
+     */
+    std::vector<std::int64_t> keys;
+
+    /** The index into `keys` of each row. Empty when `sorted` is set.
+     */
+    std::vector<Py_ssize_t> ids;
+
+    /** The first row of each group.
+     */
+    std::vector<Py_ssize_t> first;
+
+    /** Whether the keys were sorted, making each group a contiguous run of rows which
+        starts at `first[id]` and ends at the start of the next group.
+     */
+    bool sorted = false;
+};
+
+/** Assign each row of `keys` to a group.
+
+    Sorted keys are split into runs without any lookups or per-row ids. Otherwise, when
+    the range of the keys is small relative to the number of rows, the groups are found
+    with a dense table indexed by `key - min`, and with a hash table when it is not.
+ */
+void factorize(const std::vector<entry>& keys, groups& out) {
+    Py_ssize_t size = keys.size();
+    if (!size) {
+        return;
+    }
+
+    bool sorted = true;
+    std::int64_t min = keys[0].as_int;
+    std::int64_t max = min;
+    for (Py_ssize_t ix = 1; ix < size; ++ix) {
+        std::int64_t key = keys[ix].as_int;
+        sorted &= keys[ix - 1].as_int <= key;
+        min = std::min(min, key);
+        max = std::max(max, key);
+    }
+
+    if (sorted) {
+        out.sorted = true;
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            std::int64_t key = keys[ix].as_int;
+            if (!ix || key != out.keys.back()) {
+                out.keys.emplace_back(key);
+                out.first.emplace_back(ix);
+            }
+        }
+        return;
+    }
+
+    out.ids.resize(size);
+
+    // subtract as unsigned so that the range of extreme keys doesn't overflow
+    std::uint64_t range = static_cast<std::uint64_t>(max) -
+                          static_cast<std::uint64_t>(min);
+    if (range < 2 * static_cast<std::uint64_t>(size) + 1024) {
+        // store the first row of each key, then number the keys which appear in order
+        std::vector<Py_ssize_t> table(range + 1, -1);
+        for (Py_ssize_t ix = size - 1; ix >= 0; --ix) {
+            table[keys[ix].as_int - min] = ix;
+        }
+        for (std::uint64_t offset = 0; offset <= range; ++offset) {
+            if (table[offset] >= 0) {
+                out.first.emplace_back(table[offset]);
+                table[offset] = out.keys.size();
+                out.keys.emplace_back(min + static_cast<std::int64_t>(offset));
+            }
+        }
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            out.ids[ix] = table[keys[ix].as_int - min];
+        }
+        return;
+    }
+
+    // number the keys in order of appearance, then renumber them in sorted order
+    int_hash_table table;
+    std::vector<Py_ssize_t> first;
+    for (Py_ssize_t ix = 0; ix < size; ++ix) {
+        Py_ssize_t id = table.insert(keys[ix].as_int, first.size());
+        if (id == static_cast<Py_ssize_t>(first.size())) {
+            first.emplace_back(ix);
+        }
+        out.ids[ix] = id;
+    }
+
+    std::vector<std::pair<std::int64_t, Py_ssize_t>> order(first.size());
+    for (std::size_t id = 0; id < order.size(); ++id) {
+        order[id] = {keys[first[id]].as_int, id};
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<Py_ssize_t> renumber(order.size());
+    for (std::size_t id = 0; id < order.size(); ++id) {
+        auto [key, old_id] = order[id];
+        renumber[old_id] = id;
+        out.keys.emplace_back(key);
+        out.first.emplace_back(first[old_id]);
+    }
+    for (Py_ssize_t& id : out.ids) {
+        id = renumber[id];
+    }
+}
+
+enum class group_op {
+    count,
+    sum,
+    min,
+    max,
+    mean,
+};
+
+/** Fold the rows of each group into `accs[id]` with `f(acc, ix)`.
+
+    Sorted keys are reduced one contiguous run at a time with the accumulator held in a
+    local, otherwise each row is folded into its group's accumulator through `ids`.
+ */
+template<typename Acc, typename F>
+void reduce_groups(const groups& groups, Py_ssize_t size, std::vector<Acc>& accs, F&& f) {
+    if (groups.sorted) {
+        for (std::size_t id = 0; id < accs.size(); ++id) {
+            Py_ssize_t end = (id + 1 < accs.size()) ? groups.first[id + 1] : size;
+            Acc acc = accs[id];
+            for (Py_ssize_t ix = groups.first[id]; ix < end; ++ix) {
+                f(acc, ix);
+            }
+            accs[id] = acc;
+        }
+    }
+    else {
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            f(accs[groups.ids[ix]], ix);
+        }
+    }
+}
+
+/** Reduce the values of each group into `out`.
+
+    Int sums are accumulated in 128 bits and, like `sum`, fall back to Python ints when
+    one doesn't fit in an int64. Returns true with an exception raised on failure.
+ */
+template<typename T>
+bool group_reduce(group_op op,
+                  const std::vector<entry>& values,
+                  const groups& groups,
+                  jlist& out) {
+    Py_ssize_t size = values.size();
+    std::size_t count = groups.keys.size();
+
+    switch (op) {
+    case group_op::sum: {
+        using acc_type = std::conditional_t<std::is_same_v<T, double>, double, __int128>;
+        std::vector<acc_type> sums(count, 0);
+        reduce_groups(groups, size, sums, [&](acc_type& acc, Py_ssize_t ix) {
+            acc += entry_value<T>(values[ix]);
+        });
+
+        if constexpr (std::is_same_v<T, std::int64_t>) {
+            bool fits = std::all_of(sums.begin(), sums.end(), [](__int128 sum) {
+                return sum >= std::numeric_limits<std::int64_t>::min() &&
+                       sum <= std::numeric_limits<std::int64_t>::max();
+            });
+            if (!fits) {
+                out.homogeneous_type_ptr(&PyLong_Type);
+                for (__int128 sum : sums) {
+                    PyObject* ob = box_int128(sum);
+                    if (!ob) {
+                        return true;
+                    }
+                    out.entries.emplace_back().as_ob = ob;
+                }
+                return false;
+            }
+        }
+        out.entries.resize(count);
+        for (std::size_t id = 0; id < count; ++id) {
+            entry_value<T>(out.entries[id]) = static_cast<T>(sums[id]);
+        }
+        return false;
+    }
+    case group_op::min:
+    case group_op::max: {
+        std::vector<T> accs(count);
+        for (std::size_t id = 0; id < count; ++id) {
+            accs[id] = entry_value<T>(values[groups.first[id]]);
+        }
+        reduce_groups(groups, size, accs, [&](T& acc, Py_ssize_t ix) {
+            T value = entry_value<T>(values[ix]);
+            if ((op == group_op::min) ? value < acc : acc < value) {
+                acc = value;
+            }
+        });
+        out.entries.resize(count);
+        for (std::size_t id = 0; id < count; ++id) {
+            entry_value<T>(out.entries[id]) = accs[id];
+        }
+        return false;
+    }
+    case group_op::mean: {
+        std::vector<std::pair<double, Py_ssize_t>> accs(count, {0.0, 0});
+        reduce_groups(groups,
+                      size,
+                      accs,
+                      [&](std::pair<double, Py_ssize_t>& acc, Py_ssize_t ix) {
+                          acc.first += entry_value<T>(values[ix]);
+                          ++acc.second;
+                      });
+        out.entries.resize(count);
+        for (std::size_t id = 0; id < count; ++id) {
+            out.entries[id].as_double = accs[id].first / accs[id].second;
+        }
+        return false;
+    }
+    default:
+        __builtin_unreachable();
+    }
+}
+
+PyObject* group(PyObject* module,
+                const char* name,
+                group_op op,
+                PyObject* values_ob,
+                PyObject* keys_ob) {
+    PyObject* keys_list_ob = as_jlist(module, keys_ob);
+    if (!keys_list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_keys([&] { Py_DECREF(keys_list_ob); });
+    jlist& keys = *reinterpret_cast<jlist*>(keys_list_ob);
+
+    if (keys.tag() != entry_tag::as_int && keys.tag() != entry_tag::unset) {
+        PyErr_Format(PyExc_TypeError, "%s() requires an int jlist of keys", name);
+        return nullptr;
+    }
+
+    PyObject* values_list_ob = nullptr;
+    scope_guard decref_values([&] { Py_XDECREF(values_list_ob); });
+    entry_tag out_tag = entry_tag::as_int;
+    if (op != group_op::count) {
+        values_list_ob = as_jlist(module, values_ob);
+        if (!values_list_ob) {
+            return nullptr;
+        }
+        jlist& values = *reinterpret_cast<jlist*>(values_list_ob);
+        if (values.boxed()) {
+            PyErr_Format(PyExc_TypeError, "%s() requires an int or float jlist", name);
+            return nullptr;
+        }
+        if (values.size() != keys.size()) {
+            PyErr_Format(PyExc_ValueError,
+                         "%s() values and keys must be the same length, got %zd and %zd",
+                         name,
+                         values.size(),
+                         keys.size());
+            return nullptr;
+        }
+        if (op == group_op::mean || values.tag() == entry_tag::as_double) {
+            out_tag = entry_tag::as_double;
+        }
+    }
+
+    groups groups;
+    factorize(keys.entries, groups);
+
+    jlist* out_keys = new_jlist(module, entry_tag::as_int);
+    if (!out_keys) {
+        return nullptr;
+    }
+    out_keys->entries.resize(groups.keys.size());
+    for (std::size_t id = 0; id < groups.keys.size(); ++id) {
+        out_keys->entries[id].as_int = groups.keys[id];
+    }
+
+    jlist* out = new_jlist(module, out_tag);
+    if (!out) {
+        Py_DECREF(out_keys);
+        return nullptr;
+    }
+
+    bool err = false;
+    if (op == group_op::count) {
+        std::vector<std::int64_t> counts(groups.keys.size(), 0);
+        reduce_groups(groups, keys.size(), counts, [](std::int64_t& acc, Py_ssize_t) {
+            ++acc;
+        });
+        out->entries.resize(counts.size());
+        for (std::size_t id = 0; id < counts.size(); ++id) {
+            out->entries[id].as_int = counts[id];
+        }
+    }
+    else {
+        jlist& values = *reinterpret_cast<jlist*>(values_list_ob);
+        if (values.tag() == entry_tag::as_double) {
+            err = group_reduce<double>(op, values.entries, groups, *out);
+        }
+        else {
+            err = group_reduce<std::int64_t>(op, values.entries, groups, *out);
+        }
+    }
+
+    PyObject* result = nullptr;
+    if (!err) {
+        result = PyTuple_Pack(2, out_keys, out);
+    }
+    Py_DECREF(out_keys);
+    Py_DECREF(out);
+    return result;
+}
+
+template<group_op op>
+PyObject* group(PyObject* module, PyObject* args) {
+    const char* name;
+    switch (op) {
+    case group_op::sum:
+        name = "group_sum";
+        break;
+    case group_op::min:
+        name = "group_min";
+        break;
+    case group_op::max:
+        name = "group_max";
+        break;
+    case group_op::mean:
+        name = "group_mean";
+        break;
+    default:
+        __builtin_unreachable();
+    }
+
+    PyObject* values;
+    PyObject* keys;
+    if (!PyArg_UnpackTuple(args, name, 2, 2, &values, &keys)) {
+        return nullptr;
+    }
+    return group(module, name, op, values, keys);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(group_count_doc,
+             "group_count(keys)\n"
+             "\n"
+             "Count the occurrences of each distinct int key.\n"
+             "\n"
+             "Returns a pair of jlists: the distinct keys in ascending order, and the\n"
+             "number of times each key appears.");
+
+PyObject* group_count(PyObject* module, PyObject* keys) {
+    return detail::group(module, "group_count", detail::group_op::count, nullptr, keys);
+}
+
+PyMethodDef group_count_method = {"group_count", group_count, METH_O, group_count_doc};
+
+PyDoc_STRVAR(group_sum_doc,
+             "group_sum(values, keys)\n"
+             "\n"
+             "Sum the int or float values which share each int key.\n"
+             "\n"
+             "Returns a pair of jlists: the distinct keys in ascending order, and the\n"
+             "sum of the values for each key. Like sum(), int sums which don't fit\n"
+             "in 64 bits are returned as Python ints.");
+
+PyMethodDef group_sum_method = {"group_sum",
+                                detail::group<detail::group_op::sum>,
+                                METH_VARARGS,
+                                group_sum_doc};
+
+PyDoc_STRVAR(group_min_doc,
+             "group_min(values, keys)\n"
+             "\n"
+             "Find the minimum of the int or float values which share each int key.\n"
+             "\n"
+             "Returns a pair of jlists: the distinct keys in ascending order, and the\n"
+             "minimum value for each key.");
+
+PyMethodDef group_min_method = {"group_min",
+                                detail::group<detail::group_op::min>,
+                                METH_VARARGS,
+                                group_min_doc};
+
+PyDoc_STRVAR(group_max_doc,
+             "group_max(values, keys)\n"
+             "\n"
+             "Find the maximum of the int or float values which share each int key.\n"
+             "\n"
+             "Returns a pair of jlists: the distinct keys in ascending order, and the\n"
+             "maximum value for each key.");
+
+PyMethodDef group_max_method = {"group_max",
+                                detail::group<detail::group_op::max>,
+                                METH_VARARGS,
+                                group_max_doc};
+
+PyDoc_STRVAR(group_mean_doc,
+             "group_mean(values, keys)\n"
+             "\n"
+             "Average the int or float values which share each int key.\n"
+             "\n"
+             "Returns a pair of jlists: the distinct keys in ascending order, and the\n"
+             "mean of the values for each key as a float.");
+
+PyMethodDef group_mean_method = {"group_mean",
+                                 detail::group<detail::group_op::mean>,
+                                 METH_VARARGS,
+                                 group_mean_doc};
+
+namespace detail {
+/** Append the pairs of rows of a join to the output columns.
+ */
+struct join_output {
+    std::vector<entry>& left;
+    std::vector<entry>& right;
+
+    void emplace_back(Py_ssize_t left_ix, Py_ssize_t right_ix) {
+        left.emplace_back().as_int = left_ix;
+        right.emplace_back().as_int = right_ix;
+    }
+};
+
+/** Join two sorted key columns by walking them together.
+ */
+void merge_join(const std::vector<entry>& left,
+                const std::vector<entry>& right,
+                bool left_outer,
+                join_output& out) {
+    std::size_t right_begin = 0;
+    for (std::size_t left_ix = 0; left_ix < left.size(); ++left_ix) {
+        std::int64_t key = left[left_ix].as_int;
+        while (right_begin < right.size() && right[right_begin].as_int < key) {
+            ++right_begin;
+        }
+        std::size_t right_end = right_begin;
+        while (right_end < right.size() && right[right_end].as_int == key) {
+            out.emplace_back(left_ix, right_end);
+            ++right_end;
+        }
+        if (left_outer && right_end == right_begin) {
+            out.emplace_back(left_ix, -1);
+        }
+    }
+}
+
+/** Join two key columns by building a hash table of the right side and probing it
+    with each left key.
+ */
+void hash_join(const std::vector<entry>& left,
+               const std::vector<entry>& right,
+               bool left_outer,
+               join_output& out) {
+    // number the distinct right keys, then lay out the rows of each key contiguously
+    // and in order so that each probe emits its matches from one range
+    int_hash_table table;
+    std::vector<Py_ssize_t> ids(right.size());
+    std::vector<Py_ssize_t> offsets;
+    for (std::size_t ix = 0; ix < right.size(); ++ix) {
+        Py_ssize_t id = table.insert(right[ix].as_int, offsets.size());
+        if (id == static_cast<Py_ssize_t>(offsets.size())) {
+            offsets.emplace_back(0);
+        }
+        ids[ix] = id;
+        ++offsets[id];
+    }
+    Py_ssize_t offset = 0;
+    for (Py_ssize_t& count : offsets) {
+        Py_ssize_t next = offset + count;
+        count = offset;
+        offset = next;
+    }
+    offsets.emplace_back(offset);
+
+    std::vector<Py_ssize_t> rows(right.size());
+    std::vector<Py_ssize_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (std::size_t ix = 0; ix < right.size(); ++ix) {
+        rows[cursors[ids[ix]]++] = ix;
+    }
+
+    for (std::size_t left_ix = 0; left_ix < left.size(); ++left_ix) {
+        Py_ssize_t id = table.find(left[left_ix].as_int);
+        if (id < 0) {
+            if (left_outer) {
+                out.emplace_back(left_ix, -1);
+            }
+            continue;
+        }
+        for (Py_ssize_t ix = offsets[id]; ix < offsets[id + 1]; ++ix) {
+            out.emplace_back(left_ix, rows[ix]);
+        }
+    }
+}
+}  // namespace detail
+
+PyDoc_STRVAR(join_indices_doc,
+             "join_indices(left_keys, right_keys, how='inner')\n"
+             "\n"
+             "Find the pairs of rows where two int key columns are equal.\n"
+             "\n"
+             "Returns a pair of int jlists (left_indices, right_indices) such that\n"
+             "left_keys[left_indices[i]] == right_keys[right_indices[i]]. The pairs are\n"
+             "ordered by left row, then by right row. When how is 'left', left rows\n"
+             "without any match are included once with a right index of -1.\n"
+             "\n"
+             "When both key columns are sorted they are merged, otherwise the right\n"
+             "keys are put in a hash table.");
+
+PyObject* join_indices(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"left_keys", "right_keys", "how", nullptr};
+    PyObject* left_ob;
+    PyObject* right_ob;
+    const char* how = "inner";
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "OO|s:join_indices",
+                                     const_cast<char**>(keywords),
+                                     &left_ob,
+                                     &right_ob,
+                                     &how)) {
+        return nullptr;
+    }
+
+    bool left_outer;
+    if (!std::strcmp(how, "inner")) {
+        left_outer = false;
+    }
+    else if (!std::strcmp(how, "left")) {
+        left_outer = true;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError, "how must be 'inner' or 'left', got '%s'", how);
+        return nullptr;
+    }
+
+    PyObject* left_list_ob = detail::as_jlist(module, left_ob);
+    if (!left_list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_left([&] { Py_DECREF(left_list_ob); });
+    PyObject* right_list_ob = detail::as_jlist(module, right_ob);
+    if (!right_list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_right([&] { Py_DECREF(right_list_ob); });
+
+    jlist& left = *reinterpret_cast<jlist*>(left_list_ob);
+    jlist& right = *reinterpret_cast<jlist*>(right_list_ob);
+    for (jlist* keys : {&left, &right}) {
+        if (keys->tag() != entry_tag::as_int && keys->tag() != entry_tag::unset) {
+            PyErr_SetString(PyExc_TypeError,
+                            "join_indices() requires int jlists of keys");
+            return nullptr;
+        }
+    }
+
+    jlist* left_out = detail::new_jlist(module, entry_tag::as_int);
+    if (!left_out) {
+        return nullptr;
+    }
+    jlist* right_out = detail::new_jlist(module, entry_tag::as_int);
+    if (!right_out) {
+        Py_DECREF(left_out);
+        return nullptr;
+    }
+    left_out->entries.reserve(left.size());
+    right_out->entries.reserve(left.size());
+
+    auto is_sorted = [](const std::vector<entry>& keys) {
+        return std::is_sorted(keys.begin(),
+                              keys.end(),
+                              detail::unboxed_less<std::int64_t>{});
+    };
+
+    detail::join_output out{left_out->entries, right_out->entries};
+    if (is_sorted(left.entries) && is_sorted(right.entries)) {
+        detail::merge_join(left.entries, right.entries, left_outer, out);
+    }
+    else {
+        detail::hash_join(left.entries, right.entries, left_outer, out);
+    }
+
+    PyObject* result = PyTuple_Pack(2, left_out, right_out);
+    Py_DECREF(left_out);
+    Py_DECREF(right_out);
+    return result;
+}
+
+PyMethodDef join_indices_method = {"join_indices",
+                                   unsafe_cast_to_pycfunction(join_indices),
+                                   METH_VARARGS | METH_KEYWORDS,
+                                   join_indices_doc};
+
+PyDoc_STRVAR(unzip_doc,
+             "unzip(rows, n)\n"
+             "\n"
+             "Transpose an iterable of rows with n fields each into a tuple of n\n"
+             "jlists, one for each field.\n"
+             "\n"
+             "Equivalent to:  tuple(map(jlist, zip(*rows))) or n empty jlists");
+
+PyObject* unzip(PyObject* module, PyObject* args) {
+    PyObject* rows;
+    PyObject* n_ob;
+
+    if (!PyArg_UnpackTuple(args, "unzip", 2, 2, &rows, &n_ob)) {
+        return nullptr;
+    }
+
+    Py_ssize_t n = PyNumber_AsSsize_t(n_ob, PyExc_OverflowError);
+    if (n == -1 && PyErr_Occurred()) {
+        return nullptr;
+    }
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "n must be non-negative");
+        return nullptr;
+    }
+
+    PyObject* columns = PyTuple_New(n);
+    if (!columns) {
+        return nullptr;
+    }
+    for (Py_ssize_t ix = 0; ix < n; ++ix) {
+        jlist* column = detail::new_jlist(module, entry_tag::unset);
+        if (!column) {
+            Py_DECREF(columns);
+            return nullptr;
+        }
+        PyTuple_SET_ITEM(columns, ix, reinterpret_cast<PyObject*>(column));
+    }
+
+    PyObject* it = PyObject_GetIter(rows);
+    if (!it) {
+        Py_DECREF(columns);
+        return nullptr;
+    }
+    scope_guard decref_it([&] { Py_DECREF(it); });
+
+    Py_ssize_t size_hint = PyObject_LengthHint(rows, 0);
+    if (size_hint < 0) {
+        Py_DECREF(columns);
+        return nullptr;
+    }
+    for (Py_ssize_t ix = 0; ix < n; ++ix) {
+        jlist& column = *reinterpret_cast<jlist*>(PyTuple_GET_ITEM(columns, ix));
+        column.entries.reserve(size_hint);
+    }
+
+    PyObject* row;
+    while ((row = PyIter_Next(it))) {
+        PyObject* fast = PySequence_Fast(row, "unzip() rows must be sequences");
+        Py_DECREF(row);
+        if (!fast) {
+            Py_DECREF(columns);
+            return nullptr;
+        }
+        scope_guard decref_fast([&] { Py_DECREF(fast); });
+
+        if (PySequence_Fast_GET_SIZE(fast) != n) {
+            PyErr_Format(PyExc_ValueError,
+                         "unzip() expected rows of length %zd, got %zd",
+                         n,
+                         PySequence_Fast_GET_SIZE(fast));
+            Py_DECREF(columns);
+            return nullptr;
+        }
+        PyObject** items = PySequence_Fast_ITEMS(fast);
+        for (Py_ssize_t ix = 0; ix < n; ++ix) {
+            if (detail::append_value(PyTuple_GET_ITEM(columns, ix), items[ix])) {
+                Py_DECREF(columns);
+                return nullptr;
+            }
+        }
+    }
+    if (PyErr_Occurred()) {
+        Py_DECREF(columns);
+        return nullptr;
+    }
+    return columns;
+}
+
+PyMethodDef unzip_method = {"unzip", unzip, METH_VARARGS, unzip_doc};
+
+namespace detail {
+/** Evaluate each value of `mask` as a bool. Returns true with an exception raised on
+    failure.
+ */
+bool mask_values(jlist& mask, std::vector<bool>& out) {
+    out.resize(mask.size());
+    switch (mask.tag()) {
+    case entry_tag::unset:
+        return false;
+    case entry_tag::as_int:
+        for (Py_ssize_t ix = 0; ix < mask.size(); ++ix) {
+            out[ix] = mask.entries[ix].as_int;
+        }
+        return false;
+    case entry_tag::as_double:
+        for (Py_ssize_t ix = 0; ix < mask.size(); ++ix) {
+            out[ix] = mask.entries[ix].as_double;
+        }
+        return false;
+    case entry_tag::as_homogeneous_ob:
+        if (mask.homogeneous_type_ptr() == &PyBool_Type) {
+            for (Py_ssize_t ix = 0; ix < mask.size(); ++ix) {
+                out[ix] = mask.entries[ix].as_ob == Py_True;
+            }
+            return false;
+        }
+        [[fallthrough]];
+    case entry_tag::as_heterogeneous_ob: {
+        // `__bool__` can change the mask, so hold each value while it runs and check
+        // that the entries are still the ones we sized `out` for
+        Py_ssize_t size = mask.size();
+        entry_tag tag = mask.tag();
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            PyObject* value = mask.entries[ix].as_ob;
+            Py_INCREF(value);
+            int r = PyObject_IsTrue(value);
+            Py_DECREF(value);
+            if (r < 0) {
+                return true;
+            }
+            if (mask.size() != size || mask.tag() != tag) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "jlist changed while testing the mask");
+                return true;
+            }
+            out[ix] = r;
+        }
+        return false;
+    }
+    default:
+        __builtin_unreachable();
+    }
+}
+}  // namespace detail
+
+PyDoc_STRVAR(filter_mask_doc,
+             "filter_mask(iterable, mask)\n"
+             "\n"
+             "Return a jlist of the values whose corresponding value in mask is true.\n"
+             "\n"
+             "Equivalent to:  jlist(itertools.compress(iterable, mask))\n"
+             "\n"
+             "Unlike itertools.compress, iterable and mask must be the same length.");
+
+PyObject* filter_mask(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* mask_ob;
+
+    if (!PyArg_UnpackTuple(args, "filter_mask", 2, 2, &iterable, &mask_ob)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    PyObject* mask_list_ob = detail::as_jlist(module, mask_ob);
+    if (!mask_list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_mask([&] { Py_DECREF(mask_list_ob); });
+    jlist& mask = *reinterpret_cast<jlist*>(mask_list_ob);
+
+    if (mask.size() != self.size()) {
+        PyErr_Format(PyExc_ValueError,
+                     "filter_mask() mask must be the same length as the iterable, got "
+                     "%zd and %zd",
+                     mask.size(),
+                     self.size());
+        return nullptr;
+    }
+
+    std::vector<bool> keep;
+    if (detail::mask_values(mask, keep)) {
+        return nullptr;
+    }
+    if (self.size() != static_cast<Py_ssize_t>(keep.size())) {
+        PyErr_SetString(PyExc_RuntimeError, "jlist changed while testing the mask");
+        return nullptr;
+    }
+
+    jlist* out = detail::new_jlist(module, self.tag());
+    if (!out) {
+        return nullptr;
+    }
+    if (self.tag() == entry_tag::as_homogeneous_ob) {
+        out->homogeneous_type_ptr(self.homogeneous_type_ptr());
+    }
+    out->entries.reserve(std::count(keep.begin(), keep.end(), true));
+    for (Py_ssize_t ix = 0; ix < self.size(); ++ix) {
+        if (keep[ix]) {
+            entry e = out->entries.emplace_back(self.entries[ix]);
+            if (self.boxed()) {
+                Py_INCREF(e.as_ob);
+            }
+        }
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef filter_mask_method = {"filter_mask",
+                                  filter_mask,
+                                  METH_VARARGS,
+                                  filter_mask_doc};
+
+namespace detail {
+/** Factorize an int jlist with a hash table on the unboxed values.
+ */
+void factorize_ints(const std::vector<entry>& values,
+                    std::vector<entry>& codes,
+                    std::vector<entry>& uniques) {
+    int_hash_table table;
+    codes.resize(values.size());
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        Py_ssize_t code = table.insert(values[ix].as_int, uniques.size());
+        if (code == static_cast<Py_ssize_t>(uniques.size())) {
+            uniques.emplace_back(values[ix]);
+        }
+        codes[ix].as_int = code;
+    }
+}
+
+/** Factorize a jlist of any tag through a dict from value to code. Returns true with
+    an exception raised on failure.
+ */
+bool factorize_objects(PyObject* list_ob, std::vector<entry>& codes, PyObject* uniques) {
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    PyObject* table = PyDict_New();
+    if (!table) {
+        return true;
+    }
+    scope_guard decref_table([&] { Py_DECREF(table); });
+
+    Py_ssize_t size = self.size();
+    codes.resize(size);
+    // hold a reference to the last object so its address can't be reused
+    PyObject* previous = nullptr;
+    Py_ssize_t previous_code = -1;
+    scope_guard decref_previous([&] { Py_XDECREF(previous); });
+    for (Py_ssize_t ix = 0; ix < size; ++ix) {
+        if (self.size() != size) {
+            // hashing or comparing a value resized the list
+            PyErr_SetString(PyExc_RuntimeError, "jlist changed size during iteration");
+            return true;
+        }
+        // Low cardinality columns tend to have runs of the same object, so check the
+        // last value by identity before hashing.
+        if (self.boxed() && self.entries[ix].as_ob == previous) {
+            codes[ix].as_int = previous_code;
+            continue;
+        }
+
+        PyObject* value = box_entry(self, self.entries[ix]);
+        if (!value) {
+            return true;
+        }
+        scope_guard decref_value([&] { Py_DECREF(value); });
+
+        PyObject* code_ob = PyDict_GetItemWithError(table, value);
+        Py_ssize_t code;
+        if (code_ob) {
+            code = PyLong_AsSsize_t(code_ob);
+        }
+        else {
+            if (PyErr_Occurred()) {
+                return true;
+            }
+            code = PyDict_GET_SIZE(table);
+            code_ob = PyLong_FromSsize_t(code);
+            if (!code_ob) {
+                return true;
+            }
+            int err = PyDict_SetItem(table, value, code_ob);
+            Py_DECREF(code_ob);
+            if (err || append_value(uniques, value)) {
+                return true;
+            }
+        }
+
+        codes[ix].as_int = code;
+        if (self.boxed()) {
+            Py_INCREF(value);
+            Py_XSETREF(previous, value);
+            previous_code = code;
+        }
+    }
+    return false;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(factorize_doc,
+             "factorize(iterable)\n"
+             "\n"
+             "Encode the values of the iterable as integer codes.\n"
+             "\n"
+             "Returns a pair of jlists (codes, uniques) where uniques holds each\n"
+             "distinct value in order of first appearance and\n"
+             "uniques[codes[i]] == iterable[i]. Values are compared like dict keys, so\n"
+             "they must be hashable.");
+
+PyObject* factorize(PyObject* module, PyObject* iterable) {
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    jlist* codes = detail::new_jlist(module, entry_tag::as_int);
+    if (!codes) {
+        return nullptr;
+    }
+    jlist* uniques = detail::new_jlist(module, entry_tag::unset);
+    if (!uniques) {
+        Py_DECREF(codes);
+        return nullptr;
+    }
+
+    bool err = false;
+    if (self.tag() == entry_tag::as_int) {
+        uniques->tag(entry_tag::as_int);
+        detail::factorize_ints(self.entries, codes->entries, uniques->entries);
+    }
+    else {
+        err = detail::factorize_objects(list_ob,
+                                        codes->entries,
+                                        reinterpret_cast<PyObject*>(uniques));
+    }
+
+    PyObject* result = nullptr;
+    if (!err) {
+        result = PyTuple_Pack(2, codes, uniques);
+    }
+    Py_DECREF(codes);
+    Py_DECREF(uniques);
+    return result;
+}
+
+PyMethodDef factorize_method = {"factorize", factorize, METH_O, factorize_doc};
+
+namespace detail {
+/** Append values of up to 64 bits to a byte string, least significant bit first.
+ */
+class bit_writer {
+private:
+    std::string& m_out;
+    std::uint64_t m_acc = 0;
+    int m_bits = 0;
+
+    void flush(std::uint64_t word, int bytes) {
+        char buffer[sizeof(word)];
+        std::memcpy(buffer, &word, sizeof(word));
+        m_out.append(buffer, bytes);
+    }
+
+public:
+    explicit bit_writer(std::string& out) : m_out(out) {}
+
+    void write(std::uint64_t value, int bits) {
+        if (!bits) {
+            return;
+        }
+        if (bits < 64) {
+            value &= (std::uint64_t{1} << bits) - 1;
+        }
+        m_acc |= value << m_bits;
+        if (m_bits + bits < 64) {
+            m_bits += bits;
+            return;
+        }
+        flush(m_acc, sizeof(m_acc));
+        m_acc = (m_bits) ? value >> (64 - m_bits) : 0;
+        m_bits = m_bits + bits - 64;
+    }
+
+    void finish() {
+        flush(m_acc, (m_bits + 7) / 8);
+        m_acc = 0;
+        m_bits = 0;
+    }
+};
+
+/** Read values written by a `bit_writer`. Reading past the end sets `overrun` and
+    returns zeros.
+ */
+class bit_reader {
+private:
+    const unsigned char* m_data;
+    const unsigned char* m_end;
+    std::uint64_t m_acc = 0;
+    int m_available = 0;
+
+public:
+    bool overrun = false;
+
+    bit_reader(const unsigned char* data, const unsigned char* end)
+        : m_data(data), m_end(end) {}
+
+    std::uint64_t read(int bits) {
+        std::uint64_t out = 0;
+        int got = 0;
+        while (got < bits) {
+            if (!m_available) {
+                std::size_t bytes = std::min<std::size_t>(m_end - m_data, sizeof(m_acc));
+                if (!bytes) {
+                    overrun = true;
+                    return 0;
+                }
+                m_acc = 0;
+                std::memcpy(&m_acc, m_data, bytes);
+                m_data += bytes;
+                m_available = bytes * 8;
+            }
+            int take = std::min(bits - got, m_available);
+            std::uint64_t mask = (take == 64) ? ~std::uint64_t{0}
+                                              : (std::uint64_t{1} << take) - 1;
+            out |= (m_acc & mask) << got;
+            m_acc = (take == 64) ? 0 : m_acc >> take;
+            m_available -= take;
+            got += take;
+        }
+        return out;
+    }
+};
+
+template<typename T>
+void append_raw(std::string& out, T value) {
+    char buffer[sizeof(value)];
+    std::memcpy(buffer, &value, sizeof(value));
+    out.append(buffer, sizeof(value));
+}
+
+template<typename T>
+bool read_raw(const unsigned char*& data, const unsigned char* end, T& value) {
+    if (static_cast<std::size_t>(end - data) < sizeof(value)) {
+        return true;
+    }
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return false;
+}
+
+int bit_width(std::uint64_t value) {
+    return (value) ? 64 - __builtin_clzll(value) : 0;
+}
+
+/** `b - a` with wrapping instead of overflow.
+ */
+std::uint64_t wrapping_delta(std::int64_t a, std::int64_t b) {
+    return static_cast<std::uint64_t>(b) - static_cast<std::uint64_t>(a);
+}
+
+/** Encode a block of ints as the first value followed by the deltas between
+    neighbours, frame-of-reference packed: each delta is stored as its offset from
+    the smallest delta in the block using just enough bits for the largest offset.
+
+    All of the arithmetic wraps, so any int64 values round trip exactly.
+ */
+void encode_int_block(const entry* begin, const entry* end, std::string& out) {
+    std::size_t size = end - begin;
+    append_raw<std::uint32_t>(out, size);
+    append_raw<std::int64_t>(out, begin->as_int);
+
+    std::int64_t min_delta = 0;
+    std::int64_t max_delta = 0;
+    for (std::size_t ix = 1; ix < size; ++ix) {
+        auto delta = static_cast<std::int64_t>(
+            wrapping_delta(begin[ix - 1].as_int, begin[ix].as_int));
+        if (ix == 1 || delta < min_delta) {
+            min_delta = delta;
+        }
+        if (ix == 1 || delta > max_delta) {
+            max_delta = delta;
+        }
+    }
+    int width = bit_width(wrapping_delta(min_delta, max_delta));
+    append_raw<std::int64_t>(out, min_delta);
+    append_raw<std::uint8_t>(out, width);
+
+    bit_writer writer(out);
+    for (std::size_t ix = 1; ix < size; ++ix) {
+        std::uint64_t delta = wrapping_delta(begin[ix - 1].as_int, begin[ix].as_int);
+        writer.write(delta - static_cast<std::uint64_t>(min_delta), width);
+    }
+    writer.finish();
+}
+
+bool decode_int_block(const unsigned char* data,
+                      const unsigned char* end,
+                      std::vector<entry>& out) {
+    std::uint32_t size;
+    std::int64_t first;
+    std::int64_t min_delta;
+    std::uint8_t width;
+    if (read_raw(data, end, size) || !size || read_raw(data, end, first) ||
+        read_raw(data, end, min_delta) || read_raw(data, end, width) || width > 64) {
+        return true;
+    }
+
+    bit_reader reader(data, end);
+    std::uint64_t value = first;
+    out.emplace_back().as_int = first;
+    for (std::uint32_t ix = 1; ix < size; ++ix) {
+        value += reader.read(width) + static_cast<std::uint64_t>(min_delta);
+        out.emplace_back().as_int = static_cast<std::int64_t>(value);
+    }
+    return reader.overrun;
+}
+
+/** Encode a block of floats as the first value followed by the XOR of each value with
+    the one before it, as in Facebook's Gorilla. Repeated values cost one bit, and
+    values which share their sign, exponent, and high mantissa bits with their
+    neighbour only store the bits that changed.
+
+    Each XOR is written as:
+
+    - `0` if it is zero.
+    - `10` and the meaningful bits, if they fit in the previous leading and trailing
+      zero window.
+    - `11`, 6 bits of leading zeros, 6 bits of the meaningful bit count minus one, and
+      the meaningful bits otherwise.
+ */
+void encode_double_block(const entry* begin, const entry* end, std::string& out) {
+    std::size_t size = end - begin;
+    append_raw<std::uint32_t>(out, size);
+    append_raw<double>(out, begin->as_double);
+
+    bit_writer writer(out);
+    std::uint64_t previous;
+    std::memcpy(&previous, &begin->as_double, sizeof(previous));
+    int window_leading = -1;
+    int window_trailing = 0;
+    for (std::size_t ix = 1; ix < size; ++ix) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &begin[ix].as_double, sizeof(bits));
+        std::uint64_t x = bits ^ previous;
+        previous = bits;
+
+        if (!x) {
+            writer.write(0, 1);
+            continue;
+        }
+
+        int leading = __builtin_clzll(x);
+        int trailing = __builtin_ctzll(x);
+        if (window_leading >= 0 && leading >= window_leading &&
+            trailing >= window_trailing) {
+            writer.write(0b01, 2);
+            writer.write(x >> window_trailing, 64 - window_leading - window_trailing);
+            continue;
+        }
+
+        int meaningful = 64 - leading - trailing;
+        writer.write(0b11, 2);
+        writer.write(leading, 6);
+        writer.write(meaningful - 1, 6);
+        writer.write(x >> trailing, meaningful);
+        window_leading = leading;
+        window_trailing = trailing;
+    }
+    writer.finish();
+}
+
+bool decode_double_block(const unsigned char* data,
+                         const unsigned char* end,
+                         std::vector<entry>& out) {
+    std::uint32_t size;
+    std::uint64_t previous;
+    if (read_raw(data, end, size) || !size || read_raw(data, end, previous)) {
+        return true;
+    }
+
+    bit_reader reader(data, end);
+    int window_leading = -1;
+    int window_trailing = 0;
+    std::memcpy(&out.emplace_back().as_double, &previous, sizeof(previous));
+    for (std::uint32_t ix = 1; ix < size; ++ix) {
+        if (reader.read(1)) {
+            if (reader.read(1)) {
+                window_leading = reader.read(6);
+                int meaningful = reader.read(6) + 1;
+                window_trailing = 64 - window_leading - meaningful;
+                if (window_trailing < 0) {
+                    return true;
+                }
+            }
+            else if (window_leading < 0) {
+                return true;
+            }
+            int meaningful = 64 - window_leading - window_trailing;
+            previous ^= reader.read(meaningful) << window_trailing;
+        }
+        std::memcpy(&out.emplace_back().as_double, &previous, sizeof(previous));
+        if (reader.overrun) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(encode_blocks_doc,
+             "_encode_blocks(iterable, block_size)\n"
+             "\n"
+             "Compress int or float values into independent blocks of block_size\n"
+             "values each.\n"
+             "\n"
+             "Returns a pair of the tag of the values and a tuple of bytes objects, one\n"
+             "for each block. This is the kernel behind jlist.compress.");
+
+PyObject* encode_blocks(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    Py_ssize_t block_size;
+
+    if (!PyArg_ParseTuple(args, "On:_encode_blocks", &iterable, &block_size)) {
+        return nullptr;
+    }
+    if (block_size < 1 || block_size > std::numeric_limits<std::uint32_t>::max()) {
+        PyErr_SetString(PyExc_ValueError, "block_size must be in [1, 2 ** 32)");
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    const char* tag;
+    void (*encode)(const entry*, const entry*, std::string&);
+    switch (self.tag()) {
+    case entry_tag::as_int:
+    case entry_tag::unset:
+        tag = "int";
+        encode = detail::encode_int_block;
+        break;
+    case entry_tag::as_double:
+        tag = "double";
+        encode = detail::encode_double_block;
+        break;
+    default:
+        PyErr_SetString(PyExc_TypeError, "compress() requires an int or float jlist");
+        return nullptr;
+    }
+
+    Py_ssize_t n_blocks = (self.size() + block_size - 1) / block_size;
+    PyObject* blocks = PyTuple_New(n_blocks);
+    if (!blocks) {
+        return nullptr;
+    }
+    std::string buffer;
+    for (Py_ssize_t ix = 0; ix < n_blocks; ++ix) {
+        const entry* begin = self.entries.data() + ix * block_size;
+        const entry* end = self.entries.data() +
+                           std::min(self.size(), (ix + 1) * block_size);
+        buffer.clear();
+        encode(begin, end, buffer);
+        PyObject* block = PyBytes_FromStringAndSize(buffer.data(), buffer.size());
+        if (!block) {
+            Py_DECREF(blocks);
+            return nullptr;
+        }
+        PyTuple_SET_ITEM(blocks, ix, block);
+    }
+
+    return Py_BuildValue("(sN)", tag, blocks);
+}
+
+PyMethodDef encode_blocks_method = {"_encode_blocks",
+                                    encode_blocks,
+                                    METH_VARARGS,
+                                    encode_blocks_doc};
+
+PyDoc_STRVAR(decode_blocks_doc,
+             "_decode_blocks(tag, blocks)\n"
+             "\n"
+             "Decompress a sequence of blocks produced by _encode_blocks into a single\n"
+             "jlist.");
+
+PyObject* decode_blocks(PyObject* module, PyObject* args) {
+    const char* tag;
+    PyObject* blocks_ob;
+
+    if (!PyArg_ParseTuple(args, "sO:_decode_blocks", &tag, &blocks_ob)) {
+        return nullptr;
+    }
+
+    entry_tag out_tag;
+    bool (*decode)(const unsigned char*, const unsigned char*, std::vector<entry>&);
+    if (!std::strcmp(tag, "int")) {
+        out_tag = entry_tag::as_int;
+        decode = detail::decode_int_block;
+    }
+    else if (!std::strcmp(tag, "double")) {
+        out_tag = entry_tag::as_double;
+        decode = detail::decode_double_block;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError, "tag must be 'int' or 'double', got '%s'", tag);
+        return nullptr;
+    }
+
+    PyObject* blocks = PySequence_Fast(blocks_ob, "blocks must be a sequence");
+    if (!blocks) {
+        return nullptr;
+    }
+    scope_guard decref_blocks([&] { Py_DECREF(blocks); });
+
+    jlist* out = detail::new_jlist(module, out_tag);
+    if (!out) {
+        return nullptr;
+    }
+    for (Py_ssize_t ix = 0; ix < PySequence_Fast_GET_SIZE(blocks); ++ix) {
+        PyObject* block = PySequence_Fast_GET_ITEM(blocks, ix);
+        if (!PyBytes_Check(block)) {
+            Py_DECREF(out);
+            PyErr_SetString(PyExc_TypeError, "blocks must be bytes");
+            return nullptr;
+        }
+        auto data = reinterpret_cast<const unsigned char*>(PyBytes_AS_STRING(block));
+        if (decode(data, data + PyBytes_GET_SIZE(block), out->entries)) {
+            Py_DECREF(out);
+            PyErr_SetString(PyExc_ValueError, "corrupt compressed block");
+            return nullptr;
+        }
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef decode_blocks_method = {"_decode_blocks",
+                                    decode_blocks,
+                                    METH_VARARGS,
+                                    decode_blocks_doc};
+
+PyDoc_STRVAR(freeze_doc,
+             "freeze(iterable)\n"
+             "\n"
+             "Return an immutable, hashable copy of the iterable as a frozenjlist.\n"
+             "\n"
+             "A frozenjlist is returned as is. The hash of a frozenjlist matches the\n"
+             "hash of a tuple of the same values and is computed from the unboxed\n"
+             "entries the first time it is needed.\n"
+             "\n"
+             "Equivalent to: frozenjlist(iterable)");
+
+PyObject* freeze(PyObject* module, PyObject* iterable) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    if (Py_TYPE(iterable) == state->frozen_jlist_type) {
+        Py_INCREF(iterable);
+        return iterable;
+    }
+    return PyObject_CallFunctionObjArgs(
+        reinterpret_cast<PyObject*>(state->frozen_jlist_type), iterable, nullptr);
+}
+
+PyMethodDef freeze_method = {"freeze", freeze, METH_O, freeze_doc};
+
+namespace detail {
+/** A 128 bit digest: `low` is the 64 bit fingerprint and `high` extends it to 128
+    bits.
+ */
+struct digest {
+    std::uint64_t low;
+    std::uint64_t high;
+};
+
+constexpr std::uint64_t fingerprint_prime_1 = 0x9e3779b185ebca87;
+constexpr std::uint64_t fingerprint_prime_2 = 0xc2b2ae3d27d4eb4f;
+constexpr std::uint64_t fingerprint_prime_3 = 0x165667b19e3779f9;
+constexpr std::uint64_t fingerprint_prime32 = 0x9e3779b1;
+
+constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+    return mix64(state += 0x9e3779b97f4a7c15);
+}
+
+constexpr std::array<std::uint64_t, 16> make_fingerprint_secret() {
+    std::array<std::uint64_t, 16> out{};
+    std::uint64_t state = 0x6a09e667f3bcc908;
+    for (std::uint64_t& word : out) {
+        word = splitmix64(state);
+    }
+    return out;
+}
+
+// The fixed keys mixed into the input; the seed is added to these.
+constexpr std::array<std::uint64_t, 16> fingerprint_secret = make_fingerprint_secret();
+
+inline std::uint64_t load_u64(const char* data) {
+    std::uint64_t out;
+    std::memcpy(&out, data, sizeof(out));
+    return out;
+}
+
+/** Multiply to 128 bits and fold the halves together.
+ */
+inline std::uint64_t fold_multiply(std::uint64_t a, std::uint64_t b) {
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    std::uint64_t high = product >> 64;
+    return static_cast<std::uint64_t>(product) ^ high;
+}
+
+inline std::uint64_t avalanche(std::uint64_t h) {
+    h ^= h >> 37;
+    h *= fingerprint_prime_3;
+    return h ^ (h >> 32);
+}
+
+/** Hash a buffer the way XXH3 does: 64 byte stripes are accumulated into 8
+    independent lanes with 32 x 32 -> 64 bit multiplies, which the compiler turns into
+    SIMD, and the lanes are folded into two 64 bit halves at the end. Inputs of up to
+    16 bytes skip the lanes.
+
+    The result depends only on the bytes, the size, and the seed, so it is stable
+    across processes, unlike `hash`.
+ */
+digest fingerprint_bytes(const char* data, std::size_t size, std::uint64_t seed) {
+    const std::array<std::uint64_t, 16>& secret = fingerprint_secret;
+
+    if (size <= 16) {
+        // read the input with two possibly overlapping loads instead of a variable
+        // sized copy; the size is mixed in below so overlaps don't collide
+        std::uint64_t a = 0;
+        std::uint64_t b = 0;
+        if (size >= 8) {
+            a = load_u64(data);
+            b = load_u64(data + size - 8);
+        }
+        else if (size >= 4) {
+            std::uint32_t first;
+            std::uint32_t last;
+            std::memcpy(&first, data, sizeof(first));
+            std::memcpy(&last, data + size - 4, sizeof(last));
+            a = first;
+            b = last;
+        }
+        else if (size) {
+            a = static_cast<std::uint8_t>(data[0]) |
+                static_cast<std::uint8_t>(data[size / 2]) << 8 |
+                static_cast<std::uint8_t>(data[size - 1]) << 16;
+        }
+        a ^= secret[0] + seed;
+        b ^= secret[1] - seed;
+        std::uint64_t length_mix = size * fingerprint_prime_1;
+        std::uint64_t low = fold_multiply(a, b) + length_mix;
+        std::uint64_t high = fold_multiply(a ^ secret[2], b ^ secret[3]) + length_mix;
+        return {avalanche(low), avalanche(high + seed)};
+    }
+
+    std::array<std::uint64_t, 8> keys;
+    for (std::size_t ix = 0; ix < keys.size(); ++ix) {
+        keys[ix] = secret[ix] + seed;
+    }
+    std::array<std::uint64_t, 8> acc = {fingerprint_prime32,
+                                        fingerprint_prime_1,
+                                        fingerprint_prime_2,
+                                        fingerprint_prime_3,
+                                        ~fingerprint_prime_1,
+                                        ~fingerprint_prime_2,
+                                        ~fingerprint_prime_3,
+                                        ~fingerprint_prime32};
+
+    auto accumulate = [&](const char* stripe) {
+        for (std::size_t ix = 0; ix < acc.size(); ++ix) {
+            std::uint64_t value = load_u64(stripe + 8 * ix);
+            std::uint64_t keyed = value ^ keys[ix];
+            acc[ix ^ 1] += value;
+            acc[ix] += (keyed & 0xffffffff) * (keyed >> 32);
+        }
+    };
+    auto scramble = [&] {
+        for (std::size_t ix = 0; ix < acc.size(); ++ix) {
+            acc[ix] ^= acc[ix] >> 47;
+            acc[ix] ^= secret[8 + ix];
+            acc[ix] *= fingerprint_prime32;
+        }
+    };
+
+    // every stripe but the last, which may be partial
+    std::size_t stripes = (size - 1) / 64;
+    for (std::size_t ix = 0; ix < stripes; ++ix) {
+        accumulate(data + 64 * ix);
+        if (ix % 16 == 15) {
+            scramble();
+        }
+    }
+
+    // the last stripe is the final 64 bytes, overlapping the previous stripe, or the
+    // zero padded input when it is shorter than a stripe
+    char last[64] = {};
+    if (size >= sizeof(last)) {
+        std::memcpy(last, data + size - sizeof(last), sizeof(last));
+    }
+    else {
+        std::memcpy(last, data, size);
+    }
+    accumulate(last);
+
+    std::uint64_t low = size * fingerprint_prime_1;
+    std::uint64_t high = ~size * fingerprint_prime_2;
+    for (std::size_t ix = 0; ix < acc.size(); ix += 2) {
+        low += fold_multiply(acc[ix] ^ secret[ix + 1], acc[ix + 1] ^ secret[ix + 2]);
+        high += fold_multiply(acc[ix] ^ secret[15 - ix], acc[ix + 1] ^ secret[14 - ix]);
+    }
+    return {avalanche(low), avalanche(high)};
+}
+
+/** Separate the fingerprints of different kinds of input, like an int and a double
+    with the same bits.
+ */
+enum class fingerprint_domain : std::uint64_t {
+    empty = 0,
+    as_int = 1,
+    as_double = 2,
+    objects = 3,
+    bytes = 4,
+    // str adds its kind: 1, 2, or 4 bytes per character
+    str = 5,
+    // boxed ints and floats in a list of objects
+    object_int = 10,
+    object_double = 11,
+};
+
+inline std::uint64_t domain_seed(std::uint64_t seed, std::uint64_t domain) {
+    return seed ^ (domain * fingerprint_prime_2);
+}
+
+inline std::uint64_t domain_seed(std::uint64_t seed, fingerprint_domain domain) {
+    return domain_seed(seed, static_cast<std::uint64_t>(domain));
+}
+
+/** Fingerprint a list of objects by hashing each payload and then hashing the 128 bit
+    digests. Ints are hashed from their shortest signed little-endian bytes, so ints
+    of any size can be mixed with the other values. Returns true with an exception
+    raised if any value is not an int, float, str, or bytes.
+ */
+bool fingerprint_objects(const jlist& self, std::uint64_t seed, digest& out) {
+    std::vector<std::uint64_t> digests;
+    digests.reserve(2 * self.entries.size());
+    std::vector<unsigned char> int_bytes;
+    for (entry e : self.entries) {
+        PyObject* ob = e.as_ob;
+        const char* data;
+        std::size_t size;
+        std::uint64_t domain;
+        if (PyUnicode_CheckExact(ob)) {
+            if (PyUnicode_READY(ob) < 0) {
+                return true;
+            }
+            data = static_cast<const char*>(PyUnicode_DATA(ob));
+            size = PyUnicode_GET_LENGTH(ob) * PyUnicode_KIND(ob);
+            domain = static_cast<std::uint64_t>(fingerprint_domain::str) +
+                     PyUnicode_KIND(ob);
+        }
+        else if (PyBytes_CheckExact(ob)) {
+            data = PyBytes_AS_STRING(ob);
+            size = PyBytes_GET_SIZE(ob);
+            domain = static_cast<std::uint64_t>(fingerprint_domain::bytes);
+        }
+        else if (PyLong_CheckExact(ob)) {
+            std::size_t bits = _PyLong_NumBits(ob);
+            if (bits == static_cast<std::size_t>(-1) && PyErr_Occurred()) {
+                return true;
+            }
+            // one more bit for the sign
+            int_bytes.resize(bits / 8 + 1);
+            if (_PyLong_AsByteArray(reinterpret_cast<PyLongObject*>(ob),
+                                    int_bytes.data(),
+                                    int_bytes.size(),
+                                    /* little_endian */ 1,
+                                    /* is_signed */ 1) < 0) {
+                return true;
+            }
+            data = reinterpret_cast<const char*>(int_bytes.data());
+            size = int_bytes.size();
+            domain = static_cast<std::uint64_t>(fingerprint_domain::object_int);
+        }
+        else if (PyFloat_CheckExact(ob)) {
+            data = reinterpret_cast<const char*>(&PyFloat_AS_DOUBLE(ob));
+            size = sizeof(double);
+            domain = static_cast<std::uint64_t>(fingerprint_domain::object_double);
+        }
+        else {
+            PyErr_Format(PyExc_TypeError,
+                         "fingerprint() requires int, float, str, or bytes values, "
+                         "got %.200s",
+                         Py_TYPE(ob)->tp_name);
+            return true;
+        }
+
+        digest element = fingerprint_bytes(data, size, domain_seed(seed, domain));
+        digests.push_back(element.low);
+        digests.push_back(element.high);
+    }
+
+    out = fingerprint_bytes(reinterpret_cast<const char*>(digests.data()),
+                            digests.size() * sizeof(std::uint64_t),
+                            domain_seed(seed, fingerprint_domain::objects));
+    return false;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(fingerprint_doc,
+             "fingerprint(iterable, bits=64, seed=0)\n"
+             "\n"
+             "Compute a 64 or 128 bit non-cryptographic hash of the contents of the\n"
+             "iterable, for caching and change detection.\n"
+             "\n"
+             "Unboxed int and float values are hashed from their raw 64 bit\n"
+             "representation, and str and bytes values from their payloads. Ints\n"
+             "which don't fit in 64 bits, or which are mixed with other types, are\n"
+             "hashed from their bytes. Unlike hash, the result is the same in every\n"
+             "process. Lists which compare equal but have different tags, like [1]\n"
+             "and [1.0], have different fingerprints.");
+
+PyObject* fingerprint(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"iterable", "bits", "seed", nullptr};
+    PyObject* iterable;
+    Py_ssize_t bits = 64;
+    unsigned long long seed = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|nK:fingerprint",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &bits,
+                                     &seed)) {
+        return nullptr;
+    }
+    if (bits != 64 && bits != 128) {
+        PyErr_SetString(PyExc_ValueError, "bits must be 64 or 128");
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    const char* data = reinterpret_cast<const char*>(self.entries.data());
+    std::size_t size = self.entries.size() * sizeof(entry);
+    detail::digest out;
+    if (!self.size()) {
+        // an emptied list keeps its tag, but should match a new empty list
+        out = detail::fingerprint_bytes(
+            nullptr, 0, detail::domain_seed(seed, detail::fingerprint_domain::empty));
+    }
+    else if (self.tag() == entry_tag::as_int) {
+        out = detail::fingerprint_bytes(
+            data, size, detail::domain_seed(seed, detail::fingerprint_domain::as_int));
+    }
+    else if (self.tag() == entry_tag::as_double) {
+        out = detail::fingerprint_bytes(
+            data, size, detail::domain_seed(seed, detail::fingerprint_domain::as_double));
+    }
+    else if (detail::fingerprint_objects(self, seed, out)) {
+        return nullptr;
+    }
+
+    if (bits == 64) {
+        return PyLong_FromUnsignedLongLong(out.low);
+    }
+
+    PyObject* high = PyLong_FromUnsignedLongLong(out.high);
+    if (!high) {
+        return nullptr;
+    }
+    scope_guard decref_high([&] { Py_DECREF(high); });
+    PyObject* shift = PyLong_FromLong(64);
+    if (!shift) {
+        return nullptr;
+    }
+    PyObject* shifted = PyNumber_Lshift(high, shift);
+    Py_DECREF(shift);
+    if (!shifted) {
+        return nullptr;
+    }
+    scope_guard decref_shifted([&] { Py_DECREF(shifted); });
+    PyObject* low = PyLong_FromUnsignedLongLong(out.low);
+    if (!low) {
+        return nullptr;
+    }
+    PyObject* result = PyNumber_Or(shifted, low);
+    Py_DECREF(low);
+    return result;
+}
+
+PyMethodDef fingerprint_method = {"fingerprint",
+                                  unsafe_cast_to_pycfunction(fingerprint),
+                                  METH_VARARGS | METH_KEYWORDS,
+                                  fingerprint_doc};
+
+PyDoc_STRVAR(build_index_doc,
+             "build_index(indexed)\n"
+             "\n"
+             "Attach a hash index to a jlist so that index, count, and the in operator\n"
+             "look values up instead of scanning. Appending keeps the index up to\n"
+             "date; any other mutation drops it. Returns the jlist.\n"
+             "\n"
+             "Equivalent to: indexed.build_index(); indexed");
+
+PyObject* build_index(PyObject* module, PyObject* indexed) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    if (!PyObject_TypeCheck(indexed, state->jlist_type)) {
+        PyErr_Format(PyExc_TypeError,
+                     "build_index() argument must be a jlist, not %.200s",
+                     Py_TYPE(indexed)->tp_name);
+        return nullptr;
+    }
+
+    PyObject* result = PyObject_CallMethod(indexed, "build_index", nullptr);
+    if (!result) {
+        return nullptr;
+    }
+    Py_DECREF(result);
+    Py_INCREF(indexed);
+    return indexed;
+}
+
+PyMethodDef build_index_method = {"build_index", build_index, METH_O, build_index_doc};
+
+namespace detail {
+inline std::uint64_t sketch_hash(std::int64_t value) {
+    return mix64(value);
+}
+
+/** Hash a double so that integral values hash like the equal int.
+ */
+inline std::uint64_t sketch_hash(double value) {
+    if (value == std::trunc(value) && std::abs(value) < 0x1p63) {
+        return sketch_hash(static_cast<std::int64_t>(value));
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return mix64(bits ^ fingerprint_prime_2);
+}
+
+/** Hash a boxed value for a distinct count. ints, floats, str, and bytes hash the
+    same in every process; other values use `hash`. Returns true with an exception
+    raised if the value is unhashable.
+ */
+bool sketch_hash(PyObject* ob, std::uint64_t& out) {
+    if (PyLong_CheckExact(ob)) {
+        if (auto value = maybe_unbox<std::int64_t>(ob)) {
+            out = sketch_hash(*value);
+            return false;
+        }
+
+        // an int beyond int64 must hash like the float it equals, if there is one
+        double value = PyLong_AsDouble(ob);
+        if (value == -1.0 && PyErr_Occurred()) {
+            if (!PyErr_ExceptionMatches(PyExc_OverflowError)) {
+                return true;
+            }
+            PyErr_Clear();
+        }
+        else {
+            PyObject* as_float = PyFloat_FromDouble(value);
+            if (!as_float) {
+                return true;
+            }
+            int exact = PyObject_RichCompareBool(as_float, ob, Py_EQ);
+            Py_DECREF(as_float);
+            if (exact < 0) {
+                return true;
+            }
+            if (exact) {
+                out = sketch_hash(value);
+                return false;
+            }
+        }
+    }
+    else if (PyFloat_CheckExact(ob)) {
+        out = sketch_hash(PyFloat_AS_DOUBLE(ob));
+        return false;
+    }
+    else if (PyUnicode_CheckExact(ob)) {
+        if (PyUnicode_READY(ob) < 0) {
+            return true;
+        }
+        std::uint64_t domain = static_cast<std::uint64_t>(fingerprint_domain::str) +
+                               PyUnicode_KIND(ob);
+        out = fingerprint_bytes(static_cast<const char*>(PyUnicode_DATA(ob)),
+                                PyUnicode_GET_LENGTH(ob) * PyUnicode_KIND(ob),
+                                domain_seed(0, domain))
+                  .low;
+        return false;
+    }
+    else if (PyBytes_CheckExact(ob)) {
+        out = fingerprint_bytes(PyBytes_AS_STRING(ob),
+                                PyBytes_GET_SIZE(ob),
+                                domain_seed(0, fingerprint_domain::bytes))
+                  .low;
+        return false;
+    }
+
+    Py_hash_t h = PyObject_Hash(ob);
+    if (h == -1) {
+        return true;
+    }
+    out = mix64(h);
+    return false;
+}
+
+/** Add a hash to the HyperLogLog registers: the top `precision` bits pick a
+    register, which keeps the longest run of leading zeros seen in the rest of the
+    bits, plus one.
+ */
+inline void hll_add(std::uint8_t* registers, int precision, std::uint64_t h) {
+    std::uint64_t ix = h >> (64 - precision);
+    std::uint64_t rest = h << precision;
+    std::uint8_t rank = rest ? __builtin_clzll(rest) + 1 : 64 - precision + 1;
+    registers[ix] = std::max(registers[ix], rank);
+}
+
+/** Get the registers of a HyperLogLog sketch from a bytearray and check that there
+    are 2 ** precision of them. Returns nullptr with an exception raised on failure.
+ */
+std::uint8_t* hll_registers(PyObject* registers_ob, int& precision) {
+    if (!PyByteArray_CheckExact(registers_ob)) {
+        PyErr_SetString(PyExc_TypeError, "registers must be a bytearray");
+        return nullptr;
+    }
+    Py_ssize_t size = PyByteArray_GET_SIZE(registers_ob);
+    precision = 0;
+    while ((Py_ssize_t{1} << precision) < size) {
+        ++precision;
+    }
+    if ((Py_ssize_t{1} << precision) != size || precision < 4 || precision > 18) {
+        PyErr_SetString(PyExc_ValueError,
+                        "registers must have 2 ** precision bytes, with precision in "
+                        "[4, 18]");
+        return nullptr;
+    }
+    return reinterpret_cast<std::uint8_t*>(PyByteArray_AS_STRING(registers_ob));
+}
+}  // namespace detail
+
+PyDoc_STRVAR(hll_update_doc,
+             "_hll_update(registers, iterable)\n"
+             "\n"
+             "Add the values of the iterable to the registers of a HyperLogLog\n"
+             "sketch, a bytearray of 2 ** precision bytes.");
+
+PyObject* hll_update(PyObject* module, PyObject* args) {
+    PyObject* registers_ob;
+    PyObject* iterable;
+
+    if (!PyArg_ParseTuple(args, "OO:_hll_update", &registers_ob, &iterable)) {
+        return nullptr;
+    }
+    int precision;
+    std::uint8_t* registers = detail::hll_registers(registers_ob, precision);
+    if (!registers) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    switch (self.tag()) {
+    case entry_tag::as_int:
+        for (entry e : self.entries) {
+            detail::hll_add(registers, precision, detail::sketch_hash(e.as_int));
+        }
+        break;
+    case entry_tag::as_double:
+        for (entry e : self.entries) {
+            detail::hll_add(registers, precision, detail::sketch_hash(e.as_double));
+        }
+        break;
+    case entry_tag::as_homogeneous_ob:
+    case entry_tag::as_heterogeneous_ob: {
+        Py_ssize_t size = self.size();
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            if (self.size() != size) {
+                // `__hash__` resized the list
+                PyErr_SetString(PyExc_RuntimeError,
+                                "jlist changed size during iteration");
+                return nullptr;
+            }
+            PyObject* value = detail::box_entry(self, self.entries[ix]);
+            if (!value) {
+                return nullptr;
+            }
+            std::uint64_t h;
+            bool err = detail::sketch_hash(value, h);
+            Py_DECREF(value);
+            if (err) {
+                return nullptr;
+            }
+            detail::hll_add(registers, precision, h);
+        }
+        break;
+    }
+    case entry_tag::unset:
+        break;
+    default:
+        __builtin_unreachable();
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef hll_update_method = {"_hll_update", hll_update, METH_VARARGS, hll_update_doc};
+
+PyDoc_STRVAR(hll_merge_doc,
+             "_hll_merge(registers, other)\n"
+             "\n"
+             "Merge the registers of another HyperLogLog sketch with the same\n"
+             "precision into registers.");
+
+PyObject* hll_merge(PyObject*, PyObject* args) {
+    PyObject* registers_ob;
+    PyObject* other_ob;
+
+    if (!PyArg_ParseTuple(args, "OO:_hll_merge", &registers_ob, &other_ob)) {
+        return nullptr;
+    }
+    int precision;
+    int other_precision;
+    std::uint8_t* registers = detail::hll_registers(registers_ob, precision);
+    if (!registers) {
+        return nullptr;
+    }
+    std::uint8_t* other = detail::hll_registers(other_ob, other_precision);
+    if (!other) {
+        return nullptr;
+    }
+    if (precision != other_precision) {
+        PyErr_SetString(PyExc_ValueError, "cannot merge sketches of different precision");
+        return nullptr;
+    }
+
+    for (Py_ssize_t ix = 0; ix < (Py_ssize_t{1} << precision); ++ix) {
+        registers[ix] = std::max(registers[ix], other[ix]);
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef hll_merge_method = {"_hll_merge", hll_merge, METH_VARARGS, hll_merge_doc};
+
+PyDoc_STRVAR(hll_estimate_doc,
+             "_hll_estimate(registers)\n"
+             "\n"
+             "Estimate the number of distinct values added to a HyperLogLog sketch.");
+
+PyObject* hll_estimate(PyObject*, PyObject* registers_ob) {
+    int precision;
+    std::uint8_t* registers = detail::hll_registers(registers_ob, precision);
+    if (!registers) {
+        return nullptr;
+    }
+
+    double m = static_cast<double>(Py_ssize_t{1} << precision);
+    double inverse_sum = 0;
+    Py_ssize_t zeros = 0;
+    for (Py_ssize_t ix = 0; ix < (Py_ssize_t{1} << precision); ++ix) {
+        inverse_sum += std::ldexp(1.0, -registers[ix]);
+        zeros += registers[ix] == 0;
+    }
+
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / inverse_sum;
+    if (estimate <= 2.5 * m && zeros) {
+        // linear counting is more accurate while many registers are still empty
+        estimate = m * std::log(m / zeros);
+    }
+    return PyFloat_FromDouble(estimate);
+}
+
+PyMethodDef hll_estimate_method = {"_hll_estimate",
+                                   hll_estimate,
+                                   METH_O,
+                                   hll_estimate_doc};
+
+namespace detail {
+/** The capacity of a level of a KLL sketch with `height` levels. Lower levels hold
+    items of lower weight and shrink geometrically, except that the bottom level is
+    at least `k` items so that most compactions sort a full buffer.
+ */
+Py_ssize_t kll_capacity(Py_ssize_t k, Py_ssize_t level, Py_ssize_t height) {
+    double capacity = k * std::pow(2.0 / 3.0, height - 1 - level);
+    if (level == 0) {
+        return k;
+    }
+    return std::max<Py_ssize_t>(8, std::ceil(capacity));
+}
+
+/** The number of items which can be added to a KLL sketch before it must be
+    compacted.
+ */
+Py_ssize_t kll_free(PyObject* levels, Py_ssize_t k) {
+    Py_ssize_t height = PyList_GET_SIZE(levels);
+    Py_ssize_t free = 0;
+    for (Py_ssize_t ix = 0; ix < height; ++ix) {
+        free += kll_capacity(k, ix, height);
+        free -= reinterpret_cast<jlist*>(PyList_GET_ITEM(levels, ix))->size();
+    }
+    return free;
+}
+
+/** Compact levels of a KLL sketch until it fits in its capacity. Compacting a level
+    sorts it and moves every other item up one level, where it stands for twice as
+    many values. Whether the odd or even items move is chosen by hashing `seed`.
+ */
+bool kll_compress(PyObject* module, PyObject* levels, Py_ssize_t k, std::uint64_t seed) {
+    auto level_at = [&](Py_ssize_t ix) -> std::vector<entry>& {
+        return reinterpret_cast<jlist*>(PyList_GET_ITEM(levels, ix))->entries;
+    };
+
+    while (kll_free(levels, k) < 0) {
+        Py_ssize_t height = PyList_GET_SIZE(levels);
+        Py_ssize_t level = 0;
+        while (static_cast<Py_ssize_t>(level_at(level).size()) <
+               kll_capacity(k, level, height)) {
+            ++level;
+        }
+        if (level == height - 1) {
+            jlist* top = new_jlist(module, entry_tag::as_double);
+            if (!top) {
+                return true;
+            }
+            int err = PyList_Append(levels, reinterpret_cast<PyObject*>(top));
+            Py_DECREF(top);
+            if (err) {
+                return true;
+            }
+        }
+
+        std::vector<entry>& items = level_at(level);
+        std::vector<entry>& above = level_at(level + 1);
+        std::sort(items.begin(), items.end(), unboxed_less<double>{});
+
+        // an odd item out stays behind
+        std::size_t pairs = items.size() / 2;
+        std::size_t offset = mix64(seed ^ (level * fingerprint_prime_1)) & 1;
+        for (std::size_t ix = 0; ix < pairs; ++ix) {
+            above.push_back(items[2 * ix + offset]);
+        }
+        items.erase(items.begin(), items.begin() + 2 * pairs);
+        seed = mix64(seed + 1);
+    }
+    return false;
+}
+
+/** Check that a KLL sketch is a non-empty list of float jlists. Returns true with an
+    exception raised if it isn't.
+ */
+bool check_kll_levels(PyObject* module, PyObject* levels) {
+    if (!PyList_CheckExact(levels) || !PyList_GET_SIZE(levels)) {
+        PyErr_SetString(PyExc_TypeError, "levels must be a non-empty list");
+        return true;
+    }
+    for (Py_ssize_t ix = 0; ix < PyList_GET_SIZE(levels); ++ix) {
+        PyObject* level = PyList_GET_ITEM(levels, ix);
+        if (!is_jlist(module, level)) {
+            PyErr_SetString(PyExc_TypeError, "levels must be jlists");
+            return true;
+        }
+        jlist& list = *reinterpret_cast<jlist*>(level);
+        if (list.tag() == entry_tag::unset) {
+            list.tag(entry_tag::as_double);
+        }
+        if (list.tag() != entry_tag::as_double) {
+            PyErr_SetString(PyExc_TypeError, "levels must be float jlists");
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(kll_update_doc,
+             "_kll_update(levels, iterable, level, k, seed)\n"
+             "\n"
+             "Add the int or float values of the iterable to a level of a KLL sketch,\n"
+             "stored as a list of float jlists, and compact the sketch. NaNs are\n"
+             "skipped. Returns (count, min, max) of the values which were added, with\n"
+             "None for min and max if no values were added.");
+
+PyObject* kll_update(PyObject* module, PyObject* args) {
+    PyObject* levels;
+    PyObject* iterable;
+    Py_ssize_t level;
+    Py_ssize_t k;
+    unsigned long long seed;
+
+    if (!PyArg_ParseTuple(args,
+                          "OOnnK:_kll_update",
+                          &levels,
+                          &iterable,
+                          &level,
+                          &k,
+                          &seed)) {
+        return nullptr;
+    }
+    if (detail::check_kll_levels(module, levels)) {
+        return nullptr;
+    }
+    if (level < 0 || k < 8) {
+        PyErr_SetString(PyExc_ValueError, "level must be >= 0 and k must be >= 8");
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+    if (self.boxed()) {
+        PyErr_SetString(PyExc_TypeError, "quantile sketches require int or float values");
+        return nullptr;
+    }
+
+    while (PyList_GET_SIZE(levels) <= level) {
+        jlist* empty = detail::new_jlist(module, entry_tag::as_double);
+        if (!empty) {
+            return nullptr;
+        }
+        int err = PyList_Append(levels, reinterpret_cast<PyObject*>(empty));
+        Py_DECREF(empty);
+        if (err) {
+            return nullptr;
+        }
+    }
+
+    Py_ssize_t count = 0;
+    double low = std::numeric_limits<double>::infinity();
+    double high = -std::numeric_limits<double>::infinity();
+    auto add = [&](auto type) {
+        using T = decltype(type);
+        std::vector<entry>& target =
+            reinterpret_cast<jlist*>(PyList_GET_ITEM(levels, level))->entries;
+        // compact as the values are added so that each compaction sorts a short level
+        Py_ssize_t free = detail::kll_free(levels, k);
+        for (entry e : self.entries) {
+            double value = entry_value<T>(e);
+            if (std::isnan(value)) {
+                continue;
+            }
+            low = std::min(low, value);
+            high = std::max(high, value);
+            target.emplace_back().as_double = value;
+            ++count;
+            if (--free < 0) {
+                if (detail::kll_compress(module, levels, k, seed + count)) {
+                    return true;
+                }
+                free = detail::kll_free(levels, k);
+            }
+        }
+        return false;
+    };
+    if (self.tag() == entry_tag::as_int) {
+        if (add(std::int64_t{})) {
+            return nullptr;
+        }
+    }
+    else if (self.tag() == entry_tag::as_double) {
+        if (add(double{})) {
+            return nullptr;
+        }
+    }
+
+    if (!count) {
+        return Py_BuildValue("(nOO)", count, Py_None, Py_None);
+    }
+    return Py_BuildValue("(ndd)", count, low, high);
+}
+
+PyMethodDef kll_update_method = {"_kll_update", kll_update, METH_VARARGS, kll_update_doc};
+
+PyDoc_STRVAR(kll_quantiles_doc,
+             "_kll_quantiles(levels, qs)\n"
+             "\n"
+             "Estimate quantiles from a KLL sketch. Each item stands for 2 ** level\n"
+             "values; values between two ranks are linearly interpolated, so a sketch\n"
+             "which has not been compacted gives the same results as quantile.");
+
+PyObject* kll_quantiles(PyObject* module, PyObject* args) {
+    PyObject* levels;
+    PyObject* qs_ob;
+
+    if (!PyArg_ParseTuple(args, "OO:_kll_quantiles", &levels, &qs_ob)) {
+        return nullptr;
+    }
+    if (detail::check_kll_levels(module, levels)) {
+        return nullptr;
+    }
+
+    PyObject* fast = PySequence_Fast(qs_ob, "qs must be a sequence");
+    if (!fast) {
+        return nullptr;
+    }
+    scope_guard decref_fast([&] { Py_DECREF(fast); });
+    std::vector<double> qs(PySequence_Fast_GET_SIZE(fast));
+    for (std::size_t ix = 0; ix < qs.size(); ++ix) {
+        if (detail::parse_q(PySequence_Fast_GET_ITEM(fast, ix), qs[ix])) {
+            return nullptr;
+        }
+    }
+
+    // (value, weight) pairs in ascending order
+    std::vector<std::pair<double, double>> items;
+    double total = 0;
+    for (Py_ssize_t level = 0; level < PyList_GET_SIZE(levels); ++level) {
+        double weight = std::ldexp(1.0, level);
+        jlist& values = *reinterpret_cast<jlist*>(PyList_GET_ITEM(levels, level));
+        for (entry e : values.entries) {
+            items.emplace_back(e.as_double, weight);
+        }
+        total += weight * values.size();
+    }
+    if (items.empty()) {
+        PyErr_SetString(PyExc_ValueError, "quantiles of an empty sketch");
+        return nullptr;
+    }
+    std::sort(items.begin(), items.end());
+
+    // the exclusive prefix sum of the weights, which is the rank of each item's first
+    // copy
+    std::vector<double> ranks(items.size());
+    double rank = 0;
+    for (std::size_t ix = 0; ix < items.size(); ++ix) {
+        ranks[ix] = rank;
+        rank += items[ix].second;
+    }
+    auto value_at = [&](double rank) {
+        auto it = std::upper_bound(ranks.begin(), ranks.end(), rank);
+        return items[it - ranks.begin() - 1].first;
+    };
+
+    jlist* out = detail::new_jlist(module, entry_tag::as_double);
+    if (!out) {
+        return nullptr;
+    }
+    out->entries.resize(qs.size());
+    for (std::size_t ix = 0; ix < qs.size(); ++ix) {
+        double pos = qs[ix] * (total - 1);
+        double low = std::floor(pos);
+        double frac = pos - low;
+        double result = value_at(low);
+        if (frac > 0) {
+            result += (value_at(low + 1) - result) * frac;
+        }
+        out->entries[ix].as_double = result;
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef kll_quantiles_method = {"_kll_quantiles",
+                                    kll_quantiles,
+                                    METH_VARARGS,
+                                    kll_quantiles_doc};
+
+namespace detail {
+enum class lazy_op {
+    map,
+    filter,
+    add,
+    radd,
+    sub,
+    rsub,
+    mul,
+    rmul,
+    truediv,
+    rtruediv,
+    neg,
+};
+
+struct lazy_stage {
+    lazy_op op;
+    PyObject* arg;
+};
+
+/** Parse the stages of a lazy pipeline, a tuple of `(name, arg)` pairs. The args are
+    borrowed from the tuple. Returns true with an exception raised on failure.
+ */
+bool parse_lazy_stages(PyObject* stages_ob, std::vector<lazy_stage>& out) {
+    static const std::array<std::pair<const char*, lazy_op>, 11> names = {{
+        {"map", lazy_op::map},
+        {"filter", lazy_op::filter},
+        {"add", lazy_op::add},
+        {"radd", lazy_op::radd},
+        {"sub", lazy_op::sub},
+        {"rsub", lazy_op::rsub},
+        {"mul", lazy_op::mul},
+        {"rmul", lazy_op::rmul},
+        {"truediv", lazy_op::truediv},
+        {"rtruediv", lazy_op::rtruediv},
+        {"neg", lazy_op::neg},
+    }};
+
+    if (!PyTuple_CheckExact(stages_ob)) {
+        PyErr_SetString(PyExc_TypeError, "stages must be a tuple");
+        return true;
+    }
+    for (Py_ssize_t ix = 0; ix < PyTuple_GET_SIZE(stages_ob); ++ix) {
+        PyObject* stage = PyTuple_GET_ITEM(stages_ob, ix);
+        if (!PyTuple_CheckExact(stage) || PyTuple_GET_SIZE(stage) != 2 ||
+            !PyUnicode_CheckExact(PyTuple_GET_ITEM(stage, 0))) {
+            PyErr_SetString(PyExc_TypeError, "stages must be (name, arg) pairs");
+            return true;
+        }
+        const char* name = PyUnicode_AsUTF8(PyTuple_GET_ITEM(stage, 0));
+        if (!name) {
+            return true;
+        }
+        auto it = std::find_if(names.begin(), names.end(), [&](const auto& pair) {
+            return std::strcmp(pair.first, name) == 0;
+        });
+        if (it == names.end()) {
+            PyErr_Format(PyExc_ValueError, "unknown lazy stage: %s", name);
+            return true;
+        }
+        out.push_back({it->second, PyTuple_GET_ITEM(stage, 1)});
+    }
+    return false;
+}
+
+/** The number of values which move through a lazy pipeline together, small enough
+    that a block stays in cache from the first stage to the last.
+ */
+constexpr Py_ssize_t lazy_block_size = 512;
+
+/** A block of values moving through a lazy pipeline. The values are unboxed ints,
+    unboxed doubles, or owned references to objects.
+ */
+struct lazy_block {
+    entry_tag tag = entry_tag::unset;
+    std::vector<entry> values;
+    std::vector<entry> scratch;
+
+    lazy_block() = default;
+    lazy_block(const lazy_block&) = delete;
+
+    ~lazy_block() {
+        clear();
+    }
+
+    bool boxed() const {
+        return tag == entry_tag::as_heterogeneous_ob;
+    }
+
+    void clear() {
+        if (boxed()) {
+            for (entry e : values) {
+                Py_DECREF(e.as_ob);
+            }
+        }
+        values.clear();
+    }
+
+    /** Copy `source[start:stop]` into the block.
+     */
+    void load(jlist& source, Py_ssize_t start, Py_ssize_t stop) {
+        clear();
+        tag = source.boxed() ? entry_tag::as_heterogeneous_ob : source.tag();
+        values.assign(source.entries.begin() + start, source.entries.begin() + stop);
+        if (boxed()) {
+            for (entry e : values) {
+                Py_INCREF(e.as_ob);
+            }
+        }
+    }
+
+    /** Box the values in place. Returns true with an exception raised on failure.
+     */
+    bool box() {
+        if (boxed()) {
+            return false;
+        }
+        for (std::size_t ix = 0; ix < values.size(); ++ix) {
+            PyObject* ob = (tag == entry_tag::as_int) ? box_value(values[ix].as_int)
+                                                      : box_value(values[ix].as_double);
+            if (!ob) {
+                // only the values before `ix` are owned references
+                values.resize(ix);
+                tag = entry_tag::as_heterogeneous_ob;
+                return true;
+            }
+            values[ix].as_ob = ob;
+        }
+        tag = entry_tag::as_heterogeneous_ob;
+        return false;
+    }
+
+    void to_double() {
+        for (entry& e : values) {
+            e.as_double = e.as_int;
+        }
+        tag = entry_tag::as_double;
+    }
+
+    /** Unbox the values if they are all ints which fit in 64 bits or all floats, so
+        that later stages can use the unboxed loops.
+     */
+    void narrow() {
+        if (!boxed() || values.empty()) {
+            return;
+        }
+        if (PyLong_CheckExact(values.front().as_ob)) {
+            narrow_to<std::int64_t>();
+        }
+        else if (PyFloat_CheckExact(values.front().as_ob)) {
+            narrow_to<double>();
+        }
+    }
+
+private:
+    template<typename T>
+    void narrow_to() {
+        scratch.resize(values.size());
+        for (std::size_t ix = 0; ix < values.size(); ++ix) {
+            auto unboxed = maybe_unbox<T>(values[ix].as_ob);
+            if (!unboxed) {
+                return;
+            }
+            entry_value<T>(scratch[ix]) = *unboxed;
+        }
+        clear();
+        values.swap(scratch);
+        tag = std::is_same_v<T, double> ? entry_tag::as_double : entry_tag::as_int;
+    }
+};
+
+/** Box the value at `ix` of a block, or return a new reference to it for objects.
+ */
+PyObject* lazy_box(lazy_block& block, std::size_t ix) {
+    switch (block.tag) {
+    case entry_tag::as_heterogeneous_ob:
+        return box_value(block.values[ix].as_ob);
+    case entry_tag::as_int:
+        return box_value(block.values[ix].as_int);
+    case entry_tag::as_double:
+        return box_value(block.values[ix].as_double);
+    default:
+        __builtin_unreachable();
+    }
+}
+
+PyObject* lazy_number_op(lazy_op op, PyObject* value, PyObject* scalar) {
+    switch (op) {
+    case lazy_op::add:
+        return PyNumber_Add(value, scalar);
+    case lazy_op::radd:
+        return PyNumber_Add(scalar, value);
+    case lazy_op::sub:
+        return PyNumber_Subtract(value, scalar);
+    case lazy_op::rsub:
+        return PyNumber_Subtract(scalar, value);
+    case lazy_op::mul:
+        return PyNumber_Multiply(value, scalar);
+    case lazy_op::rmul:
+        return PyNumber_Multiply(scalar, value);
+    case lazy_op::truediv:
+        return PyNumber_TrueDivide(value, scalar);
+    case lazy_op::rtruediv:
+        return PyNumber_TrueDivide(scalar, value);
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Apply an arithmetic stage to an int block without boxing. Returns false, leaving
+    the block unchanged, if a result would overflow or lose precision.
+ */
+bool lazy_int_op(lazy_block& block, lazy_op op, std::int64_t scalar) {
+    auto loop = [&](auto f) {
+        block.scratch.resize(block.values.size());
+        for (std::size_t ix = 0; ix < block.values.size(); ++ix) {
+            if (f(block.values[ix].as_int, block.scratch[ix].as_int)) {
+                return false;
+            }
+        }
+        block.values.swap(block.scratch);
+        return true;
+    };
+
+    switch (op) {
+    case lazy_op::add:
+    case lazy_op::radd:
+        return loop([&](std::int64_t v, std::int64_t& out) {
+            return __builtin_add_overflow(v, scalar, &out);
+        });
+    case lazy_op::sub:
+        return loop([&](std::int64_t v, std::int64_t& out) {
+            return __builtin_sub_overflow(v, scalar, &out);
+        });
+    case lazy_op::rsub:
+        return loop([&](std::int64_t v, std::int64_t& out) {
+            return __builtin_sub_overflow(scalar, v, &out);
+        });
+    case lazy_op::mul:
+    case lazy_op::rmul:
+        return loop([&](std::int64_t v, std::int64_t& out) {
+            return __builtin_mul_overflow(v, scalar, &out);
+        });
+    case lazy_op::truediv:
+    case lazy_op::rtruediv: {
+        // ints up to 2 ** 53 are exact as doubles, so dividing the doubles rounds the
+        // same way as dividing the ints; zero divisors raise through the boxed path
+        constexpr std::int64_t exact = std::int64_t{1} << 53;
+        auto fits = [&](std::int64_t v) { return -exact <= v && v <= exact; };
+        if (!fits(scalar) || (op == lazy_op::truediv && !scalar)) {
+            return false;
+        }
+        for (entry e : block.values) {
+            if (!fits(e.as_int) || (op == lazy_op::rtruediv && !e.as_int)) {
+                return false;
+            }
+        }
+        block.to_double();
+        double s = scalar;
+        for (entry& e : block.values) {
+            e.as_double = (op == lazy_op::truediv) ? e.as_double / s : s / e.as_double;
+        }
+        return true;
+    }
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Apply an arithmetic stage to a double block without boxing. Returns false, leaving
+    the block unchanged, if the stage would divide by zero.
+ */
+bool lazy_double_op(lazy_block& block, lazy_op op, double scalar) {
+    auto loop = [&](auto f) {
+        for (entry& e : block.values) {
+            e.as_double = f(e.as_double);
+        }
+        return true;
+    };
+
+    switch (op) {
+    case lazy_op::add:
+    case lazy_op::radd:
+        return loop([&](double v) { return v + scalar; });
+    case lazy_op::sub:
+        return loop([&](double v) { return v - scalar; });
+    case lazy_op::rsub:
+        return loop([&](double v) { return scalar - v; });
+    case lazy_op::mul:
+    case lazy_op::rmul:
+        return loop([&](double v) { return v * scalar; });
+    case lazy_op::truediv:
+        return scalar != 0 && loop([&](double v) { return v / scalar; });
+    case lazy_op::rtruediv:
+        for (entry e : block.values) {
+            if (e.as_double == 0) {
+                return false;
+            }
+        }
+        return loop([&](double v) { return scalar / v; });
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Apply an arithmetic stage with a scalar operand. Unboxed blocks with int or float
+    scalars use the unboxed loops; everything else goes through the number protocol.
+    Returns true with an exception raised on failure.
+ */
+bool lazy_arithmetic(lazy_block& block, lazy_op op, PyObject* scalar) {
+    if (block.tag == entry_tag::as_int) {
+        if (auto s = maybe_unbox<std::int64_t>(scalar)) {
+            if (lazy_int_op(block, op, *s)) {
+                return false;
+            }
+        }
+        else if (PyFloat_CheckExact(scalar)) {
+            block.to_double();
+        }
+    }
+    if (block.tag == entry_tag::as_double) {
+        std::optional<double> s;
+        if (PyFloat_CheckExact(scalar)) {
+            s = PyFloat_AS_DOUBLE(scalar);
+        }
+        else if (auto as_int = maybe_unbox<std::int64_t>(scalar)) {
+            s = *as_int;
+        }
+        if (s && lazy_double_op(block, op, *s)) {
+            return false;
+        }
+    }
+
+    if (block.box()) {
+        return true;
+    }
+    for (entry& e : block.values) {
+        PyObject* result = lazy_number_op(op, e.as_ob, scalar);
+        if (!result) {
+            return true;
+        }
+        Py_DECREF(e.as_ob);
+        e.as_ob = result;
+    }
+    block.narrow();
+    return false;
+}
+
+/** Negate each value. Ints stay unboxed unless one is the smallest int64, whose
+    negation doesn't fit. Returns true with an exception raised on failure.
+ */
+bool lazy_negate(lazy_block& block) {
+    if (block.tag == entry_tag::as_int &&
+        std::none_of(block.values.begin(), block.values.end(), [](entry e) {
+            return e.as_int == std::numeric_limits<std::int64_t>::min();
+        })) {
+        for (entry& e : block.values) {
+            e.as_int = -e.as_int;
+        }
+        return false;
+    }
+    if (block.tag == entry_tag::as_double) {
+        for (entry& e : block.values) {
+            e.as_double = -e.as_double;
+        }
+        return false;
+    }
+
+    if (block.box()) {
+        return true;
+    }
+    for (entry& e : block.values) {
+        PyObject* result = PyNumber_Negative(e.as_ob);
+        if (!result) {
+            return true;
+        }
+        Py_DECREF(e.as_ob);
+        e.as_ob = result;
+    }
+    block.narrow();
+    return false;
+}
+
+/** Replace each value with `f(value)`. Returns true with an exception raised on
+    failure.
+ */
+bool lazy_map(lazy_block& block, PyObject* f) {
+    if (block.box()) {
+        return true;
+    }
+    for (entry& e : block.values) {
+        PyObject* result = PyObject_CallFunctionObjArgs(f, e.as_ob, nullptr);
+        if (!result) {
+            return true;
+        }
+        Py_DECREF(e.as_ob);
+        e.as_ob = result;
+    }
+    block.narrow();
+    return false;
+}
+
+/** Keep the values where `f(value)` is true. Returns true with an exception raised on
+    failure.
+ */
+bool lazy_filter(lazy_block& block, PyObject* f) {
+    std::size_t kept = 0;
+    for (std::size_t ix = 0; ix < block.values.size(); ++ix) {
+        entry e = block.values[ix];
+        PyObject* ob = lazy_box(block, ix);
+        PyObject* result = ob ? PyObject_CallFunctionObjArgs(f, ob, nullptr) : nullptr;
+        Py_XDECREF(ob);
+        int keep = result ? PyObject_IsTrue(result) : -1;
+        Py_XDECREF(result);
+        if (keep < 0) {
+            // drop the gap of released values so the block only holds owned references
+            block.values.erase(block.values.begin() + kept, block.values.begin() + ix);
+            return true;
+        }
+        if (keep) {
+            block.values[kept++] = e;
+        }
+        else if (block.boxed()) {
+            Py_DECREF(e.as_ob);
+        }
+    }
+    block.values.resize(kept);
+    return false;
+}
+
+bool lazy_apply(lazy_block& block, const lazy_stage& stage) {
+    switch (stage.op) {
+    case lazy_op::map:
+        return lazy_map(block, stage.arg);
+    case lazy_op::filter:
+        return lazy_filter(block, stage.arg);
+    case lazy_op::neg:
+        return lazy_negate(block);
+    default:
+        return lazy_arithmetic(block, stage.op, stage.arg);
+    }
+}
+
+/** Collect the values into a new jlist.
+ */
+struct lazy_collect {
+    PyObject* module;
+    jlist* out = nullptr;
+
+    ~lazy_collect() {
+        Py_XDECREF(out);
+    }
+
+    bool consume(lazy_block& block) {
+        if (!out && !(out = new_jlist(module, entry_tag::unset))) {
+            return true;
+        }
+        if (!block.boxed() &&
+            (out->tag() == block.tag || out->tag() == entry_tag::unset)) {
+            out->tag(block.tag);
+            out->entries.insert(out->entries.end(),
+                                block.values.begin(),
+                                block.values.end());
+            return false;
+        }
+        for (std::size_t ix = 0; ix < block.values.size(); ++ix) {
+            PyObject* ob = lazy_box(block, ix);
+            if (!ob) {
+                return true;
+            }
+            bool err = append_value(reinterpret_cast<PyObject*>(out), ob);
+            Py_DECREF(ob);
+            if (err) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    PyObject* result() {
+        if (!out) {
+            return reinterpret_cast<PyObject*>(new_jlist(module, entry_tag::unset));
+        }
+        return reinterpret_cast<PyObject*>(std::exchange(out, nullptr));
+    }
+};
+
+/** Add up the values, keeping the total unboxed while the values are ints which don't
+    overflow or floats.
+ */
+struct lazy_sum {
+    entry_tag tag;
+    std::int64_t as_int = 0;
+    double as_double = 0;
+    PyObject* as_ob = nullptr;
+
+    explicit lazy_sum(PyObject* start) {
+        if (auto unboxed = maybe_unbox<std::int64_t>(start)) {
+            tag = entry_tag::as_int;
+            as_int = *unboxed;
+        }
+        else if (PyFloat_CheckExact(start)) {
+            tag = entry_tag::as_double;
+            as_double = PyFloat_AS_DOUBLE(start);
+        }
+        else {
+            tag = entry_tag::as_heterogeneous_ob;
+            as_ob = box_value(start);
+        }
+    }
+
+    ~lazy_sum() {
+        Py_XDECREF(as_ob);
+    }
+
+    bool consume(lazy_block& block) {
+        std::size_t ix = 0;
+        if (block.tag == entry_tag::as_int && tag == entry_tag::as_int) {
+            for (; ix < block.values.size(); ++ix) {
+                std::int64_t total;
+                if (__builtin_add_overflow(as_int, block.values[ix].as_int, &total)) {
+                    break;
+                }
+                as_int = total;
+            }
+        }
+        else if (block.tag == entry_tag::as_int && tag == entry_tag::as_double) {
+            for (; ix < block.values.size(); ++ix) {
+                as_double += block.values[ix].as_int;
+            }
+        }
+        else if (block.tag == entry_tag::as_double && !is_object_tag(tag)) {
+            if (tag == entry_tag::as_int) {
+                tag = entry_tag::as_double;
+                as_double = as_int;
+            }
+            for (; ix < block.values.size(); ++ix) {
+                as_double += block.values[ix].as_double;
+            }
+        }
+        if (ix == block.values.size()) {
+            return false;
+        }
+
+        // fall back to boxed addition from the first value we couldn't add unboxed
+        if (tag == entry_tag::as_int) {
+            as_ob = box_value(as_int);
+        }
+        else if (tag == entry_tag::as_double) {
+            as_ob = box_value(as_double);
+        }
+        tag = entry_tag::as_heterogeneous_ob;
+        if (!as_ob) {
+            return true;
+        }
+        for (; ix < block.values.size(); ++ix) {
+            PyObject* ob = lazy_box(block, ix);
+            if (!ob) {
+                return true;
+            }
+            PyObject* total = PyNumber_Add(as_ob, ob);
+            Py_DECREF(ob);
+            if (!total) {
+                return true;
+            }
+            Py_SETREF(as_ob, total);
+        }
+        return false;
+    }
+
+    PyObject* result() {
+        switch (tag) {
+        case entry_tag::as_int:
+            return box_value(as_int);
+        case entry_tag::as_double:
+            return box_value(as_double);
+        default:
+            return box_value(as_ob);
+        }
+    }
+};
+
+struct lazy_count {
+    Py_ssize_t count = 0;
+
+    bool consume(lazy_block& block) {
+        count += block.values.size();
+        return false;
+    }
+
+    PyObject* result() {
+        return PyLong_FromSsize_t(count);
+    }
+};
+
+/** Find the smallest or largest value. Like `min` and `max`, the first of several
+    equal values wins.
+ */
+template<int op>
+struct lazy_extreme {
+    static_assert(op == Py_LT || op == Py_GT, "op must be Py_LT or Py_GT");
+
+    entry_tag tag = entry_tag::unset;
+    entry best;
+
+    ~lazy_extreme() {
+        if (tag == entry_tag::as_heterogeneous_ob) {
+            Py_DECREF(best.as_ob);
+        }
+    }
+
+    template<typename T>
+    static bool better(T a, T b) {
+        return (op == Py_LT) ? a < b : a > b;
+    }
+
+    template<typename T>
+    void unboxed_loop(lazy_block& block) {
+        std::size_t ix = 0;
+        if (tag == entry_tag::unset) {
+            tag = block.tag;
+            best = block.values[ix++];
+        }
+        T value = entry_value<T>(best);
+        for (; ix < block.values.size(); ++ix) {
+            if (better(entry_value<T>(block.values[ix]), value)) {
+                value = entry_value<T>(block.values[ix]);
+            }
+        }
+        entry_value<T>(best) = value;
+    }
+
+    bool consume(lazy_block& block) {
+        if (block.values.empty()) {
+            return false;
+        }
+        if (!block.boxed() && (tag == block.tag || tag == entry_tag::unset)) {
+            if (block.tag == entry_tag::as_int) {
+                unboxed_loop<std::int64_t>(block);
+            }
+            else {
+                unboxed_loop<double>(block);
+            }
+            return false;
+        }
+
+        if (tag != entry_tag::as_heterogeneous_ob && tag != entry_tag::unset) {
+            PyObject* boxed = (tag == entry_tag::as_int) ? box_value(best.as_int)
+                                                          : box_value(best.as_double);
+            if (!boxed) {
+                return true;
+            }
+            best.as_ob = boxed;
+            tag = entry_tag::as_heterogeneous_ob;
+        }
+        for (std::size_t ix = 0; ix < block.values.size(); ++ix) {
+            PyObject* ob = lazy_box(block, ix);
+            if (!ob) {
+                return true;
+            }
+            if (tag == entry_tag::unset) {
+                tag = entry_tag::as_heterogeneous_ob;
+                best.as_ob = ob;
+                continue;
+            }
+            int r = PyObject_RichCompareBool(ob, best.as_ob, op);
+            if (r < 0) {
+                Py_DECREF(ob);
+                return true;
+            }
+            if (r) {
+                std::swap(ob, best.as_ob);
+            }
+            Py_DECREF(ob);
+        }
+        return false;
+    }
+
+    PyObject* result() {
+        switch (tag) {
+        case entry_tag::unset:
+            PyErr_Format(PyExc_ValueError,
+                         "%s() arg is an empty sequence",
+                         (op == Py_LT) ? "min" : "max");
+            return nullptr;
+        case entry_tag::as_int:
+            return box_value(best.as_int);
+        case entry_tag::as_double:
+            return box_value(best.as_double);
+        default:
+            return box_value(best.as_ob);
+        }
+    }
+};
+
+/** Run the stages over `source` one block at a time, feeding each block to `terminal`.
+    The source is read a block at a time, so a stage which mutates it sees its changes
+    like a `for` loop over a list would.
+ */
+template<typename Terminal>
+PyObject* run_lazy(jlist& source,
+                   const std::vector<lazy_stage>& stages,
+                   Terminal&& terminal) {
+    lazy_block block;
+    for (Py_ssize_t start = 0; start < source.size(); start += lazy_block_size) {
+        block.load(source, start, std::min(source.size(), start + lazy_block_size));
+        for (const lazy_stage& stage : stages) {
+            if (lazy_apply(block, stage)) {
+                return nullptr;
+            }
+            if (block.values.empty()) {
+                break;
+            }
+        }
+        if (terminal.consume(block)) {
+            return nullptr;
+        }
+    }
+    return terminal.result();
+}
+}  // namespace detail
+
+PyDoc_STRVAR(lazy_run_doc,
+             "_lazy_run(iterable, stages, terminal, start=0)\n"
+             "\n"
+             "Run a lazy pipeline over the iterable in one pass, without building a\n"
+             "jlist for each stage. stages is a tuple of (name, arg) pairs, where name\n"
+             "is 'map' or 'filter' with a callable, or an arithmetic operator with a\n"
+             "scalar operand. terminal is one of 'collect', 'sum', 'count', 'min', or\n"
+             "'max'.");
+
+PyObject* lazy_run(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* stages_ob;
+    const char* terminal;
+    PyObject* start = nullptr;
+
+    if (!PyArg_ParseTuple(args,
+                          "OOs|O:_lazy_run",
+                          &iterable,
+                          &stages_ob,
+                          &terminal,
+                          &start)) {
+        return nullptr;
+    }
+    std::vector<detail::lazy_stage> stages;
+    if (detail::parse_lazy_stages(stages_ob, stages)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (!std::strcmp(terminal, "collect")) {
+        return detail::run_lazy(self, stages, detail::lazy_collect{module});
+    }
+    if (!std::strcmp(terminal, "sum")) {
+        PyObject* zero = nullptr;
+        if (!start && !(start = zero = PyLong_FromLong(0))) {
+            return nullptr;
+        }
+        scope_guard decref_zero([&] { Py_XDECREF(zero); });
+        return detail::run_lazy(self, stages, detail::lazy_sum{start});
+    }
+    if (!std::strcmp(terminal, "count")) {
+        return detail::run_lazy(self, stages, detail::lazy_count{});
+    }
+    if (!std::strcmp(terminal, "min")) {
+        return detail::run_lazy(self, stages, detail::lazy_extreme<Py_LT>{});
+    }
+    if (!std::strcmp(terminal, "max")) {
+        return detail::run_lazy(self, stages, detail::lazy_extreme<Py_GT>{});
+    }
+    PyErr_Format(PyExc_ValueError, "unknown lazy terminal: %s", terminal);
+    return nullptr;
+}
+
+PyMethodDef lazy_run_method = {"_lazy_run", lazy_run, METH_VARARGS, lazy_run_doc};
+
+namespace detail {
+template<int op, typename T>
+bool compare(T a, T b) {
+    if constexpr (op == Py_LT) {
+        return a < b;
+    }
+    else if constexpr (op == Py_LE) {
+        return a <= b;
+    }
+    else if constexpr (op == Py_EQ) {
+        return a == b;
+    }
+    else if constexpr (op == Py_NE) {
+        return a != b;
+    }
+    else if constexpr (op == Py_GT) {
+        return a > b;
+    }
+    else {
+        static_assert(op == Py_GE, "op must be a rich comparison op");
+        return a >= b;
+    }
+}
+
+/** Call `f` with `op` as a `std::integral_constant`.
+ */
+template<typename F>
+auto with_compare_op(int op, F&& f) {
+    switch (op) {
+    case Py_LT:
+        return f(std::integral_constant<int, Py_LT>{});
+    case Py_LE:
+        return f(std::integral_constant<int, Py_LE>{});
+    case Py_EQ:
+        return f(std::integral_constant<int, Py_EQ>{});
+    case Py_NE:
+        return f(std::integral_constant<int, Py_NE>{});
+    case Py_GT:
+        return f(std::integral_constant<int, Py_GT>{});
+    case Py_GE:
+        return f(std::integral_constant<int, Py_GE>{});
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Compare the values of an int list to a float scalar exactly, the way Python
+    compares ints and floats, by rounding the scalar to an int and adjusting `op`.
+    Returns false if the comparison can't be done on the unboxed values.
+ */
+template<typename Sink>
+bool compare_ints_to_double(jlist& self, int op, double scalar, Sink& sink) {
+    auto constant = [&](bool result) {
+        sink.loop(self.entries, [=](entry) { return result; });
+        return true;
+    };
+
+    if (std::isnan(scalar)) {
+        return constant(op == Py_NE);
+    }
+    if (scalar >= 0x1p63 || scalar < -0x1p63) {
+        // every int64 is on the same side of the scalar
+        bool below = scalar > 0;
+        switch (op) {
+        case Py_LT:
+        case Py_LE:
+            return constant(below);
+        case Py_GT:
+        case Py_GE:
+            return constant(!below);
+        default:
+            return constant(op == Py_NE);
+        }
+    }
+
+    std::int64_t rounded = std::floor(scalar);
+    if (rounded != scalar) {
+        // x < scalar iff x <= floor(scalar), and no int is equal to the scalar
+        switch (op) {
+        case Py_LT:
+        case Py_LE:
+            op = Py_LE;
+            break;
+        case Py_GT:
+        case Py_GE:
+            op = Py_GT;
+            break;
+        default:
+            return constant(op == Py_NE);
+        }
+    }
+    with_compare_op(op, [&](auto op) {
+        sink.loop(self.entries, [=](entry e) {
+            return compare<decltype(op)::value>(e.as_int, rounded);
+        });
+    });
+    return true;
+}
+
+/** Compare each value of `self` to `scalar`, feeding the results to `sink`.
+
+    Int and float lists compared to int or float scalars use the unboxed values;
+    otherwise each value is boxed and compared like `bool(x op scalar)`. Returns true
+    with an exception raised on failure.
+ */
+template<typename Sink>
+bool compare_to_scalar(jlist& self, int op, PyObject* scalar, Sink& sink) {
+    if (self.tag() == entry_tag::unset) {
+        return false;
+    }
+    if (self.tag() == entry_tag::as_int) {
+        if (auto s = maybe_unbox<std::int64_t>(scalar)) {
+            with_compare_op(op, [&](auto op) {
+                sink.loop(self.entries, [s = *s](entry e) {
+                    return compare<decltype(op)::value>(e.as_int, s);
+                });
+            });
+            return false;
+        }
+        if (PyFloat_CheckExact(scalar) &&
+            compare_ints_to_double(self, op, PyFloat_AS_DOUBLE(scalar), sink)) {
+            return false;
+        }
+    }
+    else if (self.tag() == entry_tag::as_double) {
+        std::optional<double> s = maybe_unbox<double>(scalar);
+        if (auto as_int = maybe_unbox<std::int64_t>(scalar)) {
+            // ints up to 2 ** 53 convert to doubles exactly
+            if (-(std::int64_t{1} << 53) <= *as_int && *as_int <= std::int64_t{1} << 53) {
+                s = *as_int;
+            }
+        }
+        if (s) {
+            with_compare_op(op, [&](auto op) {
+                sink.loop(self.entries, [s = *s](entry e) {
+                    return compare<decltype(op)::value>(e.as_double, s);
+                });
+            });
+            return false;
+        }
+    }
+
+    Py_ssize_t size = self.size();
+    entry_tag tag = self.tag();
+    for (Py_ssize_t ix = 0; ix < size; ++ix) {
+        PyObject* value = box_entry(self, self.entries[ix]);
+        if (!value) {
+            return true;
+        }
+        PyObject* result_ob = PyObject_RichCompare(value, scalar, op);
+        Py_DECREF(value);
+        if (!result_ob) {
+            return true;
+        }
+        int result = PyObject_IsTrue(result_ob);
+        Py_DECREF(result_ob);
+        if (result < 0) {
+            return true;
+        }
+        if (self.size() != size || self.tag() != tag) {
+            PyErr_SetString(PyExc_RuntimeError, "jlist changed during comparison");
+            return true;
+        }
+        sink.push(ix, result);
+    }
+    return false;
+}
+
+/** Add `n` references to `ob`. The loop compiles down to a single add.
+ */
+void incref_n(PyObject* ob, Py_ssize_t n) {
+    for (Py_ssize_t ix = 0; ix < n; ++ix) {
+        Py_INCREF(ob);
+    }
+}
+
+/** Write the results of a comparison into a bool jlist.
+ */
+struct mask_sink {
+    std::vector<entry>& out;
+
+    template<typename P>
+    void loop(const std::vector<entry>& values, P pred) {
+        out.resize(values.size());
+        Py_ssize_t trues = 0;
+        for (std::size_t ix = 0; ix < values.size(); ++ix) {
+            bool result = pred(values[ix]);
+            out[ix].as_ob = result ? Py_True : Py_False;
+            trues += result;
+        }
+        incref_n(Py_True, trues);
+        incref_n(Py_False, values.size() - trues);
+    }
+
+    void push(Py_ssize_t, bool result) {
+        out.emplace_back().as_ob = box_value(result ? Py_True : Py_False);
+    }
+};
+
+/** Count the values for which a comparison is true.
+ */
+struct count_sink {
+    Py_ssize_t count = 0;
+
+    template<typename P>
+    void loop(const std::vector<entry>& values, P pred) {
+        Py_ssize_t total = 0;
+        for (entry e : values) {
+            total += pred(e);
+        }
+        count += total;
+    }
+
+    void push(Py_ssize_t, bool result) {
+        count += result;
+    }
+};
+}  // namespace detail
+
+template<int op>
+PyObject* compare_mask(PyObject* module, PyObject* args) {
+    static constexpr const char* names[] = {"lt", "le", "eq", "ne", "gt", "ge"};
+    PyObject* iterable;
+    PyObject* value;
+
+    if (!PyArg_UnpackTuple(args, names[op], 2, 2, &iterable, &value)) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    jlist* out = detail::new_jlist(module, entry_tag::unset);
+    if (!out) {
+        return nullptr;
+    }
+    if (self.size()) {
+        out->homogeneous_type_ptr(&PyBool_Type);
+        out->entries.reserve(self.size());
+    }
+    detail::mask_sink sink{out->entries};
+    if (detail::compare_to_scalar(self, op, value, sink)) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyDoc_STRVAR(lt_doc,
+             "lt(iterable, value)\n"
+             "\n"
+             "Return a bool jlist of whether each value is less than value.\n"
+             "\n"
+             "Equivalent to:  jlist(x < value for x in iterable)");
+
+PyDoc_STRVAR(le_doc,
+             "le(iterable, value)\n"
+             "\n"
+             "Return a bool jlist of whether each value is less than or equal to\n"
+             "value.\n"
+             "\n"
+             "Equivalent to:  jlist(x <= value for x in iterable)");
+
+PyDoc_STRVAR(eq_doc,
+             "eq(iterable, value)\n"
+             "\n"
+             "Return a bool jlist of whether each value is equal to value.\n"
+             "\n"
+             "Equivalent to:  jlist(x == value for x in iterable)");
+
+PyDoc_STRVAR(ne_doc,
+             "ne(iterable, value)\n"
+             "\n"
+             "Return a bool jlist of whether each value is not equal to value.\n"
+             "\n"
+             "Equivalent to:  jlist(x != value for x in iterable)");
+
+PyDoc_STRVAR(gt_doc,
+             "gt(iterable, value)\n"
+             "\n"
+             "Return a bool jlist of whether each value is greater than value.\n"
+             "\n"
+             "Equivalent to:  jlist(x > value for x in iterable)");
+
+PyDoc_STRVAR(ge_doc,
+             "ge(iterable, value)\n"
+             "\n"
+             "Return a bool jlist of whether each value is greater than or equal\n"
+             "to value.\n"
+             "\n"
+             "Equivalent to:  jlist(x >= value for x in iterable)");
+
+PyMethodDef lt_method = {"lt", compare_mask<Py_LT>, METH_VARARGS, lt_doc};
+PyMethodDef le_method = {"le", compare_mask<Py_LE>, METH_VARARGS, le_doc};
+PyMethodDef eq_method = {"eq", compare_mask<Py_EQ>, METH_VARARGS, eq_doc};
+PyMethodDef ne_method = {"ne", compare_mask<Py_NE>, METH_VARARGS, ne_doc};
+PyMethodDef gt_method = {"gt", compare_mask<Py_GT>, METH_VARARGS, gt_doc};
+PyMethodDef ge_method = {"ge", compare_mask<Py_GE>, METH_VARARGS, ge_doc};
+
+namespace detail {
+/** Parse a comparison operator, either a symbol like '<=' or a name like 'le'.
+    Returns -1 with an exception raised if `op_ob` isn't an operator.
+ */
+int parse_compare_op(PyObject* op_ob) {
+    static const std::array<std::pair<const char*, int>, 12> ops = {{
+        {"<", Py_LT},
+        {"<=", Py_LE},
+        {"==", Py_EQ},
+        {"!=", Py_NE},
+        {">", Py_GT},
+        {">=", Py_GE},
+        {"lt", Py_LT},
+        {"le", Py_LE},
+        {"eq", Py_EQ},
+        {"ne", Py_NE},
+        {"gt", Py_GT},
+        {"ge", Py_GE},
+    }};
+
+    if (PyUnicode_Check(op_ob)) {
+        const char* name = PyUnicode_AsUTF8(op_ob);
+        if (!name) {
+            return -1;
+        }
+        for (const auto& [op_name, op] : ops) {
+            if (!std::strcmp(op_name, name)) {
+                return op;
+            }
+        }
+    }
+    PyErr_Format(PyExc_ValueError,
+                 "op must be one of '<', '<=', '==', '!=', '>', or '>=', got %R",
+                 op_ob);
+    return -1;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(count_where_doc,
+             "count_where(iterable, op, value)\n"
+             "\n"
+             "Count the values x for which `x op value` is true, where op is one of\n"
+             "'<', '<=', '==', '!=', '>', or '>=' (or 'lt', 'le', 'eq', 'ne', 'gt',\n"
+             "or 'ge').\n"
+             "\n"
+             "Equivalent to:  sum(1 for x in iterable if x op value)");
+
+PyObject* count_where(PyObject* module, PyObject* args) {
+    PyObject* iterable;
+    PyObject* op_ob;
+    PyObject* value;
+
+    if (!PyArg_UnpackTuple(args, "count_where", 3, 3, &iterable, &op_ob, &value)) {
+        return nullptr;
+    }
+    int op = detail::parse_compare_op(op_ob);
+    if (op < 0) {
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    detail::count_sink sink;
+    if (detail::compare_to_scalar(self, op, value, sink)) {
+        return nullptr;
+    }
+    return PyLong_FromSsize_t(sink.count);
+}
+
+PyMethodDef count_where_method = {"count_where",
+                                  count_where,
+                                  METH_VARARGS,
+                                  count_where_doc};
+
+namespace detail {
+/** Sum `term(ix)` for `ix` in `[0, n)` into 8 independent accumulators. Splitting the
+    sum breaks the dependency between additions, so the loop vectorizes and the
+    multiply-adds in `term` compile to overlapping FMAs.
+ */
+template<typename F>
+double blocked_sum(std::size_t n, F&& term) {
+    constexpr std::size_t lanes = 8;
+    std::array<double, lanes> acc{};
+    std::size_t ix = 0;
+    for (; ix + lanes <= n; ix += lanes) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            acc[lane] += term(ix + lane);
+        }
+    }
+    for (std::size_t lane = 0; ix < n; ++ix, ++lane) {
+        acc[lane] += term(ix);
+    }
+    for (std::size_t width = lanes / 2; width; width /= 2) {
+        for (std::size_t lane = 0; lane < width; ++lane) {
+            acc[lane] += acc[lane + width];
+        }
+    }
+    return acc[0];
+}
+
+/** Call `f(T{})` with the unboxed type of a non-empty int or float list. Returns
+    `fallback()` for other lists.
+ */
+template<typename F, typename G>
+auto with_numeric_type(jlist& self, F&& f, G&& fallback) {
+    switch (self.tag()) {
+    case entry_tag::as_int:
+        return f(std::int64_t{});
+    case entry_tag::as_double:
+        return f(double{});
+    default:
+        return fallback();
+    }
+}
+
+/** Sum `combine(a[ix], b[ix])` over boxed values, starting from 0 like `sum`.
+ */
+template<typename F>
+PyObject* boxed_pairwise_sum(jlist& a, jlist& b, F&& combine) {
+    Py_ssize_t size = a.size();
+    PyObject* total = PyLong_FromLong(0);
+    if (!total) {
+        return nullptr;
+    }
+    for (Py_ssize_t ix = 0; ix < size; ++ix) {
+        if (a.size() != size || b.size() != size) {
+            Py_DECREF(total);
+            PyErr_SetString(PyExc_RuntimeError, "jlist changed size during iteration");
+            return nullptr;
+        }
+        PyObject* x = box_entry(a, a.entries[ix]);
+        PyObject* y = x ? box_entry(b, b.entries[ix]) : nullptr;
+        PyObject* term = y ? combine(x, y) : nullptr;
+        Py_XDECREF(x);
+        Py_XDECREF(y);
+        PyObject* next = term ? PyNumber_Add(total, term) : nullptr;
+        Py_XDECREF(term);
+        Py_DECREF(total);
+        if (!next) {
+            return nullptr;
+        }
+        total = next;
+    }
+    return total;
+}
+
+/** Parse two same-length lists for a pairwise reduction. Returns true with an
+    exception raised on failure.
+ */
+bool parse_pair(PyObject* module,
+                const char* name,
+                PyObject* args,
+                PyObject*& a_ob,
+                PyObject*& b_ob) {
+    PyObject* a_iterable;
+    PyObject* b_iterable;
+    if (!PyArg_UnpackTuple(args, name, 2, 2, &a_iterable, &b_iterable)) {
+        return true;
+    }
+    if (!(a_ob = as_jlist(module, a_iterable))) {
+        return true;
+    }
+    if (!(b_ob = as_jlist(module, b_iterable))) {
+        Py_DECREF(a_ob);
+        return true;
+    }
+    Py_ssize_t a_size = reinterpret_cast<jlist*>(a_ob)->size();
+    Py_ssize_t b_size = reinterpret_cast<jlist*>(b_ob)->size();
+    if (a_size != b_size) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s() arguments must be the same length, got %zd and %zd",
+                     name,
+                     a_size,
+                     b_size);
+        Py_DECREF(a_ob);
+        Py_DECREF(b_ob);
+        return true;
+    }
+    return false;
+}
+
+/** The dot product of two int lists, exact in 128 bits. Returns false if the sum
+    overflows.
+ */
+bool int_dot(const std::vector<entry>& a, const std::vector<entry>& b, __int128& out) {
+    out = 0;
+    for (std::size_t ix = 0; ix < a.size(); ++ix) {
+        __int128 product = static_cast<__int128>(a[ix].as_int) * b[ix].as_int;
+        if (__builtin_add_overflow(out, product, &out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** The squared distance between two int lists, exact in 128 bits. Returns false if
+    the sum overflows.
+ */
+bool int_sqdist(const std::vector<entry>& a, const std::vector<entry>& b, __int128& out) {
+    out = 0;
+    for (std::size_t ix = 0; ix < a.size(); ++ix) {
+        __int128 diff = static_cast<__int128>(a[ix].as_int) - b[ix].as_int;
+        if (diff < -(__int128{1} << 63) || diff > (__int128{1} << 63) ||
+            __builtin_add_overflow(out, diff * diff, &out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+double as_double(entry e) {
+    return static_cast<double>(entry_value<T>(e));
+}
+
+/** Reduce two same-length lists pairwise. Two int lists are reduced exactly with
+    `exact`; lists mixing ints and floats are reduced in doubles with `term`; anything
+    else is reduced over boxed values with `combine`.
+ */
+template<typename Exact, typename Term, typename Combine>
+PyObject* pairwise_reduce(jlist& a, jlist& b, Exact&& exact, Term&& term,
+                          Combine&& combine) {
+    if (!a.size()) {
+        return PyLong_FromLong(0);
+    }
+    if (a.tag() == entry_tag::as_int && b.tag() == entry_tag::as_int) {
+        __int128 result;
+        if (exact(a.entries, b.entries, result)) {
+            return box_int128(result);
+        }
+        return boxed_pairwise_sum(a, b, combine);
+    }
+
+    auto boxed = [&] { return boxed_pairwise_sum(a, b, combine); };
+    return with_numeric_type(
+        a,
+        [&](auto a_type) {
+            using A = decltype(a_type);
+            return with_numeric_type(
+                b,
+                [&](auto b_type) {
+                    using B = decltype(b_type);
+                    double result = blocked_sum(a.entries.size(), [&](std::size_t ix) {
+                        return term(as_double<A>(a.entries[ix]),
+                                    as_double<B>(b.entries[ix]));
+                    });
+                    return PyFloat_FromDouble(result);
+                },
+                boxed);
+        },
+        boxed);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(dot_doc,
+             "dot(a, b)\n"
+             "\n"
+             "Return the dot product of two iterables of the same length. ints are\n"
+             "multiplied exactly; floats are summed in several partial sums at once,\n"
+             "so the result may differ from a sequential sum in the last bits.\n"
+             "\n"
+             "Equivalent to:  sum(x * y for x, y in zip(a, b))");
+
+PyObject* dot(PyObject* module, PyObject* args) {
+    PyObject* a_ob;
+    PyObject* b_ob;
+    if (detail::parse_pair(module, "dot", args, a_ob, b_ob)) {
+        return nullptr;
+    }
+    scope_guard decref_lists([&] {
+        Py_DECREF(a_ob);
+        Py_DECREF(b_ob);
+    });
+
+    return detail::pairwise_reduce(
+        *reinterpret_cast<jlist*>(a_ob),
+        *reinterpret_cast<jlist*>(b_ob),
+        detail::int_dot,
+        [](double x, double y) { return x * y; },
+        PyNumber_Multiply);
+}
+
+PyMethodDef dot_method = {"dot", dot, METH_VARARGS, dot_doc};
+
+PyDoc_STRVAR(sqdist_doc,
+             "sqdist(a, b)\n"
+             "\n"
+             "Return the squared Euclidean distance between two iterables of the same\n"
+             "length.\n"
+             "\n"
+             "Equivalent to:  sum((x - y) ** 2 for x, y in zip(a, b))");
+
+PyObject* sqdist(PyObject* module, PyObject* args) {
+    PyObject* a_ob;
+    PyObject* b_ob;
+    if (detail::parse_pair(module, "sqdist", args, a_ob, b_ob)) {
+        return nullptr;
+    }
+    scope_guard decref_lists([&] {
+        Py_DECREF(a_ob);
+        Py_DECREF(b_ob);
+    });
+
+    return detail::pairwise_reduce(
+        *reinterpret_cast<jlist*>(a_ob),
+        *reinterpret_cast<jlist*>(b_ob),
+        detail::int_sqdist,
+        [](double x, double y) { return (x - y) * (x - y); },
+        [](PyObject* x, PyObject* y) -> PyObject* {
+            PyObject* diff = PyNumber_Subtract(x, y);
+            if (!diff) {
+                return nullptr;
+            }
+            PyObject* out = PyNumber_Multiply(diff, diff);
+            Py_DECREF(diff);
+            return out;
+        });
+}
+
+PyMethodDef sqdist_method = {"sqdist", sqdist, METH_VARARGS, sqdist_doc};
+
+namespace detail {
+template<typename T>
+double max_abs(const std::vector<entry>& values) {
+    double out = 0;
+    for (entry e : values) {
+        double value = std::abs(as_double<T>(e));
+        if (std::isnan(value)) {
+            return value;
+        }
+        out = std::max(out, value);
+    }
+    return out;
+}
+
+/** The `ord`-norm of an int or float list. When the sum of powers overflows or
+    underflows, the values are scaled by the largest magnitude and the sum is redone.
+ */
+template<typename T>
+double norm(const std::vector<entry>& values, double ord) {
+    if (std::isinf(ord)) {
+        return max_abs<T>(values);
+    }
+    auto magnitude = [&](std::size_t ix) { return std::abs(as_double<T>(values[ix])); };
+    if (ord == 1) {
+        return blocked_sum(values.size(), magnitude);
+    }
+
+    auto root_of_sum = [&](double scale) {
+        if (ord == 2) {
+            return std::sqrt(blocked_sum(values.size(), [&](std::size_t ix) {
+                double value = magnitude(ix) / scale;
+                return value * value;
+            }));
+        }
+        return std::pow(blocked_sum(values.size(),
+                                    [&](std::size_t ix) {
+                                        return std::pow(magnitude(ix) / scale, ord);
+                                    }),
+                        1 / ord);
+    };
+
+    double out = root_of_sum(1);
+    if (std::isfinite(out) && out >= std::numeric_limits<double>::min()) {
+        return out;
+    }
+    double scale = max_abs<T>(values);
+    if (scale == 0 || !std::isfinite(scale)) {
+        return scale;
+    }
+    return scale * root_of_sum(scale);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(norm_doc,
+             "norm(iterable, ord=2)\n"
+             "\n"
+             "Return the ord-norm of an iterable of numbers as a float: the\n"
+             "sum of the absolute values raised to ord, to the power of 1 / ord. ord\n"
+             "must be positive; ord=inf gives the largest absolute value.\n"
+             "\n"
+             "Equivalent to:  math.hypot(*iterable)  (for ord=2)");
+
+PyObject* norm(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"iterable", "ord", nullptr};
+    PyObject* iterable;
+    double ord = 2;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|d:norm",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &ord)) {
+        return nullptr;
+    }
+    if (!(ord > 0)) {
+        PyErr_SetString(PyExc_ValueError, "norm() ord must be positive");
+        return nullptr;
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (!self.size()) {
+        return PyFloat_FromDouble(0);
+    }
+    return detail::with_numeric_type(
+        self,
+        [&](auto type) {
+            using T = decltype(type);
+            return PyFloat_FromDouble(detail::norm<T>(self.entries, ord));
+        },
+        [&]() -> PyObject* {
+            // convert objects like a mix of ints and floats to doubles first
+            Py_ssize_t size = self.size();
+            std::vector<entry> values(size);
+            for (Py_ssize_t ix = 0; ix < size; ++ix) {
+                double value = PyFloat_AsDouble(self.entries[ix].as_ob);
+                if ((value == -1 && PyErr_Occurred()) ||
+                    detail::changed_during_compare(self, size)) {
+                    return nullptr;
+                }
+                values[ix].as_double = value;
+            }
+            return PyFloat_FromDouble(detail::norm<double>(values, ord));
+        });
+}
+
+PyMethodDef norm_method = {"norm",
+                           unsafe_cast_to_pycfunction(norm),
+                           METH_VARARGS | METH_KEYWORDS,
+                           norm_doc};
+
+namespace detail {
+/** Check the `out` argument of an elementwise op. Returns true with an exception
+    raised if it isn't None or a jlist.
+ */
+bool parse_out(PyObject* module, PyObject*& out_ob) {
+    if (out_ob == Py_None) {
+        out_ob = nullptr;
+    }
+    if (out_ob && !is_jlist(module, out_ob)) {
+        PyErr_Format(PyExc_TypeError,
+                     "out must be a jlist, got %.200s",
+                     Py_TYPE(out_ob)->tp_name);
+        return true;
+    }
+    return false;
+}
+
+/** Return `results`, or move them into `out_ob` and return it if one was given.
+    Steals the reference to `results`.
+ */
+PyObject* store_results(PyObject* out_ob, jlist* results) {
+    if (!out_ob || out_ob == reinterpret_cast<PyObject*>(results)) {
+        return reinterpret_cast<PyObject*>(results);
+    }
+    jlist& out = *reinterpret_cast<jlist*>(out_ob);
+    out.invalidate_index();
+    std::swap(out.entries, results->entries);
+    std::swap(out.tagged_ptr, results->tagged_ptr);
+    // releases the previous contents of `out`
+    Py_DECREF(results);
+    Py_INCREF(out_ob);
+    return out_ob;
+}
+
+/** Map the unboxed values of `self` with `f` into `out_ob`, or a new jlist. Writes go
+    straight into `out_ob` when it is unboxed, so `out_ob` may be `self`.
+
+    `check` must be true for every value that `f` handles exactly like the Python
+    function; if it is false for any value, nothing is written and this returns false
+    so the caller can fall back to the boxed op. Otherwise `result` is set to a new
+    reference to the results, or nullptr with an exception raised.
+ */
+template<typename In, typename Out, typename Check, typename F>
+bool unboxed_map(PyObject* module,
+                 jlist& self,
+                 PyObject* out_ob,
+                 Check&& check,
+                 F&& f,
+                 PyObject*& result) {
+    for (entry e : self.entries) {
+        if (!check(entry_value<In>(e))) {
+            return false;
+        }
+    }
+
+    constexpr entry_tag out_tag =
+        std::is_same_v<Out, double> ? entry_tag::as_double : entry_tag::as_int;
+    jlist* target;
+    if (out_ob && !reinterpret_cast<jlist*>(out_ob)->boxed()) {
+        target = reinterpret_cast<jlist*>(out_ob);
+        target->invalidate_index();
+        Py_INCREF(out_ob);
+    }
+    else if (!(target = new_jlist(module, out_tag))) {
+        result = nullptr;
+        return true;
+    }
+
+    std::size_t size = self.entries.size();
+    target->entries.resize(size);
+    for (std::size_t ix = 0; ix < size; ++ix) {
+        entry_value<Out>(target->entries[ix]) = f(entry_value<In>(self.entries[ix]));
+    }
+    target->tag(size ? out_tag : entry_tag::unset);
+    result = store_results(out_ob, target);
+    return true;
+}
+
+/** Apply `call` to each value of `self`, which returns a new reference to the result
+    or nullptr with an exception raised.
+ */
+template<typename F>
+jlist* boxed_map(PyObject* module, jlist& self, F&& call) {
+    jlist* out = new_jlist(module, entry_tag::unset);
+    if (!out) {
+        return nullptr;
+    }
+    // `call` may run code which changes `self`, so its size and tag are re-read
+    for (Py_ssize_t ix = 0; ix < self.size(); ++ix) {
+        PyObject* value = box_entry(self, self.entries[ix]);
+        PyObject* result = value ? call(value) : nullptr;
+        Py_XDECREF(value);
+        if (!result || append_value(reinterpret_cast<PyObject*>(out), result)) {
+            Py_XDECREF(result);
+            Py_DECREF(out);
+            return nullptr;
+        }
+        Py_DECREF(result);
+    }
+    return out;
+}
+
+/** Run an elementwise op. Int and float lists first try `unboxed(type, result)`,
+    which returns false if it can't match the Python op exactly; everything else goes
+    through `boxed(value)`.
+ */
+template<typename Unboxed, typename Boxed>
+PyObject* elementwise(PyObject* module,
+                      PyObject* iterable,
+                      PyObject* out_ob,
+                      Unboxed&& unboxed,
+                      Boxed&& boxed) {
+    if (parse_out(module, out_ob)) {
+        return nullptr;
+    }
+    PyObject* list_ob = as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    PyObject* result;
+    if (with_numeric_type(
+            self,
+            [&](auto type) { return unboxed(self, type, result); },
+            [] { return false; })) {
+        return result;
+    }
+    jlist* results = boxed_map(module, self, boxed);
+    if (!results) {
+        return nullptr;
+    }
+    return store_results(out_ob, results);
+}
+
+/** Parse `(iterable, *, out=None)`. Returns true with an exception raised on failure.
+ */
+bool parse_unary(const char* format,
+                 PyObject* args,
+                 PyObject* kwargs,
+                 PyObject*& iterable,
+                 PyObject*& out_ob) {
+    static const char* keywords[] = {"iterable", "out", nullptr};
+    out_ob = nullptr;
+    return !PyArg_ParseTupleAndKeywords(args,
+                                        kwargs,
+                                        format,
+                                        const_cast<char**>(keywords),
+                                        &iterable,
+                                        &out_ob);
+}
+
+/** A unary op on floats which has a Python counterpart in the math module.
+ */
+template<typename Check, typename F>
+PyObject* float_function(PyObject* module,
+                         const char* format,
+                         PyObject* math_function,
+                         PyObject* args,
+                         PyObject* kwargs,
+                         Check&& check,
+                         F&& f) {
+    PyObject* iterable;
+    PyObject* out_ob;
+    if (parse_unary(format, args, kwargs, iterable, out_ob)) {
+        return nullptr;
+    }
+    return elementwise(
+        module,
+        iterable,
+        out_ob,
+        [&](jlist& self, auto type, PyObject*& result) {
+            using T = decltype(type);
+            return unboxed_map<T, double>(
+                module,
+                self,
+                out_ob,
+                [&](T value) { return check(static_cast<double>(value)); },
+                [&](T value) { return f(static_cast<double>(value)); },
+                result);
+        },
+        [&](PyObject* value) {
+            return PyObject_CallFunctionObjArgs(math_function, value, nullptr);
+        });
+}
+}  // namespace detail
+
+PyDoc_STRVAR(abs_doc,
+             "abs(iterable, *, out=None)\n"
+             "\n"
+             "Return the absolute value of each value. If out is given, the results\n"
+             "replace its contents and it is returned; out may be the input list.\n"
+             "\n"
+             "Equivalent to:  jlist(map(abs, iterable))");
+
+PyObject* abs(PyObject* module, PyObject* args, PyObject* kwargs) {
+    PyObject* iterable;
+    PyObject* out_ob;
+    if (detail::parse_unary("O|$O:abs", args, kwargs, iterable, out_ob)) {
+        return nullptr;
+    }
+    return detail::elementwise(
+        module,
+        iterable,
+        out_ob,
+        [&](jlist& self, auto type, PyObject*& result) {
+            using T = decltype(type);
+            return detail::unboxed_map<T, T>(
+                module,
+                self,
+                out_ob,
+                [](T value) { return value != std::numeric_limits<T>::lowest() ||
+                                     std::is_same_v<T, double>; },
+                [](T value) { return std::abs(value); },
+                result);
+        },
+        PyNumber_Absolute);
+}
+
+PyMethodDef abs_method = {"abs",
+                          unsafe_cast_to_pycfunction(abs),
+                          METH_VARARGS | METH_KEYWORDS,
+                          abs_doc};
+
+PyDoc_STRVAR(sqrt_doc,
+             "sqrt(iterable, *, out=None)\n"
+             "\n"
+             "Return the square root of each value as a float. If out is given, the\n"
+             "results replace its contents and it is returned.\n"
+             "\n"
+             "Equivalent to:  jlist(map(math.sqrt, iterable))");
+
+PyObject* sqrt(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    return detail::float_function(
+        module,
+        "O|$O:sqrt",
+        state->math_sqrt,
+        args,
+        kwargs,
+        [](double value) { return !(value < 0); },
+        [](double value) { return std::sqrt(value); });
+}
+
+PyMethodDef sqrt_method = {"sqrt",
+                           unsafe_cast_to_pycfunction(sqrt),
+                           METH_VARARGS | METH_KEYWORDS,
+                           sqrt_doc};
+
+PyDoc_STRVAR(log_doc,
+             "log(iterable, *, out=None)\n"
+             "\n"
+             "Return the natural logarithm of each value as a float. If out is given,\n"
+             "the results replace its contents and it is returned.\n"
+             "\n"
+             "Equivalent to:  jlist(map(math.log, iterable))");
+
+PyObject* log(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    return detail::float_function(
+        module,
+        "O|$O:log",
+        state->math_log,
+        args,
+        kwargs,
+        [](double value) { return !(value <= 0); },
+        [](double value) { return std::log(value); });
+}
+
+PyMethodDef log_method = {"log",
+                          unsafe_cast_to_pycfunction(log),
+                          METH_VARARGS | METH_KEYWORDS,
+                          log_doc};
+
+PyDoc_STRVAR(exp_doc,
+             "exp(iterable, *, out=None)\n"
+             "\n"
+             "Return e raised to the power of each value as a float. If out is given,\n"
+             "the results replace its contents and it is returned.\n"
+             "\n"
+             "Equivalent to:  jlist(map(math.exp, iterable))");
+
+PyObject* exp(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    // the largest finite value whose exp doesn't overflow; math.exp raises past it
+    constexpr double max_exp = 709.782712893384;
+    return detail::float_function(
+        module,
+        "O|$O:exp",
+        state->math_exp,
+        args,
+        kwargs,
+        [](double value) { return !(value > max_exp) || std::isinf(value); },
+        [](double value) { return std::exp(value); });
+}
+
+PyMethodDef exp_method = {"exp",
+                          unsafe_cast_to_pycfunction(exp),
+                          METH_VARARGS | METH_KEYWORDS,
+                          exp_doc};
+
+namespace detail {
+/** Whether a double rounded to an integer fits in an int64.
+ */
+bool fits_int64(double value) {
+    return value >= -0x1p63 && value < 0x1p63;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(floor_doc,
+             "floor(iterable, *, out=None)\n"
+             "\n"
+             "Return the floor of each value as an int. If out is given, the results\n"
+             "replace its contents and it is returned.\n"
+             "\n"
+             "Equivalent to:  jlist(map(math.floor, iterable))");
+
+PyObject* floor(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    PyObject* iterable;
+    PyObject* out_ob;
+    if (detail::parse_unary("O|$O:floor", args, kwargs, iterable, out_ob)) {
+        return nullptr;
+    }
+    return detail::elementwise(
+        module,
+        iterable,
+        out_ob,
+        [&](jlist& self, auto type, PyObject*& result) {
+            using T = decltype(type);
+            if constexpr (std::is_same_v<T, std::int64_t>) {
+                return detail::unboxed_map<T, T>(
+                    module,
+                    self,
+                    out_ob,
+                    [](T) { return true; },
+                    [](T value) { return value; },
+                    result);
+            }
+            else {
+                return detail::unboxed_map<T, std::int64_t>(
+                    module,
+                    self,
+                    out_ob,
+                    [](T value) { return detail::fits_int64(std::floor(value)); },
+                    [](T value) { return static_cast<std::int64_t>(std::floor(value)); },
+                    result);
+            }
+        },
+        [&](PyObject* value) {
+            return PyObject_CallFunctionObjArgs(state->math_floor, value, nullptr);
+        });
+}
+
+PyMethodDef floor_method = {"floor",
+                            unsafe_cast_to_pycfunction(floor),
+                            METH_VARARGS | METH_KEYWORDS,
+                            floor_doc};
+
+namespace detail {
+constexpr std::array<double, 23> powers_of_10 = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/** Scale `value` by 10 ** ndigits, and set `error` to the exact difference between
+    the scaled value and the result, which `fma` computes without rounding.
+ */
+double scale_by_10(double value, Py_ssize_t ndigits, double& error) {
+    double power = powers_of_10[std::abs(ndigits)];
+    if (ndigits >= 0) {
+        double scaled = value * power;
+        error = std::fma(value, power, -scaled);
+        return scaled;
+    }
+    double scaled = value / power;
+    // the sign of the division's remainder is the sign of the error
+    error = std::fma(-scaled, power, value);
+    return scaled;
+}
+
+/** Whether `round_digits` matches `round(value, ndigits)`: the power of 10 must be an
+    exact double, and the scaled value must be small enough that its halves are exact.
+ */
+bool can_round_digits(double value, Py_ssize_t ndigits) {
+    if (!std::isfinite(value)) {
+        return true;
+    }
+    if (std::abs(ndigits) >= static_cast<Py_ssize_t>(powers_of_10.size())) {
+        return false;
+    }
+    double error;
+    return std::abs(scale_by_10(value, ndigits, error)) < 0x1p52;
+}
+
+/** Round a double to `ndigits` decimal digits, with ties going to even like `round`.
+    The decision is made on the exact decimal value of `value`, so 2.675 rounds down
+    to 2.67 because it is stored as 2.67499999...
+ */
+double round_digits(double value, Py_ssize_t ndigits) {
+    if (!std::isfinite(value)) {
+        return value;
+    }
+    double error;
+    double scaled = scale_by_10(value, ndigits, error);
+    double rounded = std::nearbyint(scaled);
+    if (std::abs(scaled - rounded) == 0.5 && error) {
+        // a tie after scaling, but the exact value is on one side of it
+        rounded = scaled + std::copysign(0.5, error);
+    }
+    double power = powers_of_10[std::abs(ndigits)];
+    return (ndigits >= 0) ? rounded / power : rounded * power;
+}
+
+/** Round an int to a multiple of 10 ** -ndigits, with ties going to even. Returns
+    false if the result might not fit.
+ */
+bool can_round_int(std::int64_t value, Py_ssize_t ndigits) {
+    if (ndigits >= 0) {
+        return true;
+    }
+    if (-ndigits > 18) {
+        return false;
+    }
+    std::int64_t power = powers_of_10[-ndigits];
+    return value > std::numeric_limits<std::int64_t>::min() + power &&
+           value < std::numeric_limits<std::int64_t>::max() - power;
+}
+
+std::int64_t round_int(std::int64_t value, Py_ssize_t ndigits) {
+    if (ndigits >= 0) {
+        return value;
+    }
+    std::int64_t power = powers_of_10[-ndigits];
+    std::int64_t quotient = value / power;
+    std::int64_t remainder = value % power;
+    if (remainder < 0) {
+        remainder += power;
+        quotient -= 1;
+    }
+    if (2 * remainder > power || (2 * remainder == power && (quotient & 1))) {
+        quotient += 1;
+    }
+    return quotient * power;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(round_doc,
+             "round(iterable, ndigits=None, *, out=None)\n"
+             "\n"
+             "Round each value to ndigits decimal digits, with ties going to even.\n"
+             "Without ndigits, floats are rounded to ints. If out is given, the results\n"
+             "replace its contents and it is returned.\n"
+             "\n"
+             "Equivalent to:  jlist(round(x, ndigits) for x in iterable)");
+
+PyObject* round(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    static const char* keywords[] = {"iterable", "ndigits", "out", nullptr};
+    PyObject* iterable;
+    PyObject* ndigits_ob = Py_None;
+    PyObject* out_ob = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|O$O:round",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &ndigits_ob,
+                                     &out_ob)) {
+        return nullptr;
+    }
+    Py_ssize_t ndigits = 0;
+    if (ndigits_ob != Py_None) {
+        ndigits = PyNumber_AsSsize_t(ndigits_ob, nullptr);
+        if (ndigits == -1 && PyErr_Occurred()) {
+            return nullptr;
+        }
+        // a huge ndigits saturates at PY_SSIZE_T_MIN or MAX, which can't be negated;
+        // anything past the powers of 10 is rounded by `round` with ndigits_ob anyway
+        ndigits = std::clamp<Py_ssize_t>(ndigits, -1000, 1000);
+    }
+
+    return detail::elementwise(
+        module,
+        iterable,
+        out_ob,
+        [&](jlist& self, auto type, PyObject*& result) {
+            using T = decltype(type);
+            if constexpr (std::is_same_v<T, std::int64_t>) {
+                return detail::unboxed_map<T, T>(
+                    module,
+                    self,
+                    out_ob,
+                    [&](T value) { return detail::can_round_int(value, ndigits); },
+                    [&](T value) { return detail::round_int(value, ndigits); },
+                    result);
+            }
+            else if (ndigits_ob == Py_None) {
+                return detail::unboxed_map<T, std::int64_t>(
+                    module,
+                    self,
+                    out_ob,
+                    [](T value) { return detail::fits_int64(std::nearbyint(value)); },
+                    [](T value) {
+                        return static_cast<std::int64_t>(std::nearbyint(value));
+                    },
+                    result);
+            }
+            else {
+                return detail::unboxed_map<T, T>(
+                    module,
+                    self,
+                    out_ob,
+                    [&](T value) { return detail::can_round_digits(value, ndigits); },
+                    [&](T value) { return detail::round_digits(value, ndigits); },
+                    result);
+            }
+        },
+        [&](PyObject* value) {
+            if (ndigits_ob == Py_None) {
+                return PyObject_CallFunctionObjArgs(state->builtin_round, value, nullptr);
+            }
+            return PyObject_CallFunctionObjArgs(state->builtin_round,
+                                                value,
+                                                ndigits_ob,
+                                                nullptr);
+        });
+}
+
+PyMethodDef round_method = {"round",
+                            unsafe_cast_to_pycfunction(round),
+                            METH_VARARGS | METH_KEYWORDS,
+                            round_doc};
+
+namespace detail {
+/** Parse a bound of `clip` as a double, or an infinity for None. Returns false if the
+    bound isn't a float or an int which converts to a double exactly.
+ */
+bool clip_bound(PyObject* bound, double none, double& out) {
+    if (bound == Py_None) {
+        out = none;
+        return true;
+    }
+    if (PyFloat_CheckExact(bound)) {
+        out = PyFloat_AS_DOUBLE(bound);
+        return true;
+    }
+    auto as_int = maybe_unbox<std::int64_t>(bound);
+    if (as_int && -(std::int64_t{1} << 53) <= *as_int &&
+        *as_int <= (std::int64_t{1} << 53)) {
+        out = *as_int;
+        return true;
+    }
+    return false;
+}
+
+/** Parse a bound of `clip` on an int list, or the int64 limit for None. Returns false
+    if the bound isn't an int which fits in an int64.
+ */
+bool clip_bound(PyObject* bound, std::int64_t none, std::int64_t& out) {
+    if (bound == Py_None) {
+        out = none;
+        return true;
+    }
+    auto as_int = maybe_unbox<std::int64_t>(bound);
+    if (as_int) {
+        out = *as_int;
+    }
+    return as_int.has_value();
+}
+
+template<typename T>
+T clip_value(T value, T low, T high) {
+    // the same comparisons as min(max(value, low), high), so NaNs are kept
+    value = (low > value) ? low : value;
+    return (high < value) ? high : value;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(clip_doc,
+             "clip(iterable, lo=None, hi=None, *, out=None)\n"
+             "\n"
+             "Limit each value to the range [lo, hi]; a bound of None is unbounded.\n"
+             "Unlike min and max, floats clipped to int bounds stay floats. If out is\n"
+             "given, the results replace its contents and it is returned.\n"
+             "\n"
+             "Equivalent to:  jlist(min(max(x, lo), hi) for x in iterable)");
+
+PyObject* clip(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"iterable", "lo", "hi", "out", nullptr};
+    PyObject* iterable;
+    PyObject* low_ob = Py_None;
+    PyObject* high_ob = Py_None;
+    PyObject* out_ob = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|OO$O:clip",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &low_ob,
+                                     &high_ob,
+                                     &out_ob)) {
+        return nullptr;
+    }
+
+    return detail::elementwise(
+        module,
+        iterable,
+        out_ob,
+        [&](jlist& self, auto type, PyObject*& result) {
+            using T = decltype(type);
+            if constexpr (std::is_same_v<T, std::int64_t>) {
+                std::int64_t low;
+                std::int64_t high;
+                if (!detail::clip_bound(low_ob, std::numeric_limits<T>::min(), low) ||
+                    !detail::clip_bound(high_ob, std::numeric_limits<T>::max(), high)) {
+                    // min and max would mix the float bounds in with the ints
+                    return false;
+                }
+                return detail::unboxed_map<T, T>(
+                    module,
+                    self,
+                    out_ob,
+                    [](T) { return true; },
+                    [&](T value) { return detail::clip_value(value, low, high); },
+                    result);
+            }
+            else {
+                constexpr double inf = std::numeric_limits<double>::infinity();
+                double low;
+                double high;
+                if (!detail::clip_bound(low_ob, -inf, low) ||
+                    !detail::clip_bound(high_ob, inf, high)) {
+                    return false;
+                }
+                return detail::unboxed_map<T, T>(
+                    module,
+                    self,
+                    out_ob,
+                    [](T) { return true; },
+                    [&](T value) { return detail::clip_value(value, low, high); },
+                    result);
+            }
+        },
+        [&](PyObject* value) -> PyObject* {
+            std::pair<PyObject*, int> bounds[] = {{low_ob, Py_GT}, {high_ob, Py_LT}};
+            for (auto [bound, op] : bounds) {
+                if (bound == Py_None) {
+                    continue;
+                }
+                int r = PyObject_RichCompareBool(bound, value, op);
+                if (r < 0) {
+                    return nullptr;
+                }
+                if (r) {
+                    value = bound;
+                }
+            }
+            Py_INCREF(value);
+            return value;
+        });
+}
+
+PyMethodDef clip_method = {"clip",
+                           unsafe_cast_to_pycfunction(clip),
+                           METH_VARARGS | METH_KEYWORDS,
+                           clip_doc};
+
+namespace detail {
+enum class rounding_mode {
+    trunc,
+    floor,
+    ceil,
+    nearest,
+};
+
+/** Parse the `rounding` argument of `astype`. Returns true with an exception raised
+    if it isn't one of the modes.
+ */
+bool parse_rounding(const char* name, rounding_mode& out) {
+    std::pair<const char*, rounding_mode> modes[] = {
+        {"trunc", rounding_mode::trunc},
+        {"floor", rounding_mode::floor},
+        {"ceil", rounding_mode::ceil},
+        {"nearest", rounding_mode::nearest},
+    };
+    for (auto [mode_name, mode] : modes) {
+        if (!std::strcmp(name, mode_name)) {
+            out = mode;
+            return false;
+        }
+    }
+    PyErr_Format(PyExc_ValueError,
+                 "rounding must be one of 'trunc', 'floor', 'ceil', or 'nearest', "
+                 "got '%s'",
+                 name);
+    return true;
+}
+
+template<rounding_mode mode>
+double round_to_integer(double value) {
+    if constexpr (mode == rounding_mode::trunc) {
+        return std::trunc(value);
+    }
+    else if constexpr (mode == rounding_mode::floor) {
+        return std::floor(value);
+    }
+    else if constexpr (mode == rounding_mode::ceil) {
+        return std::ceil(value);
+    }
+    else {
+        return std::nearbyint(value);
+    }
+}
+
+/** Call `f(std::integral_constant<rounding_mode, mode>{})`.
+ */
+template<typename F>
+auto with_rounding_mode(rounding_mode mode, F&& f) {
+    switch (mode) {
+    case rounding_mode::trunc:
+        return f(std::integral_constant<rounding_mode, rounding_mode::trunc>{});
+    case rounding_mode::floor:
+        return f(std::integral_constant<rounding_mode, rounding_mode::floor>{});
+    case rounding_mode::ceil:
+        return f(std::integral_constant<rounding_mode, rounding_mode::ceil>{});
+    case rounding_mode::nearest:
+        return f(std::integral_constant<rounding_mode, rounding_mode::nearest>{});
+    default:
+        __builtin_unreachable();
+    }
+}
+
+/** Return a new jlist with the same values as `list_ob`.
+ */
+PyObject* copy_jlist(PyObject* module, PyObject* list_ob) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    return PyObject_CallFunctionObjArgs(reinterpret_cast<PyObject*>(state->jlist_type),
+                                        list_ob,
+                                        nullptr);
+}
+
+/** Box each value of an unboxed list into a new object list in one pass.
+ */
+template<typename T>
+PyObject* box_all(PyObject* module, jlist& self) {
+    jlist* out = new_jlist(module, entry_tag::unset);
+    if (!out) {
+        return nullptr;
+    }
+    if (!self.entries.size()) {
+        return reinterpret_cast<PyObject*>(out);
+    }
+    out->homogeneous_type_ptr(entry_pytype<T>);
+    out->entries.reserve(self.entries.size());
+    for (entry e : self.entries) {
+        PyObject* value = box_value(entry_value<T>(e));
+        if (!value) {
+            Py_DECREF(out);
+            return nullptr;
+        }
+        out->entries.push_back(entry{value});
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(astype_doc,
+             "astype(iterable, dtype, *, rounding=None)\n"
+             "\n"
+             "Return a new jlist with each value converted to dtype, which is one of\n"
+             "'double', 'int', or 'object'. 'double' converts with float, and 'int'\n"
+             "converts with the rounding mode: 'trunc' (the default, like int),\n"
+             "'floor', 'ceil', or 'nearest' (like round). 'object' keeps the values\n"
+             "but stores them boxed. ints and floats are converted without boxing.\n"
+             "\n"
+             "Equivalent to:  jlist(map(float, iterable))\n"
+             "                jlist(map(int, iterable))\n"
+             "                jlist(map(math.floor, iterable))\n"
+             "                jlist(map(math.ceil, iterable))\n"
+             "                jlist(map(round, iterable))");
+
+PyObject* astype(PyObject* module, PyObject* args, PyObject* kwargs) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(module));
+    static const char* keywords[] = {"iterable", "dtype", "rounding", nullptr};
+    PyObject* iterable;
+    const char* dtype;
+    const char* rounding_name = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "Os|$z:astype",
+                                     const_cast<char**>(keywords),
+                                     &iterable,
+                                     &dtype,
+                                     &rounding_name)) {
+        return nullptr;
+    }
+
+    entry_tag target;
+    if (!std::strcmp(dtype, "double")) {
+        target = entry_tag::as_double;
+    }
+    else if (!std::strcmp(dtype, "int")) {
+        target = entry_tag::as_int;
+    }
+    else if (!std::strcmp(dtype, "object")) {
+        target = entry_tag::as_homogeneous_ob;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "dtype must be one of 'double', 'int', or 'object', got '%s'",
+                     dtype);
+        return nullptr;
+    }
+
+    detail::rounding_mode rounding = detail::rounding_mode::trunc;
+    if (rounding_name) {
+        if (target != entry_tag::as_int) {
+            PyErr_SetString(PyExc_ValueError, "rounding only applies to dtype='int'");
+            return nullptr;
+        }
+        if (detail::parse_rounding(rounding_name, rounding)) {
+            return nullptr;
+        }
+    }
+
+    PyObject* list_ob = detail::as_jlist(module, iterable);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    // a list built from `iterable` isn't visible to anyone else, so it can be reused
+    bool owned = list_ob != iterable;
+    auto unchanged = [&] {
+        if (owned) {
+            Py_INCREF(list_ob);
+            return list_ob;
+        }
+        return detail::copy_jlist(module, list_ob);
+    };
+    auto convert = [&](PyObject* function) -> PyObject* {
+        return reinterpret_cast<PyObject*>(
+            detail::boxed_map(module, self, [&](PyObject* value) {
+                return PyObject_CallFunctionObjArgs(function, value, nullptr);
+            }));
+    };
+
+    if (self.tag() == entry_tag::unset || (self.boxed() && target == self.tag())) {
+        return unchanged();
+    }
+    PyObject* result;
+    switch (target) {
+    case entry_tag::as_double:
+        if (self.tag() == entry_tag::as_double) {
+            return unchanged();
+        }
+        if (self.tag() == entry_tag::as_int) {
+            detail::unboxed_map<std::int64_t, double>(
+                module,
+                self,
+                owned ? list_ob : nullptr,
+                [](std::int64_t) { return true; },
+                [](std::int64_t value) { return static_cast<double>(value); },
+                result);
+            return result;
+        }
+        return convert(reinterpret_cast<PyObject*>(&PyFloat_Type));
+    case entry_tag::as_int:
+        if (self.tag() == entry_tag::as_int) {
+            return unchanged();
+        }
+        if (self.tag() == entry_tag::as_double &&
+            detail::with_rounding_mode(rounding, [&](auto mode) {
+                return detail::unboxed_map<double, std::int64_t>(
+                    module,
+                    self,
+                    owned ? list_ob : nullptr,
+                    [](double value) {
+                        return detail::fits_int64(
+                            detail::round_to_integer<decltype(mode)::value>(value));
+                    },
+                    [](double value) {
+                        return static_cast<std::int64_t>(
+                            detail::round_to_integer<decltype(mode)::value>(value));
+                    },
+                    result);
+            })) {
+            return result;
+        }
+        switch (rounding) {
+        case detail::rounding_mode::trunc:
+            return convert(reinterpret_cast<PyObject*>(&PyLong_Type));
+        case detail::rounding_mode::floor:
+            return convert(state->math_floor);
+        case detail::rounding_mode::ceil:
+            return convert(state->math_ceil);
+        case detail::rounding_mode::nearest:
+            return convert(state->builtin_round);
+        default:
+            __builtin_unreachable();
+        }
+    default:
+        if (self.tag() == entry_tag::as_int) {
+            return detail::box_all<std::int64_t>(module, self);
+        }
+        if (self.tag() == entry_tag::as_double) {
+            return detail::box_all<double>(module, self);
+        }
+        return unchanged();
+    }
+}
+
+PyMethodDef astype_method = {"astype",
+                             unsafe_cast_to_pycfunction(astype),
+                             METH_VARARGS | METH_KEYWORDS,
+                             astype_doc};
+
+namespace detail {
+/** xoshiro256** run as `lanes` independent streams side by side. Each state word is
+    kept for all of the streams at once, so filling a block is a handful of vector
+    instructions instead of a dependent chain per value.
+ */
+class xoshiro256 {
+public:
+    constexpr static std::size_t lanes = 4;
+
+private:
+    std::array<std::array<std::uint64_t, lanes>, 4> m_state;
+    std::array<std::uint64_t, lanes> m_buffer;
+    std::size_t m_buffered = 0;
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    explicit xoshiro256(std::uint64_t seed) {
+        // seed every word through splitmix64 so that no stream starts all zero
+        for (auto& word : m_state) {
+            for (std::uint64_t& lane : word) {
+                seed += 0x9e3779b97f4a7c15;
+                lane = mix64(seed);
+            }
+        }
+    }
+
+    /** Write the next value of each stream to `out[0:lanes]`.
+     */
+    void fill(std::uint64_t* __restrict out) {
+        auto& [s0, s1, s2, s3] = m_state;
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            out[lane] = rotl(s1[lane] * 5, 7) * 9;
+            std::uint64_t t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = rotl(s3[lane], 45);
+        }
+    }
+
+    std::uint64_t next() {
+        if (!m_buffered) {
+            fill(m_buffer.data());
+            m_buffered = lanes;
+        }
+        return m_buffer[lanes - m_buffered--];
+    }
+
+    /** A uniform value in [0, bound), by Lemire's multiply and reject method.
+     */
+    std::uint64_t below(std::uint64_t bound) {
+        unsigned __int128 product = static_cast<unsigned __int128>(next()) * bound;
+        std::uint64_t low = static_cast<std::uint64_t>(product);
+        if (low < bound) {
+            std::uint64_t threshold = -bound % bound;
+            while (low < threshold) {
+                product = static_cast<unsigned __int128>(next()) * bound;
+                low = static_cast<std::uint64_t>(product);
+            }
+        }
+        return static_cast<std::uint64_t>(product >> 64);
+    }
+};
+
+/** A double in [0, 1) from the high 53 bits of `bits`.
+ */
+inline double unit_double(std::uint64_t bits) {
+    return (bits >> 11) * 0x1p-53;
+}
+
+/** Parse a `seed` argument: an int, or None to seed from the OS. Returns true with
+    an exception raised on failure.
+ */
+bool parse_seed(PyObject* seed_ob, std::uint64_t& seed) {
+    if (!seed_ob || seed_ob == Py_None) {
+        std::random_device device;
+        seed = (static_cast<std::uint64_t>(device()) << 32) | device();
+        return false;
+    }
+    if (!PyLong_Check(seed_ob)) {
+        PyErr_Format(PyExc_TypeError,
+                     "seed must be an int or None, got %.200s",
+                     Py_TYPE(seed_ob)->tp_name);
+        return true;
+    }
+    // keep the low 64 bits, so negative seeds are fine
+    seed = PyLong_AsUnsignedLongLongMask(seed_ob);
+    return seed == static_cast<std::uint64_t>(-1) && PyErr_Occurred();
+}
+}  // namespace detail
+
+PyDoc_STRVAR(random_doc,
+             "random(n, dist='uniform', *, seed=None)\n"
+             "\n"
+             "Return a jlist of n random floats drawn from dist: 'uniform' for values\n"
+             "in [0, 1), or 'normal' for the standard normal distribution. The values\n"
+             "come from xoshiro256**, so the same seed gives the same values, but not\n"
+             "the same values as the random module. A seed of None seeds from the OS.\n"
+             "\n"
+             "Equivalent to:  jlist(random.random() for _ in range(n))\n"
+             "                jlist(random.gauss(0, 1) for _ in range(n))");
+
+PyObject* random(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"n", "dist", "seed", nullptr};
+    Py_ssize_t size;
+    const char* dist = "uniform";
+    PyObject* seed_ob = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "n|s$O:random",
+                                     const_cast<char**>(keywords),
+                                     &size,
+                                     &dist,
+                                     &seed_ob)) {
+        return nullptr;
+    }
+    if (size < 0) {
+        PyErr_Format(PyExc_ValueError, "n must be non-negative, got %zd", size);
+        return nullptr;
+    }
+    bool normal = !std::strcmp(dist, "normal");
+    if (!normal && std::strcmp(dist, "uniform")) {
+        PyErr_Format(PyExc_ValueError,
+                     "dist must be 'uniform' or 'normal', got '%s'",
+                     dist);
+        return nullptr;
+    }
+    std::uint64_t seed;
+    if (detail::parse_seed(seed_ob, seed)) {
+        return nullptr;
+    }
+
+    entry_tag tag = size ? entry_tag::as_double : entry_tag::unset;
+    jlist* out = detail::new_jlist(module, tag);
+    if (!out) {
+        return nullptr;
+    }
+    if (detail::resize_entries(*out, size)) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+
+    detail::xoshiro256 rng(seed);
+    entry* values = out->entries.data();
+    if (normal) {
+        // Marsaglia's polar method turns each pair of uniforms in the unit circle into
+        // a pair of normals with one log and no trig
+        for (Py_ssize_t ix = 0; ix < size;) {
+            double u = 2 * detail::unit_double(rng.next()) - 1;
+            double v = 2 * detail::unit_double(rng.next()) - 1;
+            double s = u * u + v * v;
+            if (s >= 1 || s == 0) {
+                continue;
+            }
+            double scale = std::sqrt(-2 * std::log(s) / s);
+            values[ix++].as_double = u * scale;
+            if (ix < size) {
+                values[ix++].as_double = v * scale;
+            }
+        }
+        return reinterpret_cast<PyObject*>(out);
+    }
+
+    constexpr Py_ssize_t lanes = detail::xoshiro256::lanes;
+    std::array<std::uint64_t, lanes> bits;
+    Py_ssize_t ix = 0;
+    for (; ix + lanes <= size; ix += lanes) {
+        rng.fill(bits.data());
+        for (Py_ssize_t lane = 0; lane < lanes; ++lane) {
+            values[ix + lane].as_double = detail::unit_double(bits[lane]);
+        }
+    }
+    for (; ix < size; ++ix) {
+        values[ix].as_double = detail::unit_double(rng.next());
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef random_method = {"random",
+                             unsafe_cast_to_pycfunction(random),
+                             METH_VARARGS | METH_KEYWORDS,
+                             random_doc};
+
+PyDoc_STRVAR(shuffle_doc,
+             "shuffle(values, *, seed=None)\n"
+             "\n"
+             "Shuffle a jlist in place with the Fisher-Yates algorithm. Entries are\n"
+             "swapped directly, so nothing is boxed whatever the values are. The\n"
+             "order comes from xoshiro256**, not the random module.\n"
+             "\n"
+             "Equivalent to:  random.shuffle(values)");
+
+PyObject* shuffle(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"values", "seed", nullptr};
+    PyObject* list_ob;
+    PyObject* seed_ob = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|$O:shuffle",
+                                     const_cast<char**>(keywords),
+                                     &list_ob,
+                                     &seed_ob)) {
+        return nullptr;
+    }
+    if (!detail::is_jlist(module, list_ob)) {
+        PyErr_Format(PyExc_TypeError,
+                     "shuffle() argument must be a jlist, not %.200s",
+                     Py_TYPE(list_ob)->tp_name);
+        return nullptr;
+    }
+    std::uint64_t seed;
+    if (detail::parse_seed(seed_ob, seed)) {
+        return nullptr;
+    }
+
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+    self.invalidate_index();
+    detail::xoshiro256 rng(seed);
+    for (std::size_t ix = self.entries.size(); ix > 1; --ix) {
+        std::swap(self.entries[ix - 1], self.entries[rng.below(ix)]);
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef shuffle_method = {"shuffle",
+                              unsafe_cast_to_pycfunction(shuffle),
+                              METH_VARARGS | METH_KEYWORDS,
+                              shuffle_doc};
+
+namespace detail {
+/** Choose `k` distinct positions in [0, size) in random order.
+ */
+std::vector<Py_ssize_t> sample_positions(xoshiro256& rng, Py_ssize_t size, Py_ssize_t k) {
+    std::vector<Py_ssize_t> positions;
+    if (4 * k >= size) {
+        // the first k steps of a Fisher-Yates shuffle of all the positions
+        positions.resize(size);
+        for (Py_ssize_t ix = 0; ix < size; ++ix) {
+            positions[ix] = ix;
+        }
+        for (Py_ssize_t ix = 0; ix < k; ++ix) {
+            std::swap(positions[ix], positions[ix + rng.below(size - ix)]);
+        }
+        positions.resize(k);
+        return positions;
+    }
+
+    // Floyd's algorithm picks a uniform subset in O(k); shuffling it makes every
+    // order equally likely
+    int_hash_table chosen;
+    positions.reserve(k);
+    for (Py_ssize_t j = size - k; j < size; ++j) {
+        Py_ssize_t candidate = rng.below(j + 1);
+        Py_ssize_t count = positions.size();
+        if (chosen.insert(candidate, count) != count) {
+            candidate = j;
+            chosen.insert(candidate, count);
+        }
+        positions.push_back(candidate);
+    }
+    for (std::size_t ix = positions.size(); ix > 1; --ix) {
+        std::swap(positions[ix - 1], positions[rng.below(ix)]);
+    }
+    return positions;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(sample_doc,
+             "sample(population, k, *, seed=None)\n"
+             "\n"
+             "Return a jlist of k values chosen from distinct positions of population,\n"
+             "in random order. Values are copied without boxing. The choice comes\n"
+             "from xoshiro256**, not the random module.\n"
+             "\n"
+             "Equivalent to:  jlist(random.sample(population, k))");
+
+PyObject* sample(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"population", "k", "seed", nullptr};
+    PyObject* population;
+    Py_ssize_t k;
+    PyObject* seed_ob = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "On|$O:sample",
+                                     const_cast<char**>(keywords),
+                                     &population,
+                                     &k,
+                                     &seed_ob)) {
+        return nullptr;
+    }
+    std::uint64_t seed;
+    if (detail::parse_seed(seed_ob, seed)) {
+        return nullptr;
+    }
+    PyObject* list_ob = detail::as_jlist(module, population);
+    if (!list_ob) {
+        return nullptr;
+    }
+    scope_guard decref_list([&] { Py_DECREF(list_ob); });
+    jlist& self = *reinterpret_cast<jlist*>(list_ob);
+
+    if (k < 0 || k > self.size()) {
+        PyErr_SetString(PyExc_ValueError, "Sample larger than population or is negative");
+        return nullptr;
+    }
+
+    detail::xoshiro256 rng(seed);
+    std::vector<Py_ssize_t> positions = detail::sample_positions(rng, self.size(), k);
+
+    jlist* out = detail::new_jlist(module, entry_tag::unset);
+    if (!out) {
+        return nullptr;
+    }
+    if (k) {
+        out->tagged_ptr = self.tagged_ptr;
+    }
+    out->entries.reserve(k);
+    for (Py_ssize_t pos : positions) {
+        out->entries.push_back(self.entries[pos]);
+    }
+    if (out->boxed()) {
+        for (entry e : out->entries) {
+            Py_INCREF(e.as_ob);
+        }
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef sample_method = {"sample",
+                             unsafe_cast_to_pycfunction(sample),
+                             METH_VARARGS | METH_KEYWORDS,
+                             sample_doc};
+
+namespace detail {
+/** Parse an argument of `arange` or `linspace` as a finite double. Returns true with
+    an exception raised on failure.
+ */
+bool parse_finite(PyObject* ob, const char* name, double& out) {
+    out = PyFloat_AsDouble(ob);
+    if (out == -1.0 && PyErr_Occurred()) {
+        return true;
+    }
+    if (!std::isfinite(out)) {
+        PyErr_Format(PyExc_ValueError, "%s must be finite, got %R", name, ob);
+        return true;
+    }
+    return false;
+}
+
+/** Allocate a double jlist of `size` entries and set entry `ix` to `f(ix)`.
+ */
+template<typename F>
+PyObject* double_grid(PyObject* module, double size, F&& f) {
+    if (size > static_cast<double>(PY_SSIZE_T_MAX / sizeof(entry))) {
+        PyErr_SetString(PyExc_MemoryError, "jlist would be too large");
+        return nullptr;
+    }
+    jlist* out = new_jlist(module, entry_tag::as_double);
+    if (!out) {
+        return nullptr;
+    }
+    Py_ssize_t n = static_cast<Py_ssize_t>(size);
+    if (resize_entries(*out, n)) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    for (Py_ssize_t ix = 0; ix < n; ++ix) {
+        out->entries[ix].as_double = f(ix);
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+}  // namespace detail
+
+PyDoc_STRVAR(arange_doc,
+             "arange(stop) -> jlist\n"
+             "arange(start, stop[, step]) -> jlist\n"
+             "\n"
+             "Like range, but the arguments may be floats. The i-th value is\n"
+             "start + i * step, so values don't accumulate rounding error. If every\n"
+             "argument is an int, this is the same as jlist.range.\n"
+             "\n"
+             "Equivalent to:  jlist(start + i * step\n"
+             "                      for i in range(math.ceil((stop - start) / step)))");
+
+PyObject* arange(PyObject* module, PyObject* args) {
+    PyObject* start_ob;
+    PyObject* stop_ob = nullptr;
+    PyObject* step_ob = nullptr;
+    if (!PyArg_UnpackTuple(args, "arange", 1, 3, &start_ob, &stop_ob, &step_ob)) {
+        return nullptr;
+    }
+    if (PyLong_Check(start_ob) && (!stop_ob || PyLong_Check(stop_ob)) &&
+        (!step_ob || PyLong_Check(step_ob))) {
+        return range(module, args);
+    }
+    if (!stop_ob) {
+        stop_ob = start_ob;
+        start_ob = nullptr;
+    }
+
+    double start = 0;
+    double stop;
+    double step = 1;
+    if ((start_ob && detail::parse_finite(start_ob, "start", start)) ||
+        detail::parse_finite(stop_ob, "stop", stop) ||
+        (step_ob && detail::parse_finite(step_ob, "step", step))) {
+        return nullptr;
+    }
+    if (step == 0) {
+        PyErr_SetString(PyExc_ValueError, "arange() arg 3 must not be zero");
+        return nullptr;
+    }
+
+    double size = std::max(std::ceil((stop - start) / step), 0.0);
+    return detail::double_grid(module, size, [&](Py_ssize_t ix) {
+        return start + ix * step;
+    });
+}
+
+PyMethodDef arange_method = {"arange", arange, METH_VARARGS, arange_doc};
+
+PyDoc_STRVAR(linspace_doc,
+             "linspace(start, stop, num=50, *, endpoint=True)\n"
+             "\n"
+             "Return num evenly spaced floats from start to stop. If endpoint is false,\n"
+             "stop is left out and the spacing is (stop - start) / num. The last value\n"
+             "is exactly stop when it is included.\n"
+             "\n"
+             "Equivalent to:  jlist(start + i * (stop - start) / (num - 1)\n"
+             "                      for i in range(num))");
+
+PyObject* linspace(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"start", "stop", "num", "endpoint", nullptr};
+    PyObject* start_ob;
+    PyObject* stop_ob;
+    Py_ssize_t num = 50;
+    int endpoint = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "OO|n$p:linspace",
+                                     const_cast<char**>(keywords),
+                                     &start_ob,
+                                     &stop_ob,
+                                     &num,
+                                     &endpoint)) {
+        return nullptr;
+    }
+    if (num < 0) {
+        PyErr_Format(PyExc_ValueError, "num must be non-negative, got %zd", num);
+        return nullptr;
+    }
+    double start;
+    double stop;
+    if (detail::parse_finite(start_ob, "start", start) ||
+        detail::parse_finite(stop_ob, "stop", stop)) {
+        return nullptr;
+    }
+
+    Py_ssize_t divisions = (endpoint && num > 1) ? num - 1 : num;
+    double step = divisions ? (stop - start) / divisions : 0;
+    return detail::double_grid(module, num, [&](Py_ssize_t ix) {
+        return (endpoint && ix == divisions) ? stop : start + ix * step;
+    });
+}
+
+PyMethodDef linspace_method = {"linspace",
+                               unsafe_cast_to_pycfunction(linspace),
+                               METH_VARARGS | METH_KEYWORDS,
+                               linspace_doc};
+
+namespace detail {
+/** Parse the size argument of a constructor. Returns -1 with an exception raised on
+    failure.
+ */
+Py_ssize_t parse_size(PyObject* size_ob) {
+    Py_ssize_t size = PyNumber_AsSsize_t(size_ob, PyExc_OverflowError);
+    if (size == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (size < 0) {
+        PyErr_Format(PyExc_ValueError, "n must be non-negative, got %zd", size);
+        return -1;
+    }
+    return size;
+}
+}  // namespace detail
+
+PyDoc_STRVAR(full_doc,
+             "full(n, value)\n"
+             "\n"
+             "Return a jlist of n copies of value. ints and floats are stored unboxed;\n"
+             "anything else is stored n times with all of the references added at once.\n"
+             "\n"
+             "Equivalent to:  jlist([value] * n)");
+
+PyObject* full(PyObject* module, PyObject* args) {
+    PyObject* size_ob;
+    PyObject* value;
+    if (!PyArg_UnpackTuple(args, "full", 2, 2, &size_ob, &value)) {
+        return nullptr;
+    }
+    Py_ssize_t size = detail::parse_size(size_ob);
+    if (size < 0) {
+        return nullptr;
+    }
+
+    jlist* out = detail::new_jlist(module, entry_tag::unset);
+    if (!out) {
+        return nullptr;
+    }
+    if (!size) {
+        return reinterpret_cast<PyObject*>(out);
+    }
+    entry e;
+    if (auto as_int = maybe_unbox<std::int64_t>(value)) {
+        e.as_int = *as_int;
+        out->tag(entry_tag::as_int);
+    }
+    else if (auto as_double = maybe_unbox<double>(value)) {
+        e.as_double = *as_double;
+        out->tag(entry_tag::as_double);
+    }
+    else {
+        e.as_ob = value;
+        out->homogeneous_type_ptr(Py_TYPE(value));
+    }
+    if (detail::resize_entries(*out, size, e)) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    if (out->boxed()) {
+        detail::incref_n(value, size);
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef full_method = {"full", full, METH_VARARGS, full_doc};
+
+PyDoc_STRVAR(empty_doc,
+             "empty(n, dtype='double')\n"
+             "\n"
+             "Return a jlist of n unboxed values of dtype, 'int' or 'double', to be\n"
+             "overwritten. The storage is allocated in one step; the values are zero,\n"
+             "but code shouldn't rely on that.\n"
+             "\n"
+             "Equivalent to:  jlist.zeros(n)");
+
+PyObject* empty(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"n", "dtype", nullptr};
+    PyObject* size_ob;
+    const char* dtype = "double";
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "O|s:empty",
+                                     const_cast<char**>(keywords),
+                                     &size_ob,
+                                     &dtype)) {
+        return nullptr;
+    }
+    entry_tag tag;
+    if (!std::strcmp(dtype, "double")) {
+        tag = entry_tag::as_double;
+    }
+    else if (!std::strcmp(dtype, "int")) {
+        tag = entry_tag::as_int;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "dtype must be 'double' or 'int', got '%s'",
+                     dtype);
+        return nullptr;
+    }
+    Py_ssize_t size = detail::parse_size(size_ob);
+    if (size < 0) {
+        return nullptr;
+    }
+
+    jlist* out = detail::new_jlist(module, tag);
+    if (!out) {
+        return nullptr;
+    }
+    if (detail::resize_entries(*out, size)) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(out);
+}
+
+PyMethodDef empty_method = {"empty",
+                            unsafe_cast_to_pycfunction(empty),
+                            METH_VARARGS | METH_KEYWORDS,
+                            empty_doc};
+
+PyMethodDef methods[] = {
+    all_method,
+    any_method,
+    sum_method,
+    range_method,
+    zeros_method,
+    heapify_method,
+    heappush_method,
+    heappop_method,
+    heapreplace_method,
+    heappushpop_method,
+    nsmallest_method,
+    nlargest_method,
+    partition_method,
+    nth_method,
+    quantile_method,
+    median_method,
+    topk_method,
+    argsort_method,
+    take_method,
+    searchsorted_method,
+    merge_method,
+    rolling_sum_method,
+    rolling_mean_method,
+    rolling_min_method,
+    rolling_max_method,
+    rolling_std_method,
+    group_count_method,
+    group_sum_method,
+    group_min_method,
+    group_max_method,
+    group_mean_method,
+    join_indices_method,
+    unzip_method,
+    filter_mask_method,
+    factorize_method,
+    encode_blocks_method,
+    decode_blocks_method,
+    freeze_method,
+    fingerprint_method,
+    build_index_method,
+    hll_update_method,
+    hll_merge_method,
+    hll_estimate_method,
+    kll_update_method,
+    kll_quantiles_method,
+    lazy_run_method,
+    lt_method,
+    le_method,
+    eq_method,
+    ne_method,
+    gt_method,
+    ge_method,
+    count_where_method,
+    dot_method,
+    sqdist_method,
+    norm_method,
+    abs_method,
+    sqrt_method,
+    log_method,
+    exp_method,
+    floor_method,
+    round_method,
+    clip_method,
+    astype_method,
+    random_method,
+    shuffle_method,
+    sample_method,
+    arange_method,
+    linspace_method,
+    full_method,
+    empty_method,
+    {nullptr, nullptr, 0, nullptr},
+};
+
+int module_traverse(PyObject* self, visitproc visit, void* arg) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(self));
+    if (!state) {
+        return 0;
+    }
+
+    Py_VISIT(state->jlist_type);
+    Py_VISIT(state->frozen_jlist_type);
+    Py_VISIT(state->builtin_sum);
+    Py_VISIT(state->builtin_round);
+    Py_VISIT(state->math_sqrt);
+    Py_VISIT(state->math_log);
+    Py_VISIT(state->math_exp);
+    Py_VISIT(state->math_floor);
+    Py_VISIT(state->math_ceil);
+    Py_VISIT(state->heapq_heapify);
+    Py_VISIT(state->heapq_heappush);
+    Py_VISIT(state->heapq_heappop);
+    Py_VISIT(state->heapq_heapreplace);
+    Py_VISIT(state->heapq_heappushpop);
+    Py_VISIT(state->heapq_nsmallest);
+    Py_VISIT(state->heapq_nlargest);
+    return 0;
+}
+
+void module_free(PyObject* self) {
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(self));
+    if (state) {
+        Py_CLEAR(state->jlist_type);
+        Py_CLEAR(state->frozen_jlist_type);
+        Py_CLEAR(state->builtin_sum);
+        Py_CLEAR(state->builtin_round);
+        Py_CLEAR(state->math_sqrt);
+        Py_CLEAR(state->math_log);
+        Py_CLEAR(state->math_exp);
+        Py_CLEAR(state->math_floor);
+        Py_CLEAR(state->math_ceil);
+        Py_CLEAR(state->heapq_heapify);
+        Py_CLEAR(state->heapq_heappush);
+        Py_CLEAR(state->heapq_heappop);
+        Py_CLEAR(state->heapq_heapreplace);
+        Py_CLEAR(state->heapq_heappushpop);
+        Py_CLEAR(state->heapq_nsmallest);
+        Py_CLEAR(state->heapq_nlargest);
+    }
+}
+
+PyModuleDef module = {
+    PyModuleDef_HEAD_INIT,
+    "jlist.ops",
+    nullptr,
+    sizeof(module_state),
+    methods,
+    nullptr,
+    module_traverse,
+    nullptr,
+    reinterpret_cast<freefunc>(module_free),
+};
+
+PyMODINIT_FUNC PyInit_ops() {
+    PyObject* builtins = PyImport_ImportModule("builtins");
+    if (!builtins) {
+        return nullptr;
+    }
+    scope_guard decref_builtins([&] { Py_DECREF(builtins); });
+
+    PyObject* m = PyModule_Create(&module);
+    if (!m) {
+        return nullptr;
+    }
+    scope_guard decref_m([&] { Py_DECREF(m); });
+
+    module_state* state = reinterpret_cast<module_state*>(PyModule_GetState(m));
+
+    PyObject* jlist_mod = PyImport_ImportModule("jlist.jlist");
+    if (!jlist_mod) {
+        return nullptr;
+    }
+
+    state->jlist_type = reinterpret_cast<PyTypeObject*>(
+        PyObject_GetAttrString(jlist_mod, "jlist"));
+    state->frozen_jlist_type = reinterpret_cast<PyTypeObject*>(
+        PyObject_GetAttrString(jlist_mod, "frozenjlist"));
+    Py_DECREF(jlist_mod);
+    if (!(state->jlist_type && state->frozen_jlist_type)) {
+        return nullptr;
+    }
+
+    if (!(state->builtin_all = PyObject_GetAttrString(builtins, "all"))) {
+        return nullptr;
+    }
+    scope_guard decref_builtin_all([&] { Py_DECREF(state->builtin_all); });
+
+    if (!(state->builtin_any = PyObject_GetAttrString(builtins, "any"))) {
+        return nullptr;
+    }
+    scope_guard decref_builtin_any([&] { Py_DECREF(state->builtin_any); });
+
+    if (!(state->builtin_sum = PyObject_GetAttrString(builtins, "sum"))) {
+        return nullptr;
+    }
+
+    if (!(state->builtin_round = PyObject_GetAttrString(builtins, "round"))) {
+        return nullptr;
+    }
+
+    PyObject* math = PyImport_ImportModule("math");
+    if (!math) {
+        return nullptr;
+    }
+    scope_guard decref_math([&] { Py_DECREF(math); });
+
+    std::pair<PyObject**, const char*> math_functions[] = {
+        {&state->math_sqrt, "sqrt"},
+        {&state->math_log, "log"},
+        {&state->math_exp, "exp"},
+        {&state->math_floor, "floor"},
+        {&state->math_ceil, "ceil"},
+    };
+    for (auto [dest, name] : math_functions) {
+        if (!(*dest = PyObject_GetAttrString(math, name))) {
+            return nullptr;
+        }
+    }
+
+    PyObject* heapq = PyImport_ImportModule("heapq");
+    if (!heapq) {
+        return nullptr;
+    }
+    scope_guard decref_heapq([&] { Py_DECREF(heapq); });
+
+    std::pair<PyObject**, const char*> heapq_functions[] = {
+        {&state->heapq_heapify, "heapify"},
+        {&state->heapq_heappush, "heappush"},
+        {&state->heapq_heappop, "heappop"},
+        {&state->heapq_heapreplace, "heapreplace"},
+        {&state->heapq_heappushpop, "heappushpop"},
+        {&state->heapq_nsmallest, "nsmallest"},
+        {&state->heapq_nlargest, "nlargest"},
+    };
+    for (auto [dest, name] : heapq_functions) {
+        if (!(*dest = PyObject_GetAttrString(heapq, name))) {
+            return nullptr;
+        }
+    }
 
     decref_builtin_any.dismiss();
     decref_builtin_all.dismiss();
@@ -0,0 +1,303 @@
+import numbers
+
+import jlist as jl
+from .ops import (
+    _hll_estimate,
+    _hll_merge,
+    _hll_update,
+    _kll_quantiles,
+    _kll_update,
+)
+
+
+class distinct_sketch:
+    """A HyperLogLog sketch which estimates the number of distinct values it has
+    seen in ``2 ** precision`` bytes.
+
+    ints, floats, ``str``, and ``bytes`` hash the same way in every process, so
+    sketches of these values can be pickled and merged across processes. Equal
+    ints and floats count as one value.
+
+    Parameters
+    ----------
+    values : iterable, optional
+        The values to add to the sketch.
+    precision : int, optional
+        The log2 of the number of registers, in ``[4, 18]``. The relative
+        standard error of the estimate is about ``1.04 / sqrt(2 ** precision)``.
+
+    Examples
+    --------
+    >>> sketch = distinct_sketch(jl.range(100000))
+    >>> round(sketch.estimate(), -3)
+    100000.0
+
+    >>> sketch.update(jl.range(50000, 150000))
+    >>> round(sketch.estimate(), -3)
+    150000.0
+    """
+    __slots__ = '_registers',
+
+    def __init__(self, values=(), *, precision=14):
+        if not 4 <= precision <= 18:
+            raise ValueError(f'precision must be in [4, 18], got {precision}')
+        self._registers = bytearray(1 << precision)
+        self.update(values)
+
+    @property
+    def precision(self):
+        """The log2 of the number of registers.
+        """
+        return len(self._registers).bit_length() - 1
+
+    def update(self, values):
+        """Add values to the sketch.
+        """
+        _hll_update(self._registers, values)
+
+    def merge(self, other):
+        """Add the values seen by another sketch with the same precision to this
+        sketch.
+        """
+        _hll_merge(self._registers, other._registers)
+
+    def __or__(self, other):
+        if not isinstance(other, distinct_sketch):
+            return NotImplemented
+        out = self.copy()
+        out.merge(other)
+        return out
+
+    def copy(self):
+        """Return a copy of the sketch.
+        """
+        out = type(self).__new__(type(self))
+        out._registers = self._registers.copy()
+        return out
+
+    def estimate(self):
+        """Estimate the number of distinct values seen by the sketch.
+        """
+        return _hll_estimate(self._registers)
+
+    def __reduce__(self):
+        return _from_registers, (bytes(self._registers),)
+
+    def __repr__(self):
+        return (
+            f'<{type(self).__name__} precision={self.precision}'
+            f' estimate={self.estimate():.0f}>'
+        )
+
+
+def _from_registers(registers):
+    out = distinct_sketch.__new__(distinct_sketch)
+    out._registers = bytearray(registers)
+    return out
+
+
+class quantile_sketch:
+    """A KLL sketch which estimates quantiles of the ``int`` and ``float``
+    values it has seen in ``O(k)`` space.
+
+    Values are kept in levels where each value on level ``h`` stands for ``2 **
+    h`` of the values seen. When the sketch is full a level is sorted and every
+    other value is moved up a level. The rank error is about ``1.7 / k``; until
+    the first compaction the sketch is exact. NaNs are skipped.
+
+    Parameters
+    ----------
+    values : iterable[int] or iterable[float], optional
+        The values to add to the sketch.
+    k : int, optional
+        The size of the bottom level, which controls the accuracy. Must be at
+        least 8.
+
+    Examples
+    --------
+    >>> sketch = quantile_sketch(jl.range(1000001))
+    >>> abs(sketch.quantile(0.5) - 500000) < 10000
+    True
+
+    >>> sketch.quantile(1)
+    1000000.0
+    """
+    __slots__ = '_levels', '_k', '_count', '_min', '_max', '_compactions'
+
+    def __init__(self, values=(), *, k=200):
+        if k < 8:
+            raise ValueError(f'k must be at least 8, got {k}')
+        self._levels = [jl.jlist()]
+        self._k = k
+        self._count = 0
+        self._min = None
+        self._max = None
+        self._compactions = 0
+        self.update(values)
+
+    @property
+    def k(self):
+        """The size of the bottom level.
+        """
+        return self._k
+
+    def __len__(self):
+        """The number of values seen by the sketch.
+        """
+        return self._count
+
+    def _add(self, values, level):
+        count, low, high = _kll_update(
+            self._levels,
+            values,
+            level,
+            self._k,
+            self._compactions,
+        )
+        self._compactions += 1
+        return count, low, high
+
+    def _add_bounds(self, low, high):
+        if low is not None:
+            self._min = low if self._min is None else min(self._min, low)
+            self._max = high if self._max is None else max(self._max, high)
+
+    def update(self, values):
+        """Add values to the sketch.
+        """
+        count, low, high = self._add(values, 0)
+        self._count += count
+        self._add_bounds(low, high)
+
+    def merge(self, other):
+        """Add the values seen by another sketch to this sketch.
+        """
+        if other is self:
+            other = other.copy()
+        for level, values in enumerate(other._levels):
+            self._add(values, level)
+        # the other sketch's bounds are exact even if its levels have been compacted
+        self._count += other._count
+        self._add_bounds(other._min, other._max)
+
+    def __or__(self, other):
+        if not isinstance(other, quantile_sketch):
+            return NotImplemented
+        out = self.copy()
+        out.merge(other)
+        return out
+
+    def copy(self):
+        """Return a copy of the sketch.
+        """
+        out = type(self).__new__(type(self))
+        out._levels = [level.copy() for level in self._levels]
+        out._k = self._k
+        out._count = self._count
+        out._min = self._min
+        out._max = self._max
+        out._compactions = self._compactions
+        return out
+
+    def quantiles(self, qs):
+        """Estimate quantiles of the values seen by the sketch.
+
+        Parameters
+        ----------
+        qs : sequence[float]
+            The quantiles to estimate, each in ``[0, 1]``.
+
+        Returns
+        -------
+        quantiles : jlist[float]
+            The estimated quantiles, in the order of ``qs``.
+        """
+        qs = list(qs)
+        out = _kll_quantiles(self._levels, qs)
+        # the smallest and largest values may have been compacted away
+        for ix, q in enumerate(qs):
+            if q == 0:
+                out[ix] = self._min
+            elif q == 1:
+                out[ix] = self._max
+        return out
+
+    def quantile(self, q):
+        """Estimate a single quantile of the values seen by the sketch.
+        """
+        return self.quantiles([q])[0]
+
+    def __reduce__(self):
+        return _from_levels, (
+            self._levels,
+            self._k,
+            self._count,
+            self._min,
+            self._max,
+            self._compactions,
+        )
+
+    def __repr__(self):
+        return f'<{type(self).__name__} k={self._k} len={self._count}>'
+
+
+def _from_levels(levels, k, count, min, max, compactions):
+    out = quantile_sketch.__new__(quantile_sketch)
+    out._levels = levels
+    out._k = k
+    out._count = count
+    out._min = min
+    out._max = max
+    out._compactions = compactions
+    return out
+
+
+def approx_distinct(values, precision=14):
+    """Estimate the number of distinct values with a HyperLogLog sketch.
+
+    Parameters
+    ----------
+    values : iterable
+        The values to count.
+    precision : int, optional
+        The log2 of the number of registers, in ``[4, 18]``.
+
+    Returns
+    -------
+    estimate : float
+        The estimated number of distinct values.
+
+    See Also
+    --------
+    jlist.distinct_sketch
+    """
+    return distinct_sketch(values, precision=precision).estimate()
+
+
+def approx_quantiles(values, qs, k=200):
+    """Estimate quantiles with a KLL sketch.
+
+    Parameters
+    ----------
+    values : iterable[int] or iterable[float]
+        The values.
+    qs : float or sequence[float]
+        The quantile or quantiles to estimate, each in ``[0, 1]``.
+    k : int, optional
+        The size of the bottom level of the sketch.
+
+    Returns
+    -------
+    quantiles : float or jlist[float]
+        The estimated quantile if ``qs`` is a number, otherwise a ``jlist`` of
+        the estimated quantiles.
+
+    See Also
+    --------
+    jlist.quantile_sketch
+    jlist.quantile
+    """
+    sketch = quantile_sketch(values, k=k)
+    if isinstance(qs, numbers.Real):
+        return sketch.quantile(qs)
+    return sketch.quantiles(qs)
@@ -0,0 +1,205 @@
+import jlist as jl
+
+
+class jtable:
+    """A table of named ``jlist`` columns of the same length.
+
+    Each column keeps its own tag, so a column of ints or floats is stored
+    unboxed instead of as a field of a boxed tuple per row.
+
+    Parameters
+    ----------
+    columns : mapping[str, iterable]
+        The columns of the table, in order. Each column is converted to a
+        ``jlist`` if it is not one already.
+
+    Notes
+    -----
+    Columns which are already ``jlist`` objects are shared, not copied, so
+    appending to one shows up in the table. The length is read from the
+    columns each time it is needed, and a ValueError is raised if they no
+    longer all have the same length.
+
+    Examples
+    --------
+    >>> t = jtable({'name': ['a', 'b'], 'score': [2.5, 1.0]})
+    >>> t['score']
+    jlist([2.500000, 1.000000])
+
+    >>> [row.name for row in t.sort_by('score')]
+    ['b', 'a']
+    """
+    __slots__ = '_columns',
+
+    def __init__(self, columns):
+        self._columns = {
+            name: column if type(column) is jl.jlist else jl.jlist(column)
+            for name, column in columns.items()
+        }
+        self._length()
+
+    def _length(self):
+        # the columns may be shared with the caller, so check them every time
+        lengths = {len(column) for column in self._columns.values()}
+        if len(lengths) > 1:
+            raise ValueError(
+                f'columns must all be the same length, got {sorted(lengths)}',
+            )
+        return lengths.pop() if lengths else 0
+
+    @classmethod
+    def from_rows(cls, rows, names):
+        """Build a table by transposing an iterable of rows.
+
+        Parameters
+        ----------
+        rows : iterable[sequence]
+            The rows of the table. Each row must have one field per name.
+        names : sequence[str]
+            The names of the columns.
+
+        Returns
+        -------
+        table : jtable
+            The new table.
+        """
+        names = tuple(names)
+        return cls(dict(zip(names, jl.unzip(rows, len(names)))))
+
+    @property
+    def names(self):
+        """The names of the columns, in order.
+        """
+        return tuple(self._columns)
+
+    def __len__(self):
+        return self._length()
+
+    def __getitem__(self, name):
+        return self._columns[name]
+
+    def __iter__(self):
+        for ix in range(self._length()):
+            yield row(self, ix)
+
+    def rows(self):
+        """Iterate over the rows of the table as tuples.
+        """
+        self._length()
+        return zip(*self._columns.values())
+
+    def _map_columns(self, f):
+        return type(self)({
+            name: f(column) for name, column in self._columns.items()
+        })
+
+    def take(self, indices):
+        """Select rows by position.
+
+        Parameters
+        ----------
+        indices : iterable[int]
+            The positions of the rows to select.
+
+        Returns
+        -------
+        table : jtable
+            A table of the selected rows.
+        """
+        indices = jl.jlist(indices)
+        return self._map_columns(lambda column: jl.take(column, indices))
+
+    def sort_by(self, name, *, reverse=False):
+        """Sort the rows by the values of one column.
+
+        The sort is stable, so rows with equal values keep their order.
+
+        Parameters
+        ----------
+        name : str
+            The name of the column to sort by.
+        reverse : bool, optional
+            Sort in descending order.
+
+        Returns
+        -------
+        table : jtable
+            The sorted table.
+        """
+        column = self._columns[name]
+        if not reverse:
+            return self.take(jl.argsort(column))
+
+        # Sort the reversed column and reverse the result. Equal values come out
+        # in their original order, like ``sorted(..., reverse=True)``.
+        positions = jl.jlist(range(self._length()))[::-1]
+        return self.take(jl.take(positions, jl.argsort(column[::-1]))[::-1])
+
+    def filter(self, mask):
+        """Select the rows where ``mask`` is true.
+
+        Parameters
+        ----------
+        mask : iterable[bool]
+            One value for each row.
+
+        Returns
+        -------
+        table : jtable
+            A table of the selected rows.
+        """
+        mask = jl.jlist(mask)
+        return self._map_columns(lambda column: jl.filter_mask(column, mask))
+
+    def __eq__(self, other):
+        if not isinstance(other, jtable):
+            return NotImplemented
+        return (
+            self.names == other.names and
+            all(self[name] == other[name] for name in self.names)
+        )
+
+    def __repr__(self):
+        columns = ', '.join(
+            f'{name!r}: {column!r}' for name, column in self._columns.items()
+        )
+        return f'{type(self).__name__}({{{columns}}})'
+
+
+class row:
+    """A view of one row of a ``jtable``.
+
+    Fields can be read by attribute or by column name.
+    """
+    __slots__ = '_table', '_ix'
+
+    def __init__(self, table, ix):
+        self._table = table
+        self._ix = ix
+
+    def __getitem__(self, name):
+        return self._table[name][self._ix]
+
+    def __getattr__(self, name):
+        try:
+            return self._table[name][self._ix]
+        except KeyError:
+            raise AttributeError(name) from None
+
+    def __len__(self):
+        return len(self._table.names)
+
+    def __iter__(self):
+        for name in self._table.names:
+            yield self[name]
+
+    def __eq__(self, other):
+        if isinstance(other, row):
+            other = tuple(other)
+        if not isinstance(other, tuple):
+            return NotImplemented
+        return tuple(self) == other
+
+    def __repr__(self):
+        fields = ', '.join(f'{name}={self[name]!r}' for name in self._table.names)
+        return f'{type(self).__name__}({fields})'
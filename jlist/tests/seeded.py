@@ -0,0 +1,27 @@
+import random
+from unittest import TestCase
+
+
+class SeededTestCase(TestCase):
+    """A TestCase with a ``random`` generator seeded from the class's
+    ``RANDOM_SEED`` so that every run sees the same values.
+    """
+    RANDOM_SEED = 0
+
+    @classmethod
+    def setUpClass(cls):
+        super().setUpClass()
+        cls.random = random.Random(cls.RANDOM_SEED)
+
+    def datasets(self, size=257):
+        """Lists of ``size`` random small ints, floats, strs, and a mix of ints
+        and floats.
+        """
+        return [
+            [self.random.randrange(-100, 100) for _ in range(size)],
+            [self.random.random() for _ in range(size)],
+            [str(self.random.randrange(100)) for _ in range(size)],
+            [self.random.choice([self.random.randrange(100),
+                                 self.random.random() * 100])
+             for _ in range(size)],
+        ]
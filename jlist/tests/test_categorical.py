@@ -0,0 +1,91 @@
+from unittest import TestCase
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class FactorizeTestCase(TestCase):
+    def test_objects(self):
+        codes, uniques = jl.factorize(['b', 'a', 'b', 'c', 'a'])
+        self.assertEqual(list(codes), [0, 1, 0, 2, 1])
+        self.assertEqual(codes.tag, 'int')
+        self.assertEqual(list(uniques), ['b', 'a', 'c'])
+        self.assertEqual(uniques.tag, 'homogeneous_ob')
+
+    def test_unboxed(self):
+        codes, uniques = jl.factorize([5, -1, 5, 2 ** 62])
+        self.assertEqual(list(codes), [0, 1, 0, 2])
+        self.assertEqual(list(uniques), [5, -1, 2 ** 62])
+        self.assertEqual(uniques.tag, 'int')
+
+        codes, uniques = jl.factorize([0.5, 1.5, 0.5])
+        self.assertEqual(list(codes), [0, 1, 0])
+        self.assertEqual(list(uniques), [0.5, 1.5])
+
+    def test_dict_equality(self):
+        codes, uniques = jl.factorize([1, 1.0, True, 'x'])
+        self.assertEqual(list(codes), [0, 0, 0, 1])
+        self.assertEqual(list(uniques), [1, 'x'])
+
+    def test_empty(self):
+        codes, uniques = jl.factorize([])
+        self.assertEqual(list(codes), [])
+        self.assertEqual(list(uniques), [])
+
+    def test_unhashable(self):
+        with self.assertRaises(TypeError):
+            jl.factorize([[1], [2]])
+
+
+class CategoricalTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'categorical', 'little')
+
+    def values(self, n=200):
+        return [self.random.choice(['debug', 'info', 'warn', 'error'])
+                for _ in range(n)]
+
+    def test_roundtrip(self):
+        values = self.values()
+        c = jl.categorical(values)
+        self.assertEqual(len(c), len(values))
+        self.assertEqual(list(c), values)
+        self.assertEqual(c.decode(), jl.jlist(values))
+        self.assertEqual(c[3], values[3])
+        self.assertEqual(list(c[10:20]), values[10:20])
+        self.assertEqual(c, values)
+
+    def test_lookups(self):
+        values = self.values()
+        c = jl.categorical(values)
+        for value in ('debug', 'info', 'warn', 'error', 'fatal'):
+            self.assertEqual(c.count(value), values.count(value))
+            self.assertEqual(value in c, value in values)
+            if value in values:
+                self.assertEqual(c.index(value), values.index(value))
+            else:
+                with self.assertRaises(ValueError):
+                    c.index(value)
+        self.assertEqual(c.count([]), 0)
+
+    def test_sort(self):
+        values = self.values()
+        for reverse in (False, True):
+            c = jl.categorical(values)
+            c.sort(reverse=reverse)
+            self.assertEqual(list(c), sorted(values, reverse=reverse))
+            self.assertEqual(list(c.categories), sorted(set(values)))
+
+    def test_eq(self):
+        values = self.values()
+        a = jl.categorical(values)
+        b = jl.categorical(values)
+        self.assertEqual(a, b)
+        b.sort()
+        self.assertEqual(b, sorted(values))
+        self.assertNotEqual(a, b)
+
+    def test_from_codes(self):
+        c = jl.categorical.from_codes([1, 0, 1], ['a', 'b'])
+        self.assertEqual(list(c), ['b', 'a', 'b'])
+        with self.assertRaises(ValueError):
+            jl.categorical.from_codes([2], ['a', 'b'])
@@ -0,0 +1,89 @@
+import math
+import pickle
+import struct
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class CompressedTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'compressed', 'little')
+
+    def assert_same_bits(self, actual, expected):
+        self.assertEqual(
+            [struct.pack('d', x) for x in actual],
+            [struct.pack('d', x) for x in expected],
+        )
+
+    def test_int_roundtrip(self):
+        cases = [
+            [],
+            [1],
+            list(range(0, 10000, 7)),
+            [self.random.randrange(-2 ** 63, 2 ** 63) for _ in range(3000)],
+            [2 ** 63 - 1, -2 ** 63, 2 ** 63 - 1, 0],
+            [5] * 2000,
+        ]
+        for values in cases:
+            for block_size in (1, 7, 1024):
+                c = jl.compress(jl.jlist(values), block_size=block_size)
+                self.assertEqual(len(c), len(values))
+                out = jl.decompress(c)
+                self.assertEqual(list(out), values)
+                if values:
+                    self.assertEqual(out.tag, 'int')
+
+    def test_double_roundtrip(self):
+        cases = [
+            [self.random.random() for _ in range(3000)],
+            [1.5] * 100,
+            [math.nan, math.inf, -math.inf, -0.0, 0.0, 1e308, 5e-324],
+            [round(ix * 0.1, 1) for ix in range(2000)],
+        ]
+        for values in cases:
+            for block_size in (1, 7, 1024):
+                c = jl.compress(jl.jlist(values), block_size=block_size)
+                out = c.decompress()
+                self.assertEqual(out.tag, 'double')
+                self.assert_same_bits(out, values)
+
+    def test_compresses(self):
+        c = jl.compress(jl.range(100000))
+        self.assertLess(c.nbytes, 100000)
+        c = jl.compress(jl.jlist([0.5] * 100000))
+        self.assertLess(c.nbytes, 100000)
+
+    def test_sum(self):
+        values = [self.random.randrange(-100, 100) for _ in range(5000)]
+        c = jl.compress(values, block_size=64)
+        self.assertEqual(c.sum(), sum(values))
+        self.assertEqual(c.sum(10), sum(values, 10))
+
+        values = [self.random.random() for _ in range(5000)]
+        c = jl.compress(values, block_size=64)
+        self.assertEqual(c.sum(), jl.sum(jl.jlist(values)))
+
+    def test_indexing(self):
+        values = [self.random.randrange(1000) for _ in range(1000)]
+        c = jl.compress(values, block_size=64)
+        self.assertEqual(list(c), values)
+        for ix in (0, 63, 64, 999, -1, -1000):
+            self.assertEqual(c[ix], values[ix])
+        with self.assertRaises(IndexError):
+            c[1000]
+
+        for s in (slice(10, 200), slice(None, None, 3), slice(500, 60, -7),
+                  slice(5, 5), slice(-10, None), slice(None, None, -1)):
+            self.assertEqual(list(c[s]), values[s])
+
+    def test_pickle(self):
+        c = jl.compress([1, 2, 3])
+        self.assertEqual(list(pickle.loads(pickle.dumps(c))), [1, 2, 3])
+
+    def test_errors(self):
+        with self.assertRaises(TypeError):
+            jl.compress(['a'])
+        with self.assertRaises(ValueError):
+            jl.compress([1], block_size=0)
+        with self.assertRaises(ValueError):
+            jl.ops._decode_blocks('int', [b'\x05\x00'])
@@ -0,0 +1,187 @@
+import math
+import pickle
+import struct
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class FrozenTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'frozen', 'little')
+
+    def test_freeze(self):
+        values = [1, 2, 3]
+        frozen = jl.freeze(values)
+        self.assertIsInstance(frozen, jl.frozenjlist)
+        self.assertIsInstance(frozen, jl.jlist)
+        self.assertEqual(list(frozen), values)
+        self.assertEqual(frozen.tag, 'int')
+        self.assertIs(jl.freeze(frozen), frozen)
+        self.assertEqual(repr(frozen), 'frozenjlist([1, 2, 3])')
+        self.assertEqual(repr(jl.frozenjlist()), 'frozenjlist([])')
+
+        # freezing copies the values
+        source = jl.jlist(values)
+        frozen = jl.freeze(source)
+        source.append(4)
+        self.assertEqual(list(frozen), values)
+
+    def test_hash_matches_tuple(self):
+        random_doubles = [
+            struct.unpack('d', struct.pack('Q', self.random.getrandbits(64)))[0]
+            for _ in range(1000)
+        ]
+        cases = [
+            [],
+            [0],
+            [-1],
+            [1, -2, 3],
+            [2 ** 61 - 1, 2 ** 61, -2 ** 63, 2 ** 63 - 1],
+            [self.random.randrange(-2 ** 63, 2 ** 63) for _ in range(1000)],
+            [0.0, -0.0, 1.5, -2.25, 3.0, 2.0 ** 70, math.inf, -math.inf],
+            [5e-324, -5e-324, 2.2250738585072014e-308, 1.7976931348623157e308],
+            [x for x in random_doubles if not math.isnan(x)],
+            ['a', 'b', None],
+            [1, 'a', (2, 3)],
+        ]
+        for values in cases:
+            self.assertEqual(hash(jl.freeze(values)), hash(tuple(values)))
+
+    def test_hash_equal_across_tags(self):
+        ints = jl.freeze([1, 2, 3])
+        doubles = jl.freeze([1.0, 2.0, 3.0])
+        objects = jl.freeze([1, 2.0, 3])
+        self.assertEqual(ints.tag, 'int')
+        self.assertEqual(doubles.tag, 'double')
+        self.assertEqual(objects.tag, 'heterogeneous_ob')
+
+        self.assertEqual(ints, doubles)
+        self.assertEqual(ints, objects)
+        self.assertEqual(hash(ints), hash(doubles))
+        self.assertEqual(hash(ints), hash(objects))
+
+    def test_unhashable_element(self):
+        frozen = jl.freeze([1, [2]])
+        with self.assertRaises(TypeError):
+            hash(frozen)
+
+    def test_dict_key(self):
+        memo = {jl.freeze([1, 2, 3]): 'a'}
+        self.assertEqual(memo[jl.freeze([1, 2, 3])], 'a')
+        self.assertEqual(memo[jl.freeze(jl.range(1, 4))], 'a')
+        self.assertNotIn(jl.freeze([1, 2]), memo)
+
+    def test_compare(self):
+        frozen = jl.freeze([1, 2, 3])
+        self.assertEqual(frozen, jl.jlist([1, 2, 3]))
+        self.assertEqual(jl.jlist([1, 2, 3]), frozen)
+        self.assertNotEqual(frozen, jl.jlist([1, 2]))
+        self.assertNotEqual(frozen, [1, 2, 3])
+
+    def test_immutable(self):
+        frozen = jl.freeze([3, 1, 2])
+        mutators = [
+            lambda: frozen.append(4),
+            lambda: frozen.clear(),
+            lambda: frozen.extend([4]),
+            lambda: frozen.insert(0, 4),
+            lambda: frozen.pop(),
+            lambda: frozen.remove(1),
+            lambda: frozen.reverse(),
+            lambda: frozen.sort(),
+            lambda: frozen._reserve(10),
+            lambda: frozen.__setitem__(0, 4),
+            lambda: frozen.__setitem__(slice(0, 1), [4]),
+            lambda: frozen.__delitem__(0),
+            lambda: frozen.__delitem__(slice(None)),
+        ]
+        for mutate in mutators:
+            with self.assertRaises(TypeError):
+                mutate()
+
+        frozen.__init__([4, 5])
+        self.assertEqual(list(frozen), [3, 1, 2])
+
+    def test_immutable_through_jlist_methods(self):
+        frozen = jl.freeze([3, 1, 2])
+        hash_before = hash(frozen)
+        self.assertIsInstance(frozen, jl.jlist)
+        mutators = [
+            lambda: jl.jlist.__init__(frozen, [4, 5]),
+            lambda: jl.jlist.append(frozen, 4),
+            lambda: jl.jlist.clear(frozen),
+            lambda: jl.jlist.extend(frozen, [4]),
+            lambda: jl.jlist.insert(frozen, 0, 4),
+            lambda: jl.jlist.pop(frozen),
+            lambda: jl.jlist.remove(frozen, 1),
+            lambda: jl.jlist.reverse(frozen),
+            lambda: jl.jlist.sort(frozen),
+            lambda: jl.jlist._reserve(frozen, 10),
+            lambda: jl.jlist.__setitem__(frozen, 0, 4),
+            lambda: jl.jlist.__setitem__(frozen, slice(0, 1), [4]),
+            lambda: jl.jlist.__delitem__(frozen, 0),
+            lambda: jl.jlist.__iadd__(frozen, [4]),
+            lambda: jl.jlist.__imul__(frozen, 2),
+        ]
+        for mutate in mutators:
+            with self.assertRaises(TypeError):
+                mutate()
+        self.assertEqual(list(frozen), [3, 1, 2])
+        self.assertEqual(hash(frozen), hash_before)
+        self.assertEqual(hash(frozen), hash((3, 1, 2)))
+
+    def test_operations_return_frozen(self):
+        frozen = jl.freeze([1, 2, 3])
+
+        for result, expected in [
+            (frozen[1:], [2, 3]),
+            (frozen[::-1], [3, 2, 1]),
+            (frozen + [4], [1, 2, 3, 4]),
+            (frozen * 2, [1, 2, 3, 1, 2, 3]),
+        ]:
+            self.assertIs(type(result), jl.frozenjlist)
+            self.assertEqual(list(result), expected)
+
+        alias = frozen
+        alias += [4]
+        self.assertIs(type(alias), jl.frozenjlist)
+        self.assertEqual(list(alias), [1, 2, 3, 4])
+        self.assertEqual(list(frozen), [1, 2, 3])
+
+        alias = frozen
+        alias *= 2
+        self.assertEqual(list(alias), [1, 2, 3, 1, 2, 3])
+        self.assertEqual(list(frozen), [1, 2, 3])
+
+        thawed = frozen.copy()
+        self.assertIs(type(thawed), jl.jlist)
+        thawed.append(4)
+        self.assertEqual(list(thawed), [1, 2, 3, 4])
+
+    def test_read_methods(self):
+        frozen = jl.freeze(['a', 'b', 'a'])
+        self.assertEqual(frozen[0], 'a')
+        self.assertEqual(frozen[-1], 'a')
+        self.assertEqual(len(frozen), 3)
+        self.assertEqual(frozen.count('a'), 2)
+        self.assertEqual(frozen.index('b'), 1)
+        self.assertIn('b', frozen)
+        self.assertEqual(list(iter(frozen)), ['a', 'b', 'a'])
+        # a frozenjlist is iterable but not an iterator
+        with self.assertRaises(TypeError):
+            next(frozen)
+        self.assertEqual(jl.factorize(frozen)[0], jl.jlist([0, 1, 0]))
+        self.assertEqual(jl.sum(jl.freeze([1, 2, 3])), 6)
+
+    def test_extend_from_frozen(self):
+        values = jl.jlist([1.5])
+        values.extend(jl.freeze([2.5, 3.5]))
+        self.assertEqual(list(values), [1.5, 2.5, 3.5])
+        self.assertEqual(values.tag, 'double')
+
+    def test_pickle(self):
+        frozen = jl.freeze([1, 'a', 2.5])
+        roundtripped = pickle.loads(pickle.dumps(frozen))
+        self.assertIs(type(roundtripped), jl.frozenjlist)
+        self.assertEqual(roundtripped, frozen)
+        self.assertEqual(hash(roundtripped), hash(frozen))
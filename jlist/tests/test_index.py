@@ -0,0 +1,184 @@
+import math
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class IndexTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'index', 'little')
+
+    def assert_lookups_match(self, indexed, probes):
+        expected = list(indexed)
+        for probe in probes:
+            self.assertEqual(probe in indexed, probe in expected, probe)
+            self.assertEqual(indexed.count(probe), expected.count(probe), probe)
+            if probe in expected:
+                self.assertEqual(indexed.index(probe), expected.index(probe))
+            else:
+                with self.assertRaises(ValueError):
+                    indexed.index(probe)
+
+    def test_build_index(self):
+        values = jl.jlist([3, 1, 3, 2])
+        self.assertFalse(values.indexed)
+        self.assertIsNone(values.build_index())
+        self.assertTrue(values.indexed)
+
+        self.assertIs(jl.build_index(values), values)
+        with self.assertRaises(TypeError):
+            jl.build_index([1, 2])
+
+    def test_ints(self):
+        values = jl.jlist(self.random.randrange(-50, 50) for _ in range(500))
+        values.build_index()
+        self.assert_lookups_match(values, range(-60, 60))
+        # probes which can't be unboxed fall back to comparing
+        self.assert_lookups_match(values, [1.0, True, 2 ** 70, 'a', None])
+
+    def test_doubles(self):
+        values = jl.jlist([0.5, -0.0, 1.5, 0.5, math.nan, 2.0, 0.0, -1.5])
+        values.build_index()
+        self.assertEqual(values.tag, 'double')
+        self.assert_lookups_match(
+            values,
+            [0.5, 0.0, -0.0, 1.5, 2.0, 2, -1.5, 3.5, math.inf],
+        )
+        self.assertNotIn(math.nan, values)
+        self.assertEqual(values.count(math.nan), 0)
+
+    def test_objects(self):
+        values = jl.jlist(['a', 'b', None, 1, 1.0, True, (1, 2), 'a', b'a'])
+        values.build_index()
+        self.assert_lookups_match(
+            values,
+            ['a', 'b', 'c', None, 1, 1.0, True, (1, 2), (1,), b'a', b'b'],
+        )
+
+        # unhashable probes fall back to comparing
+        self.assert_lookups_match(values, [[1, 2], {}])
+
+    def test_unhashable(self):
+        values = jl.jlist([1, [2]])
+        with self.assertRaises(TypeError):
+            values.build_index()
+        self.assertFalse(values.indexed)
+
+    def test_index_bounds(self):
+        values = jl.jlist([1, 2, 1, 2, 3])
+        values.build_index()
+        self.assertEqual(values.index(1, 1), 2)
+        self.assertEqual(values.index(2, 2), 3)
+        self.assertEqual(values.index(1, 0, 1), 0)
+        self.assertEqual(values.index(3, -1), 4)
+        with self.assertRaises(ValueError):
+            values.index(3, 0, 4)
+        with self.assertRaises(ValueError):
+            values.index(1, 3)
+
+    def test_append_updates_index(self):
+        for start in ([], [1, 2], ['a']):
+            values = jl.jlist(start)
+            values.build_index()
+            for value in [2, 3, 2, 5]:
+                values.append(value if start != ['a'] else str(value))
+            self.assertTrue(values.indexed)
+            self.assert_lookups_match(values, [1, 2, 3, 5, '2', '3', '5', 'a'])
+
+        # changing how the values are stored drops the index
+        values = jl.jlist([1, 2])
+        values.build_index()
+        values.append(1.5)
+        self.assertFalse(values.indexed)
+        self.assert_lookups_match(values, [1, 2, 1.5])
+
+    def test_mutation_drops_index(self):
+        mutations = [
+            lambda values: values.__setitem__(0, 4),
+            lambda values: values.__setitem__(slice(0, 2), [4]),
+            lambda values: values.__delitem__(0),
+            lambda values: values.extend([4, 1]),
+            lambda values: values.insert(0, 4),
+            lambda values: values.pop(),
+            lambda values: values.pop(0),
+            lambda values: values.remove(1),
+            lambda values: values.reverse(),
+            lambda values: values.sort(),
+            lambda values: values.clear(),
+            lambda values: values.__init__([4]),
+            lambda values: values.__iadd__([4]),
+            lambda values: values.__imul__(2),
+            lambda values: jl.heapify(values),
+            lambda values: jl.heappush(values, 0),
+            lambda values: jl.heappop(values),
+            lambda values: jl.heapreplace(values, 0),
+            lambda values: jl.heappushpop(values, 5),
+            lambda values: jl.partition(values, 1),
+        ]
+        for mutate in mutations:
+            values = jl.jlist([3, 1, 2, 1])
+            values.build_index()
+            mutate(values)
+            self.assertFalse(values.indexed)
+            self.assert_lookups_match(values, range(6))
+
+    def test_copies_are_not_indexed(self):
+        values = jl.jlist([1, 2])
+        values.build_index()
+        self.assertFalse(values.copy().indexed)
+        self.assertFalse(values[:].indexed)
+
+    def test_frozen(self):
+        values = jl.freeze(['a', 'b', 'a'])
+        jl.build_index(values)
+        self.assertTrue(values.indexed)
+        self.assert_lookups_match(values, ['a', 'b', 'c'])
+
+    def test_mutated_while_hashing(self):
+        class clears_list:
+            def __init__(self, values):
+                self.values = values
+
+            def __hash__(self):
+                self.values.clear()
+                return 0
+
+        values = jl.jlist([1, 'a'])
+        values.append(clears_list(values))
+        with self.assertRaises(RuntimeError):
+            values.build_index()
+        self.assertFalse(values.indexed)
+
+    def test_mutated_while_comparing(self):
+        class clears_list:
+            def __init__(self, values):
+                self.values = values
+
+            def __hash__(self):
+                return hash('a')
+
+            def __eq__(self, other):
+                self.values.clear()
+                return False
+
+        values = jl.jlist(['a', 'b'])
+        values.build_index()
+        self.assertNotIn(clears_list(values), values)
+        self.assertEqual(list(values), [])
+        self.assertFalse(values.indexed)
+
+        values = jl.jlist(['a', 'b'])
+        values.build_index()
+        values.append(clears_list(values))
+        self.assertFalse(values.indexed)
+
+    def test_random_mutations(self):
+        for _ in range(200):
+            values = jl.jlist(self.random.randrange(10) for _ in range(20))
+            values.build_index()
+            for _ in range(20):
+                if self.random.random() < 0.8:
+                    values.append(self.random.randrange(12))
+                else:
+                    values[self.random.randrange(len(values))] = 3
+                    values.build_index()
+                self.assert_lookups_match(values, range(13))
@@ -0,0 +1,250 @@
+import itertools
+import random
+import sys
+from unittest import TestCase
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class ExtendIterableTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'iteration', 'little')
+
+    def random_values(self, n):
+        choices = [
+            lambda: self.random.randrange(-100, 100),
+            lambda: self.random.uniform(-100, 100),
+            lambda: str(self.random.randrange(10)),
+            lambda: 2 ** 70,
+            lambda: None,
+        ]
+        kinds = self.random.sample(choices, self.random.randrange(1, 3))
+        return [self.random.choice(kinds)() for _ in range(n)]
+
+    def test_generators(self):
+        for _ in range(200):
+            start = self.random_values(self.random.randrange(4))
+            values = self.random_values(self.random.randrange(20))
+            expected = jl.jlist(start)
+            expected.extend(values)
+
+            actual = jl.jlist(start)
+            actual.extend(value for value in values)
+            self.assertEqual(actual, expected)
+            self.assertEqual(actual.tag, expected.tag)
+
+            self.assertEqual(jl.jlist(iter(values)), jl.jlist(values))
+
+    def test_error_unwinds(self):
+        def fails_after(values):
+            yield from values
+            raise ValueError('boom')
+
+        for start, values in [
+                ([0], [1, 2]),
+                ([0.5], [1.5, 2.5]),
+                (['a'], ['b', 'c']),
+                ([0], [1, 'a', 2.5]),
+                ([], [1, 2]),
+        ]:
+            sentinel = object()
+            values.append(sentinel)
+            before = sys.getrefcount(sentinel)
+            out = jl.jlist(start)
+            with self.assertRaises(ValueError):
+                out.extend(fails_after(values))
+            self.assertEqual(list(out), start)
+            self.assertEqual(sys.getrefcount(sentinel), before)
+
+    def test_length_hint(self):
+        class hinted:
+            def __init__(self, values, hint):
+                self.values = iter(values)
+                self.hint = hint
+
+            def __iter__(self):
+                return self
+
+            def __next__(self):
+                return next(self.values)
+
+            def __length_hint__(self):
+                return self.hint
+
+        # the hint is only used to reserve space
+        for hint in 0, 2, 100, sys.maxsize:
+            self.assertEqual(jl.jlist(hinted([1, 2, 3], hint)), jl.jlist([1, 2, 3]))
+
+        class bad_len:
+            def __iter__(self):
+                return iter([1])
+
+            def __len__(self):
+                raise RuntimeError('len')
+
+        with self.assertRaises(RuntimeError):
+            jl.jlist(bad_len())
+
+    def test_mutated_by_iterator(self):
+        values = jl.jlist([1, 2, 3])
+
+        def clears():
+            yield 4
+            values.clear()
+            yield 5
+
+        values.extend(clears())
+        self.assertEqual(values, jl.jlist([5]))
+
+
+class ExtendFromJlistIteratorTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'iterators', 'little')
+
+    def random_values(self):
+        kind = self.random.choice([
+            lambda: self.random.randrange(10),
+            lambda: self.random.random(),
+            lambda: str(self.random.randrange(10)),
+        ])
+        values = [kind() for _ in range(self.random.randrange(12))]
+        if values and self.random.random() < 0.3:
+            values[self.random.randrange(len(values))] = None
+        return values
+
+    def assert_extend_matches(self, make_iterator):
+        """Extend a jlist from an iterator over a jlist, and compare it to the same
+        iterator over a list, including where both iterators are left.
+        """
+        for _ in range(500):
+            values = self.random_values()
+            start = self.random_values()
+            seed = self.random.getrandbits(32)
+            actual_it = make_iterator(jl.jlist(values), random.Random(seed))
+            expected_it = make_iterator(list(values), random.Random(seed))
+            for _ in range(self.random.randrange(3)):
+                self.assertEqual(next(actual_it, None), next(expected_it, None))
+
+            actual = jl.jlist(start)
+            actual.extend(actual_it)
+            expected = jl.jlist(start)
+            expected.extend(list(expected_it))
+            self.assertEqual(actual, expected)
+            self.assertEqual(list(actual_it), [])
+
+    def test_iter(self):
+        self.assert_extend_matches(lambda values, random: iter(values))
+
+    def test_reversed(self):
+        self.assert_extend_matches(lambda values, random: reversed(values))
+
+    def test_islice(self):
+        def make_iterator(values, random):
+            it = iter(values)
+            for _ in range(random.randrange(3)):
+                next(it, None)
+            start = random.randrange(5)
+            stop = random.choice([None, random.randrange(14)])
+            step = random.randrange(1, 4)
+            return itertools.islice(it, start, stop, step)
+
+        self.assert_extend_matches(make_iterator)
+
+    def test_islice_leaves_inner_iterator(self):
+        for size in range(8):
+            for start, stop, step in itertools.product(
+                    range(5),
+                    [None, *range(9)],
+                    range(1, 4),
+            ):
+                actual_inner = iter(jl.jlist(range(size)))
+                expected_inner = iter(list(range(size)))
+                actual_slice = itertools.islice(actual_inner, start, stop, step)
+                expected_slice = itertools.islice(expected_inner, start, stop, step)
+                actual = jl.jlist()
+                actual.extend(actual_slice)
+                expected = list(expected_slice)
+                self.assertEqual(list(actual), expected)
+                # exhausted slices must not consume more of the inner iterator
+                self.assertEqual(list(actual_slice), list(expected_slice))
+                self.assertEqual(list(actual_inner), list(expected_inner))
+
+    def test_self(self):
+        values = jl.jlist([1, 2, 3])
+        values.extend(iter(values))
+        self.assertEqual(values, jl.jlist([1, 2, 3, 1, 2, 3]))
+
+        values = jl.jlist(['a', 1])
+        values.extend(reversed(values))
+        self.assertEqual(values, jl.jlist(['a', 1, 1, 'a']))
+
+        values = jl.jlist([1.5, 2.5, 3.5])
+        values.extend(itertools.islice(values, 1, 3))
+        self.assertEqual(values, jl.jlist([1.5, 2.5, 3.5, 2.5, 3.5]))
+
+    def test_references(self):
+        value = object()
+        source = jl.jlist([value, value])
+        before = sys.getrefcount(value)
+        out = jl.jlist()
+        out.extend(iter(source))
+        out.extend(reversed(source))
+        out.extend(itertools.islice(source, 1))
+        self.assertEqual(sys.getrefcount(value), before + 5)
+        del out
+        self.assertEqual(sys.getrefcount(value), before)
+
+
+class ReversedTestCase(TestCase):
+    def test_tags(self):
+        for values in ([1, 2, 3], [1.5, -0.0, 2.5], ['a', 'b'], ['a', 1, None], []):
+            it = reversed(jl.jlist(values))
+            self.assertIs(type(it), type(reversed(jl.jlist())))
+            self.assertEqual(list(it), values[::-1])
+            self.assertEqual(list(it), [])
+
+        self.assertEqual(list(reversed(jl.freeze([1, 'a']))), ['a', 1])
+
+    def test_length_hint(self):
+        values = jl.jlist([1, 2, 3])
+        it = reversed(values)
+        self.assertEqual(it.__length_hint__(), 3)
+        next(it)
+        self.assertEqual(it.__length_hint__(), 2)
+
+        # the hint drops to 0 when the list shrinks past the position
+        values.pop()
+        values.pop()
+        self.assertEqual(it.__length_hint__(), 0)
+        self.assertEqual(list(it), [])
+        self.assertEqual(it.__length_hint__(), 0)
+
+    def test_mutation(self):
+        values = jl.jlist([1, 2, 3])
+        it = reversed(values)
+        self.assertEqual(next(it), 3)
+        values.append(4)
+        values[0] = 'a'
+        self.assertEqual(list(it), [2, 'a'])
+
+        values = jl.jlist([1, 2, 3])
+        it = reversed(values)
+        values.clear()
+        self.assertEqual(list(it), [])
+        values.extend([4, 5, 6])
+        # once exhausted the iterator stays exhausted
+        self.assertEqual(list(it), [])
+
+    def test_setstate(self):
+        values = jl.jlist(range(5))
+        it = reversed(values)
+        it.__setstate__(2)
+        self.assertEqual(list(it), [2, 1, 0])
+
+        # positions are clamped to the list
+        for state, expected in [(10, [4, 3, 2, 1, 0]), (-5, [])]:
+            it = reversed(values)
+            it.__setstate__(state)
+            self.assertEqual(list(it), expected)
+
+        with self.assertRaises(TypeError):
+            reversed(values).__setstate__('a')
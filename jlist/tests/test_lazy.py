@@ -0,0 +1,170 @@
+import operator
+import pickle
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class LazyTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'lazy', 'little')
+
+    def assert_same(self, actual, expected):
+        self.assertEqual(actual, expected)
+        self.assertIs(type(actual), type(expected))
+
+    def assert_terminals(self, pipeline, expected):
+        collected = pipeline.collect()
+        self.assertIsInstance(collected, jl.jlist)
+        self.assertEqual(list(collected), expected)
+        for value, expected_value in zip(collected, expected):
+            self.assertIs(type(value), type(expected_value))
+        self.assertEqual(list(pipeline), expected)
+        self.assertEqual(pipeline.count(), len(expected))
+        if all(isinstance(value, (int, float)) for value in expected):
+            self.assert_same(pipeline.sum(), sum(expected))
+        if expected:
+            self.assert_same(pipeline.min(), min(expected))
+            self.assert_same(pipeline.max(), max(expected))
+        else:
+            with self.assertRaises(ValueError):
+                pipeline.min()
+            with self.assertRaises(ValueError):
+                pipeline.max()
+
+    def test_no_stages(self):
+        for values in ([], [1, 2], [1.5, -2.5], ['a', 'b'], [1, 2.5, True]):
+            self.assert_terminals(jl.lazy(values), values)
+            self.assert_terminals(jl.lazy(jl.jlist(values)), values)
+
+    def test_arithmetic(self):
+        ops = [
+            (lambda x: x + 3, lambda x: x + 3),
+            (lambda x: 3 + x, lambda x: 3 + x),
+            (lambda x: x - 2.5, lambda x: x - 2.5),
+            (lambda x: 7 - x, lambda x: 7 - x),
+            (lambda x: x * -4, lambda x: x * -4),
+            (lambda x: 0.5 * x, lambda x: 0.5 * x),
+            (lambda x: x / 3, lambda x: x / 3),
+            (lambda x: 10 / x, lambda x: 10 / x),
+            (operator.neg, operator.neg),
+        ]
+        sources = [
+            [self.random.randrange(1, 10 ** 6) for _ in range(2000)],
+            [self.random.uniform(1, 100) for _ in range(2000)],
+            [self.random.choice([1, 2.5, 3]) for _ in range(2000)],
+        ]
+        for values in sources:
+            for lazy_op, op in ops:
+                self.assert_terminals(
+                    lazy_op(jl.lazy(values)),
+                    [op(value) for value in values],
+                )
+
+    def test_chained(self):
+        values = jl.jlist(self.random.randrange(-1000, 1000) for _ in range(5000))
+        pipeline = (
+            (jl.lazy(values) * 3 + 1)
+            .filter(lambda x: x % 2)
+            .map(abs)
+            .filter(lambda x: x > 100)
+            / 2
+        )
+        expected = [
+            abs(x * 3 + 1) / 2
+            for x in values
+            if (x * 3 + 1) % 2 and abs(x * 3 + 1) > 100
+        ]
+        self.assert_terminals(pipeline, expected)
+
+        # stages build new pipelines
+        base = jl.lazy(values)
+        doubled = base * 2
+        self.assertEqual(base.count(), len(values))
+        self.assertEqual(doubled.sum(), 2 * sum(values))
+
+    def test_map_results(self):
+        self.assert_terminals(jl.lazy(jl.range(10)).map(str), list(map(str, range(10))))
+        self.assert_terminals(
+            jl.lazy(['1', '2', '3']).map(int) * 2,
+            [2, 4, 6],
+        )
+        self.assert_terminals(
+            jl.lazy(jl.range(5)).map(lambda x: x if x % 2 else float(x)),
+            [0.0, 1, 2.0, 3, 4.0],
+        )
+
+    def test_overflow(self):
+        big = 2 ** 62
+        self.assert_terminals(jl.lazy([big, big]) * 4, [big * 4, big * 4])
+        self.assert_terminals(jl.lazy([big, -big]) - big, [0, -2 * big])
+        self.assert_same(jl.lazy([big] * 5).sum(), 5 * big)
+        self.assert_same(jl.lazy([2 ** 63 - 1, 1, -1]).sum(), 2 ** 63 - 1)
+        self.assert_terminals(jl.lazy([2 ** 60, 3]) / 3, [2 ** 60 / 3, 1.0])
+        self.assert_terminals(jl.lazy([3]) / 2 ** 60, [3 / 2 ** 60])
+
+    def test_sum_start(self):
+        self.assert_same(jl.lazy([1, 2]).sum(10), 13)
+        self.assert_same(jl.lazy([1, 2]).sum(0.5), 3.5)
+        self.assert_same(jl.lazy([1.5]).sum(2), 3.5)
+        self.assert_same(jl.lazy([]).sum(2.5), 2.5)
+        self.assert_same(jl.lazy([[1], [2]]).sum([]), [1, 2])
+
+    def test_errors(self):
+        with self.assertRaises(ZeroDivisionError):
+            (jl.lazy([1, 2]) / 0).sum()
+        with self.assertRaises(ZeroDivisionError):
+            (1.0 / jl.lazy([1.0, 0.0])).collect()
+        with self.assertRaises(TypeError):
+            (jl.lazy([1, 'a']) + 1).collect()
+
+        # only numbers broadcast
+        for operand in (jl.lazy([1]), [1], 'a', None):
+            for op in (operator.add, operator.sub, operator.mul, operator.truediv):
+                with self.assertRaises(TypeError):
+                    op(jl.lazy([1, 2]), operand)
+                with self.assertRaises(TypeError):
+                    op(operand, jl.lazy([1, 2]))
+        with self.assertRaises(TypeError):
+            jl.lazy([1, 2]) * jl.jlist([1])
+
+    def test_neg(self):
+        self.assert_terminals(-jl.lazy([1, -2, 0]), [-1, 2, 0])
+        self.assert_terminals(-jl.lazy([1.5, -0.0]), [-1.5, 0.0])
+        self.assert_terminals(-jl.lazy([-2 ** 63, 1]), [2 ** 63, -1])
+        self.assert_terminals(-jl.lazy([2 ** 70, 1.5]), [-2 ** 70, -1.5])
+        self.assert_terminals(
+            -jl.lazy([True, False, 2]),
+            [-True, -False, -2],
+        )
+        self.assert_terminals(-(-jl.lazy(range(5))), list(range(5)))
+        with self.assertRaises(TypeError):
+            (-jl.lazy(['a'])).collect()
+
+        def fail_on(bad):
+            def f(x):
+                if x == bad:
+                    raise KeyError(x)
+                return True
+            return f
+
+        for source in (jl.range(2000), jl.jlist(map(str, range(2000)))):
+            bad = source[1500]
+            with self.assertRaises(KeyError):
+                jl.lazy(source).map(fail_on(bad)).collect()
+            with self.assertRaises(KeyError):
+                jl.lazy(source).filter(fail_on(bad)).count()
+
+    def test_source_mutated(self):
+        values = jl.jlist(range(2000))
+
+        def clear(x):
+            values.clear()
+            return x
+
+        self.assertLessEqual(jl.lazy(values).map(clear).count(), 1024)
+
+    def test_pickle(self):
+        pipeline = (jl.lazy(jl.range(10)) + 1).map(abs)
+        roundtripped = pickle.loads(pickle.dumps(pipeline))
+        self.assertEqual(roundtripped.collect(), pipeline.collect())
+        self.assertEqual(repr(roundtripped), repr(pipeline))
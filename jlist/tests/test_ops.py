@@ -1,8 +1,15 @@
+import bisect
+import collections
+import fractions
+import heapq
 import math
 import random
+import statistics
+import sys
 from unittest import TestCase
 
 import jlist as jl
+from jlist.tests.seeded import SeededTestCase
 
 
 class SumTestCase(TestCase):
@@ -71,3 +78,1285 @@ class SumTestCase(TestCase):
         self.assertEqual(builtin_sum_jlist_ints, builtin_sum_list_ints)
         jl_sum_jlist_ints = jl.sum(jlist_ints)
         self.assertEqual(jl_sum_jlist_ints, builtin_sum_list_ints)
+
+
+class HeapqTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'heapq', 'little')
+
+    def test_heapify_matches_heapq(self):
+        for data in self.datasets():
+            expected = list(data)
+            heapq.heapify(expected)
+
+            jlist = jl.jlist(data)
+            tag = jlist.tag
+            jl.heapify(jlist)
+            self.assertEqual(list(jlist), expected)
+            self.assertEqual(jlist.tag, tag)
+
+    def test_push_pop(self):
+        for data in self.datasets():
+            heap = []
+            jheap = jl.jlist()
+            for value in data:
+                heapq.heappush(heap, value)
+                jl.heappush(jheap, value)
+            self.assertEqual(list(jheap), heap)
+
+            popped = [jl.heappop(jheap) for _ in range(len(data))]
+            self.assertEqual(popped, sorted(data))
+            self.assertEqual(len(jheap), 0)
+
+            with self.assertRaises(IndexError):
+                jl.heappop(jheap)
+
+    def test_replace_and_pushpop(self):
+        for data in self.datasets():
+            heap = list(data[:100])
+            heapq.heapify(heap)
+            jheap = jl.jlist(data[:100])
+            jl.heapify(jheap)
+
+            for value in data[100:]:
+                self.assertEqual(jl.heapreplace(jheap, value),
+                                 heapq.heapreplace(heap, value))
+                self.assertEqual(jl.heappushpop(jheap, value),
+                                 heapq.heappushpop(heap, value))
+            self.assertEqual(list(jheap), heap)
+
+        with self.assertRaises(IndexError):
+            jl.heapreplace(jl.jlist(), 1)
+
+    def test_push_changes_tag(self):
+        jheap = jl.jlist([3, 1, 2])
+        jl.heapify(jheap)
+        jl.heappush(jheap, 0.5)
+        self.assertEqual(jheap.tag, 'heterogeneous_ob')
+        self.assertEqual([jl.heappop(jheap) for _ in range(4)], [0.5, 1, 2, 3])
+
+    def test_unorderable(self):
+        jheap = jl.jlist([object(), object()])
+        with self.assertRaises(TypeError):
+            jl.heapify(jheap)
+
+    def test_nsmallest_nlargest(self):
+        for data in self.datasets():
+            for n in (-1, 0, 1, 10, len(data), len(data) + 1):
+                jlist = jl.jlist(data)
+                self.assertEqual(list(jl.nsmallest(n, jlist)),
+                                 heapq.nsmallest(n, data))
+                self.assertEqual(list(jl.nlargest(n, jlist)),
+                                 heapq.nlargest(n, data))
+
+        self.assertEqual(jl.nsmallest(2, jl.jlist([3, 1, 2])).tag, 'int')
+
+    def test_nsmallest_stable(self):
+        # equal values keep their original order, like ``sorted``
+        data = [(1,), (0,), (0,), (1,)]
+        self.assertIs(jl.nsmallest(1, jl.jlist(data))[0], data[1])
+        self.assertIs(jl.nlargest(2, jl.jlist(data))[1], data[3])
+
+    def test_fallback(self):
+        heap = [3, 1, 2]
+        jl.heapify(heap)
+        self.assertEqual(heap, [1, 3, 2])
+        self.assertEqual(jl.nsmallest(2, range(10)), [0, 1])
+        self.assertEqual(jl.nlargest(1, jl.jlist([1, -3]), key=abs), [-3])
+
+
+class SelectionTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'select', 'little')
+
+    def datasets(self):
+        return super().datasets(1001)
+
+    def test_partition(self):
+        for data in self.datasets():
+            for k in (0, 1, len(data) // 2, len(data) - 1, -1):
+                jlist = jl.jlist(data)
+                jl.partition(jlist, k)
+                self.assertEqual(sorted(jlist), sorted(data))
+                expected = sorted(data)[k]
+                self.assertEqual(jlist[k], expected)
+                k %= len(data)
+                self.assertTrue(all(v <= expected for v in jlist[:k]))
+                self.assertTrue(all(v >= expected for v in jlist[k + 1:]))
+
+        with self.assertRaises(IndexError):
+            jl.partition(jl.jlist([1, 2]), 2)
+        with self.assertRaises(TypeError):
+            jl.partition([1, 2], 0)
+
+    def test_nth(self):
+        for data in self.datasets():
+            jlist = jl.jlist(data)
+            for k in (0, 1, len(data) // 2, len(data) - 1, -2):
+                self.assertEqual(jl.nth(jlist, k), sorted(data)[k])
+            # the input isn't modified
+            self.assertEqual(list(jlist), data)
+
+        self.assertEqual(jl.nth([3, 1, 2], 0), 1)
+        with self.assertRaises(IndexError):
+            jl.nth(jl.jlist(), 0)
+
+    def test_nth_stable(self):
+        data = [(1,), (0,), (0,), (1,)]
+        self.assertIs(jl.nth(jl.jlist(data), 1), data[2])
+        self.assertIs(jl.nth(jl.jlist(data), 2), data[0])
+
+    def reference_quantile(self, data, q):
+        ordered = sorted(data)
+        pos = q * (len(ordered) - 1)
+        low = int(pos)
+        if low + 1 < len(ordered):
+            return ordered[low] + (ordered[low + 1] - ordered[low]) * (pos - low)
+        return float(ordered[low])
+
+    def test_quantile(self):
+        for data in self.datasets()[:2]:
+            jlist = jl.jlist(data)
+            qs = [0, 0.01, 0.5, 0.99, 1, 0.25]
+            for q in qs:
+                self.assertAlmostEqual(jl.quantile(jlist, q),
+                                       self.reference_quantile(data, q))
+
+            result = jl.quantile(jlist, qs)
+            self.assertEqual(result.tag, 'double')
+            for q, actual in zip(qs, result):
+                self.assertAlmostEqual(actual, self.reference_quantile(data, q))
+
+    def test_median(self):
+        self.assertEqual(jl.median(jl.jlist([3, 1, 2])), 2.0)
+        self.assertEqual(jl.median(jl.jlist([4, 1, 3, 2])), 2.5)
+        self.assertEqual(jl.median([0.5]), 0.5)
+
+    def test_quantile_errors(self):
+        with self.assertRaises(ValueError):
+            jl.quantile(jl.jlist([1]), 1.5)
+        with self.assertRaises(ValueError):
+            jl.median(jl.jlist())
+        with self.assertRaises(TypeError):
+            jl.median(jl.jlist(['a']))
+
+    def test_topk(self):
+        for data in self.datasets():
+            for k in (0, 1, 10, len(data) // 2, len(data) + 1):
+                self.assertEqual(list(jl.topk(jl.jlist(data), k)),
+                                 sorted(data, reverse=True)[:k])
+
+
+class ArgsortTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'argsort', 'little')
+
+    def datasets(self):
+        return super().datasets(1000) + [
+            [self.random.randrange(-10, 10) for _ in range(1000)],
+            [self.random.randrange(-2 ** 63, 2 ** 63) for _ in range(1000)],
+            [self.random.choice([-1.5, -0.0, 0.0, 2.5, -1e300, 1e300])
+             for _ in range(1000)],
+            [self.random.random() - 0.5 for _ in range(10)],
+        ]
+
+    def test_argsort(self):
+        for data in self.datasets():
+            expected = sorted(range(len(data)), key=data.__getitem__)
+            actual = jl.argsort(jl.jlist(data))
+            self.assertEqual(actual.tag, 'int')
+            self.assertEqual(list(actual), expected)
+
+    def test_argsort_unstable(self):
+        for data in self.datasets():
+            actual = jl.argsort(jl.jlist(data), stable=False)
+            self.assertEqual(sorted(actual), list(range(len(data))))
+            self.assertEqual([data[ix] for ix in actual], sorted(data))
+
+    def test_argsort_empty(self):
+        self.assertEqual(list(jl.argsort(jl.jlist())), [])
+        self.assertEqual(list(jl.argsort([2, 1])), [1, 0])
+
+    def test_take(self):
+        for data in self.datasets():
+            jlist = jl.jlist(data)
+            taken = jl.take(jlist, jl.argsort(jlist))
+            self.assertEqual(taken.tag, jlist.tag)
+            self.assertEqual(list(taken), sorted(data))
+
+        self.assertEqual(list(jl.take(['a', 'b', 'c'], [-1, 0, 0])),
+                         ['c', 'a', 'a'])
+        with self.assertRaises(IndexError):
+            jl.take(jl.jlist([1, 2]), [2])
+        with self.assertRaises(TypeError):
+            jl.take(jl.jlist([1, 2]), [0.5])
+
+
+class SearchsortedTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'search', 'little')
+
+    def check(self, haystack, probes):
+        jhaystack = jl.jlist(haystack)
+        for side, bisect_f in (('left', bisect.bisect_left),
+                               ('right', bisect.bisect_right)):
+            expected = [bisect_f(haystack, p) for p in probes]
+            for p, e in zip(probes, expected):
+                self.assertEqual(jl.searchsorted(jhaystack, p, side=side), e)
+
+            actual = jl.searchsorted(jhaystack, jl.jlist(probes), side)
+            self.assertEqual(actual.tag, 'int')
+            self.assertEqual(list(actual), expected)
+            self.assertEqual(list(jl.searchsorted(jhaystack, probes, side)),
+                             expected)
+
+    def test_int(self):
+        haystack = sorted(self.random.randrange(-50, 50) for _ in range(300))
+        probes = [self.random.randrange(-60, 60) for _ in range(100)]
+        self.check(haystack, probes)
+        self.check(haystack, sorted(probes))
+        self.check(haystack, [2 ** 70, -2 ** 70, 0.5, -0.5])
+
+    def test_double(self):
+        haystack = sorted(self.random.random() for _ in range(300))
+        probes = [self.random.random() for _ in range(100)]
+        self.check(haystack, probes)
+        self.check(haystack, sorted(probes))
+        self.check(haystack, [0, 1, 2 ** 60 + 1, -1])
+
+    def test_object(self):
+        haystack = sorted(str(self.random.randrange(100)) for _ in range(300))
+        self.check(haystack, [str(self.random.randrange(100)) for _ in range(10)])
+
+    def test_empty(self):
+        self.check([], [1, 2.5, 'a'])
+        self.check([1, 2, 3], [])
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.searchsorted(jl.jlist([1]), 1, side='middle')
+        with self.assertRaises(TypeError):
+            jl.searchsorted([1], 1)
+        with self.assertRaises(TypeError):
+            jl.searchsorted(jl.jlist([1]), 'a')
+
+
+class MergeTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'merge', 'little')
+
+    def check(self, *inputs):
+        expected = list(heapq.merge(*inputs))
+        actual = jl.merge(*map(jl.jlist, inputs))
+        self.assertEqual(list(actual), expected)
+        self.assertEqual(actual, jl.jlist(expected))
+        return actual
+
+    def test_int(self):
+        for k in range(1, 10):
+            runs = [
+                sorted(self.random.randrange(100)
+                       for _ in range(self.random.randrange(50)))
+                for _ in range(k)
+            ]
+            self.assertIn(self.check(*runs).tag, ('int', 'unset'))
+
+    def test_double(self):
+        runs = [sorted(self.random.random() for _ in range(100))
+                for _ in range(5)]
+        self.assertEqual(self.check(*runs).tag, 'double')
+
+    def test_disjoint(self):
+        self.check([5, 6], [1, 2, 3], [], [3, 4])
+        self.check([0.5], [-1.5, 0.5])
+
+    def test_objects(self):
+        runs = [sorted(str(self.random.randrange(100)) for _ in range(20))
+                for _ in range(4)]
+        self.assertEqual(self.check(*runs).tag, 'homogeneous_ob')
+
+    def test_mixed(self):
+        self.assertEqual(self.check([1, 3], [1.5, 2.5], [2]).tag,
+                         'heterogeneous_ob')
+
+    def test_stable(self):
+        a = [(0,), (1,)]
+        b = [(0,), (1,)]
+        merged = jl.merge(jl.jlist(b), jl.jlist(a))
+        self.assertIs(merged[0], b[0])
+        self.assertIs(merged[1], a[0])
+        self.assertIs(merged[2], b[1])
+
+    def test_empty(self):
+        self.assertEqual(list(jl.merge()), [])
+        self.assertEqual(list(jl.merge(jl.jlist(), [])), [])
+
+    def test_unorderable(self):
+        with self.assertRaises(TypeError):
+            jl.merge([1], ['a'])
+
+
+class RollingTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'rolling', 'little')
+
+    def windows(self, values, window):
+        return [values[i:i + window] for i in range(len(values) - window + 1)]
+
+    def check(self, f, expected_f, values, window, tag):
+        actual = f(jl.jlist(values), window)
+        self.assertEqual(actual.tag, tag)
+        expected = [expected_f(w) for w in self.windows(values, window)]
+        self.assertEqual(len(actual), len(expected))
+        for a, e in zip(actual, expected):
+            self.assertAlmostEqual(a, e)
+
+    def test_int(self):
+        values = [self.random.randrange(-100, 100) for _ in range(200)]
+        for window in (1, 2, 7, 200):
+            self.check(jl.rolling_sum, sum, values, window, 'int')
+            self.check(jl.rolling_min, min, values, window, 'int')
+            self.check(jl.rolling_max, max, values, window, 'int')
+            self.check(jl.rolling_mean,
+                       lambda w: sum(w) / len(w),
+                       values,
+                       window,
+                       'double')
+
+    def test_double(self):
+        values = [self.random.uniform(-1, 1) for _ in range(200)]
+        for window in (1, 3, 50):
+            self.check(jl.rolling_sum, math.fsum, values, window, 'double')
+            self.check(jl.rolling_min, min, values, window, 'double')
+            self.check(jl.rolling_max, max, values, window, 'double')
+            self.check(jl.rolling_mean,
+                       lambda w: math.fsum(w) / len(w),
+                       values,
+                       window,
+                       'double')
+
+    def test_std(self):
+        values = [self.random.uniform(1e6, 1e6 + 1) for _ in range(300)]
+        for window in (2, 10, 100):
+            self.check(jl.rolling_std,
+                       statistics.pstdev,
+                       values,
+                       window,
+                       'double')
+            actual = jl.rolling_std(values, window, ddof=1)
+            expected = map(statistics.stdev, self.windows(values, window))
+            for a, e in zip(actual, expected):
+                self.assertAlmostEqual(a, e)
+
+    def test_non_finite(self):
+        inf = float('inf')
+        values = [1.0, inf, 2.0, 3.0, -inf, 4.0, 5.0]
+        self.assertEqual(
+            list(jl.rolling_sum(values, 2)),
+            [inf, inf, 5.0, -inf, -inf, 9.0],
+        )
+        self.assertTrue(math.isnan(jl.rolling_sum([inf, -inf], 2)[0]))
+        std = jl.rolling_std(values, 2)
+        self.assertTrue(math.isnan(std[0]))
+        self.assertEqual(std[2], 0.5)
+
+    def test_short(self):
+        self.assertEqual(list(jl.rolling_sum([1, 2], 3)), [])
+        self.assertEqual(list(jl.rolling_max([], 1)), [])
+
+    def test_overflow(self):
+        big = 2 ** 62
+        self.assertEqual(list(jl.rolling_sum([big, big, -big], 3)), [big])
+        self.assertEqual(jl.rolling_sum([big, big, -big], 3).tag, 'int')
+
+        # like sum, sums which don't fit in an int64 fall back to Python ints
+        values = [big, big, -big, 1, -2 ** 63, -2 ** 63]
+        expected = [sum(values[i:i + 2]) for i in range(len(values) - 1)]
+        out = jl.rolling_sum(values, 2)
+        self.assertEqual(list(out), expected)
+        self.assertTrue(all(type(value) is int for value in out))
+        self.assertEqual(list(jl.rolling_sum([2 ** 63 - 1] * 4, 4)), [4 * (2 ** 63 - 1)])
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.rolling_sum([1, 2], 0)
+        with self.assertRaises(ValueError):
+            jl.rolling_std([1, 2], 1, ddof=1)
+        # the arguments are checked even when there are no full windows
+        with self.assertRaises(ValueError):
+            jl.rolling_std([1, 2], 3, ddof=3)
+        with self.assertRaises(ValueError):
+            jl.rolling_std([], 1, ddof=1)
+        with self.assertRaises(TypeError):
+            jl.rolling_mean(['a', 'b'], 1)
+
+
+class GroupTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'group', 'little')
+
+    def expected(self, f, values, keys):
+        groups = collections.defaultdict(list)
+        for value, key in zip(values, keys):
+            groups[key].append(value)
+        out_keys = sorted(groups)
+        return out_keys, [f(groups[key]) for key in out_keys]
+
+    def check(self, keys):
+        values = [self.random.randrange(-100, 100) for _ in keys]
+        floats = [self.random.random() for _ in keys]
+
+        out_keys, counts = jl.group_count(jl.jlist(keys))
+        self.assertEqual(
+            (list(out_keys), list(counts)),
+            self.expected(len, keys, keys),
+        )
+        self.assertEqual(counts.tag, 'int')
+
+        cases = [
+            (jl.group_sum, sum, 'int'),
+            (jl.group_min, min, 'int'),
+            (jl.group_max, max, 'int'),
+        ]
+        for f, expected_f, tag in cases:
+            out_keys, out = f(jl.jlist(values), jl.jlist(keys))
+            self.assertEqual(
+                (list(out_keys), list(out)),
+                self.expected(expected_f, values, keys),
+            )
+            self.assertEqual(out.tag, tag)
+
+            out_keys, out = f(jl.jlist(floats), jl.jlist(keys))
+            expected_keys, expected = self.expected(expected_f, floats, keys)
+            self.assertEqual(list(out_keys), expected_keys)
+            for a, e in zip(out, expected):
+                self.assertAlmostEqual(a, e)
+            self.assertEqual(out.tag, 'double')
+
+        out_keys, out = jl.group_mean(jl.jlist(values), jl.jlist(keys))
+        expected_keys, expected = self.expected(statistics.fmean, values, keys)
+        self.assertEqual(list(out_keys), expected_keys)
+        for a, e in zip(out, expected):
+            self.assertAlmostEqual(a, e)
+
+    def test_dense(self):
+        self.check([self.random.randrange(-5, 20) for _ in range(500)])
+
+    def test_sorted(self):
+        self.check(sorted(self.random.randrange(100) for _ in range(500)))
+
+    def test_sparse(self):
+        keys = [self.random.randrange(-2 ** 63, 2 ** 63) for _ in range(50)]
+        self.check([self.random.choice(keys) for _ in range(500)])
+
+    def test_extreme_keys(self):
+        self.check([2 ** 63 - 1, -2 ** 63, 2 ** 63 - 1, 0])
+
+    def test_empty(self):
+        out_keys, out = jl.group_sum(jl.jlist(), jl.jlist())
+        self.assertEqual(list(out_keys), [])
+        self.assertEqual(list(out), [])
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.group_sum([1, 2], [1])
+        with self.assertRaises(TypeError):
+            jl.group_sum([1, 2], [1.5, 2.5])
+        with self.assertRaises(TypeError):
+            jl.group_max(['a', 'b'], [1, 2])
+
+    def test_overflow(self):
+        big = 2 ** 62
+        for keys in [0, 0, 1, 1], [0, 1, 0, 1]:
+            for values in [big, big, -big, -big - 1], [big, -big, big - 1, -big]:
+                out_keys, out = jl.group_sum(values, keys)
+                expected_keys, expected = self.expected(sum, values, keys)
+                self.assertEqual((list(out_keys), list(out)), (expected_keys, expected))
+                fits = all(-2 ** 63 <= total < 2 ** 63 for total in expected)
+                self.assertEqual(out.tag, 'int' if fits else 'homogeneous_ob')
+
+
+class JoinIndicesTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'join', 'little')
+
+    def expected(self, left, right, how):
+        left_ix = []
+        right_ix = []
+        for i, a in enumerate(left):
+            matched = False
+            for j, b in enumerate(right):
+                if a == b:
+                    left_ix.append(i)
+                    right_ix.append(j)
+                    matched = True
+            if how == 'left' and not matched:
+                left_ix.append(i)
+                right_ix.append(-1)
+        return left_ix, right_ix
+
+    def check(self, left, right):
+        for how in ('inner', 'left'):
+            left_ix, right_ix = jl.join_indices(jl.jlist(left),
+                                                jl.jlist(right),
+                                                how=how)
+            self.assertEqual(left_ix.tag, 'int')
+            self.assertEqual(right_ix.tag, 'int')
+            self.assertEqual(
+                (list(left_ix), list(right_ix)),
+                self.expected(left, right, how),
+            )
+
+    def test_hash(self):
+        left = [self.random.randrange(20) for _ in range(100)]
+        right = [self.random.randrange(30) for _ in range(50)]
+        self.check(left, right)
+
+    def test_merge(self):
+        left = sorted(self.random.randrange(20) for _ in range(100))
+        right = sorted(self.random.randrange(30) for _ in range(50))
+        self.check(left, right)
+
+    def test_one_sorted(self):
+        left = sorted(self.random.randrange(20) for _ in range(100))
+        right = [self.random.randrange(30) for _ in range(50)]
+        self.check(left, right)
+        self.check(right, left)
+
+    def test_empty(self):
+        self.check([], [1, 2])
+        self.check([1, 2], [])
+        self.check([], [])
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.join_indices([1], [1], how='outer')
+        with self.assertRaises(TypeError):
+            jl.join_indices([1.5], [1])
+
+
+class FingerprintTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'fingerprint', 'little')
+
+    def test_stable(self):
+        # the fingerprint must not change between processes or releases
+        self.assertEqual(jl.fingerprint([1, 2, 3]), 17939996888162476042)
+        self.assertEqual(
+            jl.fingerprint(['a', 'bc'], bits=128),
+            238896571879810891227812686430774307768,
+        )
+        self.assertEqual(
+            jl.fingerprint(jl.range(100), seed=7),
+            15352770492517686001,
+        )
+
+    def test_range(self):
+        for values in [[], [1], [1.5], ['a'], list(range(1000))]:
+            self.assertIn(jl.fingerprint(values), range(2 ** 64))
+            self.assertIn(jl.fingerprint(values, bits=128), range(2 ** 128))
+            self.assertEqual(
+                jl.fingerprint(values, bits=128) % 2 ** 64,
+                jl.fingerprint(values),
+            )
+
+    def test_content(self):
+        # every size around the short input and stripe boundaries
+        for size in range(300):
+            values = [self.random.randrange(-2 ** 63, 2 ** 63) for _ in range(size)]
+            expected = jl.fingerprint(values)
+            self.assertEqual(jl.fingerprint(jl.jlist(values)), expected)
+            self.assertEqual(jl.fingerprint(tuple(values)), expected)
+
+            for ix in range(size):
+                changed = list(values)
+                changed[ix] ^= 1 << self.random.randrange(63)
+                self.assertNotEqual(jl.fingerprint(changed), expected)
+
+            self.assertNotEqual(jl.fingerprint(values + [0]), expected)
+
+    def test_no_collisions(self):
+        fingerprints = {jl.fingerprint([ix]) for ix in range(10000)}
+        fingerprints |= {jl.fingerprint(range(ix)) for ix in range(2, 1002)}
+        fingerprints |= {jl.fingerprint([str(ix)]) for ix in range(10000)}
+        self.assertEqual(len(fingerprints), 21000)
+
+    def test_strings(self):
+        strings = ['', 'a', 'ab', 'abc', 'abcd', 'abcdefgh', 'x' * 17, 'é', '𝄞']
+        fingerprints = {jl.fingerprint([s]) for s in strings}
+        self.assertEqual(len(fingerprints), len(strings))
+
+        self.assertNotEqual(
+            jl.fingerprint(['ab', 'c']),
+            jl.fingerprint(['a', 'bc']),
+        )
+        self.assertNotEqual(jl.fingerprint(['a']), jl.fingerprint([b'a']))
+        self.assertEqual(
+            jl.fingerprint(['a', b'b']),
+            jl.fingerprint(jl.jlist(['a', b'b'])),
+        )
+
+        # equal strings built differently have the same payload
+        self.assertEqual(
+            jl.fingerprint([''.join(['ab', 'c'])]),
+            jl.fingerprint(['abc']),
+        )
+
+    def test_tags_differ(self):
+        self.assertNotEqual(jl.fingerprint([1]), jl.fingerprint([1.0]))
+        self.assertEqual(jl.fingerprint([]), jl.fingerprint(jl.jlist()))
+
+        emptied = jl.jlist([1, 2])
+        emptied.clear()
+        self.assertEqual(jl.fingerprint(emptied), jl.fingerprint([]))
+
+    def test_mixed(self):
+        values = [1, -1, 2 ** 64, -2 ** 70, 255, 256, 1.5, 'a', b'a', 0]
+        fingerprints = {jl.fingerprint([value, 'a']) for value in values}
+        self.assertEqual(len(fingerprints), len(values))
+        self.assertEqual(
+            jl.fingerprint([2 ** 70, 1]),
+            jl.fingerprint(jl.jlist([2 ** 70, 1])),
+        )
+        self.assertNotEqual(jl.fingerprint([2 ** 70]), jl.fingerprint([2 ** 71]))
+        self.assertNotEqual(jl.fingerprint([1, 'a']), jl.fingerprint([1.0, 'a']))
+
+    def test_seed(self):
+        values = [1, 2, 3]
+        self.assertNotEqual(
+            jl.fingerprint(values, seed=1),
+            jl.fingerprint(values),
+        )
+        self.assertEqual(jl.fingerprint(values, seed=0), jl.fingerprint(values))
+
+    def test_errors(self):
+        with self.assertRaises(TypeError):
+            jl.fingerprint([object()])
+        with self.assertRaisesRegex(TypeError, 'got NoneType'):
+            jl.fingerprint([1, None])
+        with self.assertRaises(ValueError):
+            jl.fingerprint([1], bits=32)
+
+
+class CompareTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'compare', 'little')
+    OPS = {
+        '<': ('lt', lambda a, b: a < b),
+        '<=': ('le', lambda a, b: a <= b),
+        '==': ('eq', lambda a, b: a == b),
+        '!=': ('ne', lambda a, b: a != b),
+        '>': ('gt', lambda a, b: a > b),
+        '>=': ('ge', lambda a, b: a >= b),
+    }
+
+    def assert_compares(self, values, scalar):
+        for symbol, (name, op) in self.OPS.items():
+            expected = [bool(op(value, scalar)) for value in values]
+            mask = getattr(jl, name)(values, scalar)
+            self.assertIsInstance(mask, jl.jlist)
+            self.assertEqual(list(mask), expected, (name, scalar))
+            for result in mask:
+                self.assertIs(type(result), bool)
+            self.assertEqual(
+                jl.count_where(values, symbol, scalar),
+                sum(expected),
+                (symbol, scalar),
+            )
+            self.assertEqual(
+                jl.count_where(values, name, scalar),
+                sum(expected),
+            )
+
+    def test_ints(self):
+        values = jl.jlist(self.random.randrange(-100, 100) for _ in range(1000))
+        values.extend([2 ** 63 - 1, -2 ** 63])
+        scalars = [
+            0, 5, -100, 2 ** 63 - 1, 2 ** 64, -2 ** 70, True,
+            0.5, -0.5, 5.0, math.nan, math.inf, -math.inf, 2.0 ** 63, -2.0 ** 63,
+            9.3e18, 'a',
+        ]
+        for scalar in scalars:
+            if isinstance(scalar, str):
+                with self.assertRaises(TypeError):
+                    jl.lt(values, scalar)
+                self.assertEqual(list(jl.eq(values, scalar)), [False] * len(values))
+                continue
+            self.assert_compares(values, scalar)
+
+    def test_doubles(self):
+        values = jl.jlist(self.random.uniform(-10, 10) for _ in range(1000))
+        values.extend([0.0, -0.0, math.nan, math.inf, 3.0])
+        scalars = [0, 3, 3.0, -0.0, math.nan, math.inf, 2 ** 53 + 1, 2 ** 80]
+        for scalar in scalars:
+            self.assert_compares(values, scalar)
+        self.assertEqual(values.tag, 'double')
+
+    def test_objects(self):
+        self.assert_compares(['a', 'b', 'c', 'b'], 'b')
+        self.assert_compares([1, 2.5, 3, True], 2)
+        self.assert_compares([(1, 2), (0, 5)], (1, 0))
+        self.assert_compares([], 1)
+        self.assert_compares(range(10), 4)
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.count_where([1], '<>', 1)
+        with self.assertRaises(ValueError):
+            jl.count_where([1], None, 1)
+        with self.assertRaises(TypeError):
+            jl.count_where(['a', 1], '<', 'b')
+
+    def test_mutated_while_comparing(self):
+        values = jl.jlist(['a', 'b', 'c'])
+
+        class clears_list:
+            def __eq__(self, other):
+                values.clear()
+                return False
+
+        with self.assertRaises(RuntimeError):
+            jl.eq(values, clears_list())
+
+    def test_filter_mask(self):
+        values = jl.range(20)
+        self.assertEqual(
+            jl.filter_mask(values, jl.ge(values, 15)),
+            jl.jlist([15, 16, 17, 18, 19]),
+        )
+
+
+class VectorTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'vector', 'little')
+
+    def random_pair(self, n, kind):
+        if kind == 'int':
+            return (
+                jl.jlist(self.random.randrange(-1000, 1000) for _ in range(n)),
+                jl.jlist(self.random.randrange(-1000, 1000) for _ in range(n)),
+            )
+        return (
+            jl.jlist(self.random.uniform(-10, 10) for _ in range(n)),
+            jl.jlist(self.random.uniform(-10, 10) for _ in range(n)),
+        )
+
+    def test_dot(self):
+        for n in [0, 1, 7, 8, 9, 100, 1001]:
+            a, b = self.random_pair(n, 'int')
+            expected = sum(x * y for x, y in zip(a, b))
+            self.assertEqual(jl.dot(a, b), expected)
+            self.assertIs(type(jl.dot(a, b)), int)
+
+            a, b = self.random_pair(n, 'double')
+            expected = sum(x * y for x, y in zip(a, b))
+            self.assertAlmostEqual(jl.dot(a, b), expected, places=9)
+
+            # mixed ints and floats are computed in doubles
+            ints, _ = self.random_pair(n, 'int')
+            expected = sum(x * y for x, y in zip(ints, b))
+            self.assertAlmostEqual(jl.dot(ints, b), expected, places=9)
+            self.assertAlmostEqual(jl.dot(b, ints), expected, places=9)
+
+    def test_dot_exact(self):
+        big = [2 ** 63 - 1, -2 ** 63, 2 ** 62]
+        self.assertEqual(jl.dot(big, big), sum(x * x for x in big))
+        self.assertEqual(jl.dot(big * 10, big * 10), 10 * sum(x * x for x in big))
+        self.assertEqual(jl.dot([2 ** 80, 3], [2, 1]), 2 ** 81 + 3)
+
+    def test_dot_objects(self):
+        self.assertEqual(jl.dot([1, 2.5, True], [2, 2, 3]), 10.0)
+        with self.assertRaises(TypeError):
+            jl.dot(['a'], [2])
+
+    def test_sqdist(self):
+        for n in [0, 1, 9, 1000]:
+            for kind in ['int', 'double']:
+                a, b = self.random_pair(n, kind)
+                expected = sum((x - y) ** 2 for x, y in zip(a, b))
+                self.assertAlmostEqual(jl.sqdist(a, b), expected, places=9)
+                self.assertIs(type(jl.sqdist(a, b)), type(expected))
+
+        big = [2 ** 63 - 1, -2 ** 63]
+        self.assertEqual(jl.sqdist(big, big[::-1]), 2 * (2 ** 64 - 1) ** 2)
+        self.assertEqual(jl.sqdist([2 ** 80], [1]), (2 ** 80 - 1) ** 2)
+
+    def test_length_mismatch(self):
+        for f in [jl.dot, jl.sqdist]:
+            with self.assertRaises(ValueError):
+                f([1, 2], [1])
+
+    def test_norm(self):
+        for kind in ['int', 'double']:
+            values, _ = self.random_pair(1000, kind)
+            self.assertAlmostEqual(jl.norm(values), math.hypot(*values))
+            self.assertAlmostEqual(
+                jl.norm(values, 1),
+                sum(abs(x) for x in values),
+                places=9,
+            )
+            self.assertEqual(
+                jl.norm(values, ord=math.inf),
+                max(abs(x) for x in values),
+            )
+            self.assertAlmostEqual(
+                jl.norm(values, 3),
+                sum(abs(x) ** 3 for x in values) ** (1 / 3),
+            )
+
+        self.assertEqual(jl.norm([]), 0.0)
+        self.assertEqual(jl.norm([0, 0]), 0.0)
+        self.assertEqual(jl.norm([3, 4]), 5.0)
+
+    def test_norm_scaling(self):
+        for values in [[1e300, 1e300], [1e-300, 1e-300], [1e200, 1]]:
+            self.assertAlmostEqual(
+                jl.norm(values) / math.hypot(*values),
+                1.0,
+                places=14,
+            )
+        self.assertEqual(jl.norm([1.0, math.inf]), math.inf)
+        self.assertTrue(math.isnan(jl.norm([1.0, math.nan])))
+        self.assertTrue(math.isnan(jl.norm([1.0, math.nan], math.inf)))
+
+    def test_norm_errors(self):
+        with self.assertRaises(TypeError):
+            jl.norm(['a'])
+        for ord in [0, -1, math.nan]:
+            with self.assertRaises(ValueError):
+                jl.norm([1], ord)
+
+
+class ElementwiseTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'elementwise', 'little')
+
+    def assert_matches(self, f, expected_f, values, **kwargs):
+        result = f(values, **kwargs)
+        expected = jl.jlist(expected_f(value) for value in values)
+        self.assertIs(type(result), jl.jlist)
+        self.assertEqual(len(result), len(expected))
+        for actual, want in zip(result, expected):
+            self.assertIs(type(actual), type(want), (actual, want))
+            if want != want:
+                self.assertNotEqual(actual, actual)
+            else:
+                self.assertEqual(actual, want)
+        self.assertEqual(result.tag, expected.tag)
+
+    def assert_raises_like(self, f, expected_f, value):
+        with self.assertRaises(Exception) as expected:
+            expected_f(value)
+        with self.assertRaises(type(expected.exception)):
+            f(jl.jlist([1.0, value]))
+
+    def test_unary(self):
+        ints = jl.jlist(self.random.randrange(-1000, 1000) for _ in range(100))
+        doubles = jl.jlist(self.random.uniform(-1000, 1000) for _ in range(100))
+        special = jl.jlist([0.0, -0.0, math.inf, -math.inf, math.nan])
+        mixed = jl.jlist([-1, 2.5, True, -4.0])
+        cases = [
+            (jl.abs, abs),
+            (jl.floor, math.floor),
+            (jl.sqrt, math.sqrt),
+            (jl.log, math.log),
+            (jl.exp, math.exp),
+        ]
+        for f, expected_f in cases:
+            for values in ints, doubles, special, mixed, jl.jlist():
+                if f in (jl.sqrt, jl.log):
+                    values = jl.jlist(value for value in values if value > 0)
+                if f is jl.exp:
+                    values = jl.jlist(value / 100 for value in values)
+                if f is jl.floor:
+                    values = jl.jlist(value for value in values if math.isfinite(value))
+                self.assert_matches(f, expected_f, values)
+
+        self.assert_matches(jl.abs, abs, jl.jlist([-2 ** 63, 5]))
+        self.assert_matches(jl.floor, math.floor, jl.jlist([2 ** 63 - 1, 1e30]))
+        self.assert_matches(jl.sqrt, math.sqrt, special[:1] + [math.inf, math.nan])
+        self.assert_matches(jl.exp, math.exp, special)
+        self.assert_matches(jl.log, math.log, [math.inf, math.nan, 2 ** 80])
+
+    def test_domain_errors(self):
+        self.assert_raises_like(jl.sqrt, math.sqrt, -1.0)
+        self.assert_raises_like(jl.log, math.log, 0)
+        self.assert_raises_like(jl.log, math.log, -0.5)
+        self.assert_raises_like(jl.exp, math.exp, 1000.0)
+        self.assert_raises_like(jl.floor, math.floor, math.inf)
+        self.assert_raises_like(jl.floor, math.floor, math.nan)
+        self.assert_raises_like(jl.round, round, math.inf)
+        self.assert_raises_like(jl.abs, abs, 'a')
+
+    def test_round(self):
+        doubles = jl.jlist(
+            self.random.uniform(-1e6, 1e6) * 10.0 ** self.random.randrange(-8, 8)
+            for _ in range(200)
+        )
+        ties = jl.jlist([0.5, 1.5, 2.5, -0.5, -1.5, 2.675, 1.005, 0.125, 1250.0])
+        ints = jl.jlist(self.random.randrange(-10 ** 12, 10 ** 12) for _ in range(200))
+        ints.extend([5, 15, 25, -15, -25, 2 ** 63 - 1, -2 ** 63])
+
+        self.assert_matches(jl.round, round, doubles)
+        self.assert_matches(jl.round, round, ties)
+        self.assert_matches(jl.round, round, ints)
+        for ndigits in range(-20, 25):
+            for values in doubles, ties, ints, jl.jlist([math.inf, math.nan]):
+                self.assert_matches(
+                    jl.round,
+                    lambda value: round(value, ndigits),
+                    values,
+                    ndigits=ndigits,
+                )
+        # ndigits past Py_ssize_t, but not for ints, which `round` takes 10 ** -ndigits of
+        for ndigits, values in [
+            (-10 ** 30, ties),
+            (10 ** 30, ties),
+            (-2 ** 63, ties),
+            (10 ** 30, jl.jlist([5, 123, -2 ** 63])),
+            (-400, jl.jlist([5, 123, -2 ** 63])),
+        ]:
+            self.assert_matches(
+                jl.round,
+                lambda value: round(value, ndigits),
+                values,
+                ndigits=ndigits,
+            )
+
+        self.assert_matches(
+            jl.round,
+            lambda value: round(value, 1),
+            jl.jlist([fractions.Fraction(1, 3), 0.25, 5]),
+            ndigits=1,
+        )
+
+    def test_clip(self):
+        ints = jl.jlist(self.random.randrange(-100, 100) for _ in range(100))
+        doubles = jl.jlist(self.random.uniform(-100, 100) for _ in range(100))
+        doubles.append(math.nan)
+
+        def clip(lo, hi):
+            def f(value):
+                if lo is not None:
+                    value = max(value, lo)
+                if hi is not None:
+                    value = min(value, hi)
+                return value
+            return f
+
+        for lo, hi in [(-10, 10), (None, 0), (0, None), (None, None), (5, -5)]:
+            self.assert_matches(jl.clip, clip(lo, hi), ints, lo=lo, hi=hi)
+            lo, hi = (None if bound is None else float(bound) for bound in (lo, hi))
+            self.assert_matches(jl.clip, clip(lo, hi), doubles, lo=lo, hi=hi)
+
+        # floats clipped to int bounds stay floats
+        result = jl.clip(jl.jlist([-5.0, 5.0]), -1, 1)
+        self.assertEqual(result.tag, 'double')
+        self.assertEqual(list(result), [-1.0, 1.0])
+
+        # ints clipped to float bounds mix like min and max
+        self.assert_matches(jl.clip, clip(-0.5, 2 ** 70), ints, lo=-0.5, hi=2 ** 70)
+        self.assert_matches(jl.clip, clip('b', 'y'), jl.jlist('azby'), lo='b', hi='y')
+
+    def test_out(self):
+        values = jl.jlist([1.0, 4.0, 9.0])
+        self.assertIs(jl.sqrt(values, out=values), values)
+        self.assertEqual(list(values), [1.0, 2.0, 3.0])
+
+        # the results replace the contents and storage of out
+        out = jl.jlist(['a', 'b'])
+        self.assertIs(jl.floor(values, out=out), out)
+        self.assertEqual(list(out), [1, 2, 3])
+        self.assertEqual(out.tag, 'int')
+
+        out = jl.jlist([0.5])
+        self.assertIs(jl.abs([-1], out=out), out)
+        self.assertEqual(list(out), [1])
+
+        self.assertIs(jl.clip(jl.jlist('ab'), 'b', out=out), out)
+        self.assertEqual(list(out), ['b', 'b'])
+
+        out.build_index()
+        jl.round(jl.jlist([1.5]), out=out)
+        self.assertFalse(out.indexed)
+        self.assertEqual(out.index(2), 0)
+
+        with self.assertRaises(TypeError):
+            jl.abs([1], out=[])
+        with self.assertRaises(TypeError):
+            jl.abs([1], out=jl.freeze([1]))
+
+
+class AstypeTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'astype', 'little')
+
+    def assert_converts(self, values, dtype, expected_f, **kwargs):
+        result = jl.astype(values, dtype, **kwargs)
+        expected = jl.jlist(map(expected_f, values))
+        self.assertIs(type(result), jl.jlist)
+        self.assertEqual(list(result), list(expected))
+        self.assertEqual(
+            [type(value) for value in result],
+            [type(value) for value in expected],
+        )
+        return result
+
+    def test_double(self):
+        ints = jl.jlist(self.random.randrange(-2 ** 63, 2 ** 63) for _ in range(100))
+        result = self.assert_converts(ints, 'double', float)
+        self.assertEqual(result.tag, 'double')
+        self.assertEqual(ints.tag, 'int')
+
+        self.assert_converts(jl.jlist([1.5, -0.0]), 'double', float)
+        self.assert_converts(jl.jlist(['1.5', 2, True, 2 ** 70]), 'double', float)
+        with self.assertRaises(ValueError):
+            jl.astype(['a'], 'double')
+
+    def test_int(self):
+        doubles = jl.jlist(self.random.uniform(-100, 100) for _ in range(100))
+        doubles.extend([0.5, 1.5, 2.5, -0.5, -1.5, -0.0])
+        roundings = [
+            (None, int),
+            ('trunc', int),
+            ('floor', math.floor),
+            ('ceil', math.ceil),
+            ('nearest', round),
+        ]
+        for rounding, expected_f in roundings:
+            result = self.assert_converts(doubles, 'int', expected_f, rounding=rounding)
+            self.assertEqual(result.tag, 'int')
+
+            # values which don't fit in 64 bits become Python ints
+            big = jl.jlist([1e30, -1.5])
+            result = self.assert_converts(big, 'int', expected_f, rounding=rounding)
+            self.assertEqual(result.tag, 'homogeneous_ob')
+
+            for special in math.nan, math.inf:
+                with self.assertRaises((ValueError, OverflowError)):
+                    jl.astype([1.0, special], 'int', rounding=rounding)
+
+        self.assert_converts(jl.jlist([1, 2]), 'int', int)
+        self.assert_converts(jl.jlist(['3', 2.7, True]), 'int', int)
+        self.assert_converts(jl.jlist([2.5, 3]), 'int', round, rounding='nearest')
+
+    def test_object(self):
+        for values in jl.jlist([1, -2]), jl.jlist([1.5, math.nan]), jl.jlist('ab'):
+            result = jl.astype(values, 'object')
+            self.assertEqual(result.tag, 'homogeneous_ob')
+            self.assertEqual(list(map(type, result)), list(map(type, values)))
+            self.assertEqual(result[0], values[0])
+
+    def test_copies(self):
+        for values, dtype in [
+                (jl.jlist([1]), 'int'),
+                (jl.jlist([1.0]), 'double'),
+                (jl.jlist(['a']), 'object'),
+                (jl.jlist(), 'double'),
+                (jl.freeze([1]), 'double'),
+        ]:
+            before = list(values)
+            result = jl.astype(values, dtype)
+            self.assertIsNot(result, values)
+            self.assertIs(type(result), jl.jlist)
+            result.append(2)
+            self.assertEqual(list(values), before)
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            jl.astype([1], 'float')
+        with self.assertRaises(ValueError):
+            jl.astype([1], 'int', rounding='up')
+        with self.assertRaises(ValueError):
+            jl.astype([1], 'double', rounding='floor')
+
+
+class RandomTestCase(TestCase):
+    def test_random(self):
+        values = jl.random(100000, seed=1)
+        self.assertEqual(values.tag, 'double')
+        self.assertEqual(len(values), 100000)
+        self.assertTrue(all(0 <= value < 1 for value in values))
+        self.assertAlmostEqual(statistics.fmean(values), 0.5, delta=0.01)
+        self.assertAlmostEqual(statistics.pvariance(values), 1 / 12, delta=0.01)
+
+        normal = jl.random(100001, 'normal', seed=1)
+        self.assertEqual(len(normal), 100001)
+        self.assertAlmostEqual(statistics.fmean(normal), 0, delta=0.02)
+        self.assertAlmostEqual(statistics.pstdev(normal), 1, delta=0.02)
+
+        self.assertEqual(jl.random(0), jl.jlist())
+        self.assertEqual(jl.random(0).tag, 'unset')
+
+    def test_seed(self):
+        for dist in 'uniform', 'normal':
+            self.assertEqual(jl.random(9, dist, seed=5), jl.random(9, dist, seed=5))
+            self.assertNotEqual(jl.random(9, dist, seed=5), jl.random(9, dist, seed=6))
+            # a shorter draw is a prefix of a longer one
+            self.assertEqual(jl.random(5, dist, seed=5), jl.random(9, dist, seed=5)[:5])
+        self.assertNotEqual(jl.random(9), jl.random(9))
+        self.assertEqual(jl.random(3, seed=-1), jl.random(3, seed=2 ** 64 - 1))
+
+        with self.assertRaises(TypeError):
+            jl.random(3, seed=1.5)
+        with self.assertRaises(ValueError):
+            jl.random(3, 'cauchy')
+        with self.assertRaises(ValueError):
+            jl.random(-1)
+        with self.assertRaises(MemoryError):
+            jl.random(2 ** 62)
+
+    def test_shuffle(self):
+        for values in [
+                jl.jlist(range(100)),
+                jl.jlist(map(float, range(100))),
+                jl.jlist(map(str, range(100))),
+                jl.jlist([1, 'a', None, 2.5]),
+                jl.jlist(),
+        ]:
+            tag = values.tag
+            expected = sorted(values, key=repr)
+            self.assertIsNone(jl.shuffle(values, seed=3))
+            self.assertEqual(sorted(values, key=repr), expected)
+            self.assertEqual(values.tag, tag)
+
+        a = jl.jlist(range(20))
+        b = jl.jlist(range(20))
+        jl.shuffle(a, seed=7)
+        jl.shuffle(b, seed=7)
+        self.assertEqual(a, b)
+        self.assertNotEqual(a, jl.jlist(range(20)))
+
+        counts = collections.Counter()
+        for seed in range(6000):
+            values = jl.jlist([1, 2, 3])
+            jl.shuffle(values, seed=seed)
+            counts[tuple(values)] += 1
+        self.assertEqual(len(counts), 6)
+        self.assertTrue(all(800 < count < 1200 for count in counts.values()), counts)
+
+        with self.assertRaises(TypeError):
+            jl.shuffle([1, 2])
+        with self.assertRaises(TypeError):
+            jl.shuffle(jl.freeze([1, 2]))
+
+    def test_shuffle_drops_index(self):
+        values = jl.jlist(range(10))
+        values.build_index()
+        jl.shuffle(values, seed=1)
+        self.assertFalse(values.indexed)
+        for value in range(10):
+            self.assertEqual(values[values.index(value)], value)
+
+    def test_sample(self):
+        for population in range(10), range(1000), ['a', 'b', 1.5, None]:
+            for k in 0, 1, 3, len(population):
+                result = jl.sample(population, k, seed=k)
+                self.assertIs(type(result), jl.jlist)
+                self.assertEqual(len(result), k)
+                self.assertEqual(len(set(map(repr, result))), k)
+                self.assertTrue(all(value in population for value in result))
+
+        self.assertEqual(jl.sample(range(50), 10, seed=2), jl.sample(range(50), 10, seed=2))
+        self.assertEqual(jl.sample(jl.jlist([1.5, 2.5]), 2).tag, 'double')
+
+        # every ordered pair is equally likely for both the dense and sparse methods
+        for size in 4, 40:
+            counts = collections.Counter(
+                tuple(jl.sample(range(size), 2, seed=seed)) for seed in range(20000)
+            )
+            self.assertEqual(len(counts), size * (size - 1))
+            expected = 20000 / (size * (size - 1))
+            self.assertTrue(all(count < 3 * expected + 10 for count in counts.values()))
+
+        with self.assertRaises(ValueError):
+            jl.sample([1, 2], 3)
+        with self.assertRaises(ValueError):
+            jl.sample([1, 2], -1)
+
+
+class ConstructorTestCase(TestCase):
+    def assert_floats_equal(self, actual, expected):
+        self.assertEqual(actual.tag, 'double')
+        self.assertEqual(len(actual), len(expected))
+        for a, b in zip(actual, expected):
+            self.assertIs(type(a), float)
+            self.assertAlmostEqual(a, b, places=12)
+
+    def test_arange(self):
+        cases = [
+            ((0, 1, 0.25), [0, 0.25, 0.5, 0.75]),
+            ((2.5,), [0, 1, 2]),
+            ((1, 0, -0.3), [1, 0.7, 0.4, 0.1]),
+            ((0, 1, 0.1), [i / 10 for i in range(10)]),
+            ((2, 1, 0.5), []),
+            ((-1.5, 1), [-1.5, -0.5, 0.5]),
+        ]
+        for args, expected in cases:
+            self.assert_floats_equal(jl.arange(*args), expected)
+
+        # each value is start + i * step, not a running sum
+        values = jl.arange(0, 100, 0.1)
+        self.assertEqual(values[-1], 0.1 * 999)
+
+        # all ints is jlist.range
+        for args in [(5,), (1, 5), (10, 0, -3)]:
+            result = jl.arange(*args)
+            self.assertEqual(result.tag, 'int')
+            self.assertEqual(list(result), list(range(*args)))
+
+        with self.assertRaises(ValueError):
+            jl.arange(0, 1, 0.0)
+        with self.assertRaises(ValueError):
+            jl.arange(math.inf)
+        with self.assertRaises(TypeError):
+            jl.arange('a', 1.0)
+
+    def test_linspace(self):
+        self.assert_floats_equal(jl.linspace(0, 1, 5), [0, 0.25, 0.5, 0.75, 1])
+        self.assert_floats_equal(
+            jl.linspace(0, 1, 4, endpoint=False),
+            [0, 0.25, 0.5, 0.75],
+        )
+        self.assert_floats_equal(jl.linspace(2, 3, 1), [2])
+        self.assert_floats_equal(jl.linspace(0, 1, 0), [])
+        self.assertEqual(len(jl.linspace(0, 1)), 50)
+
+        # the endpoint is exact even when the steps don't add up to it
+        self.assertEqual(jl.linspace(0, 0.3, 4)[-1], 0.3)
+        self.assertEqual(jl.linspace(1, -1, 3), jl.jlist([1.0, 0.0, -1.0]))
+
+        with self.assertRaises(ValueError):
+            jl.linspace(0, 1, -1)
+        with self.assertRaises(ValueError):
+            jl.linspace(0, math.nan)
+
+    def test_full(self):
+        for value, tag in [(7, 'int'), (1.5, 'double'), ('a', 'homogeneous_ob'),
+                           (2 ** 70, 'homogeneous_ob'), (True, 'homogeneous_ob')]:
+            result = jl.full(3, value)
+            self.assertEqual(result, jl.jlist([value] * 3))
+            self.assertEqual(result.tag, tag)
+            if tag == 'homogeneous_ob':
+                self.assertIs(result[0], value)
+
+        self.assertEqual(jl.full(0, 'a'), jl.jlist())
+
+        value = object()
+        before = sys.getrefcount(value)
+        values = jl.full(1000, value)
+        self.assertEqual(sys.getrefcount(value), before + 1000)
+        del values
+        self.assertEqual(sys.getrefcount(value), before)
+
+        with self.assertRaises(ValueError):
+            jl.full(-1, 0)
+        for value in 1, 1.5, 'a':
+            with self.assertRaises(MemoryError):
+                jl.full(2 ** 62, value)
+
+    def test_empty(self):
+        values = jl.empty(10)
+        self.assertEqual(values.tag, 'double')
+        self.assertEqual(len(values), 10)
+        values[3] = 2.5
+        self.assertEqual(values[3], 2.5)
+
+        values = jl.empty(5, 'int')
+        self.assertEqual(values.tag, 'int')
+        self.assertEqual(len(values), 5)
+
+        with self.assertRaises(ValueError):
+            jl.empty(5, 'object')
+        with self.assertRaises(ValueError):
+            jl.empty(-1)
+        for dtype in 'int', 'double':
+            with self.assertRaises(MemoryError):
+                jl.empty(2 ** 62, dtype)
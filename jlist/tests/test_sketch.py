@@ -0,0 +1,172 @@
+import math
+import pickle
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class DistinctSketchTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'distinct', 'little')
+
+    def assert_close(self, estimate, expected, tolerance=0.05):
+        self.assertLessEqual(abs(estimate - expected), tolerance * expected,
+                             (estimate, expected))
+
+    def test_small_counts_are_nearly_exact(self):
+        for n in [1, 2, 10, 100]:
+            self.assertEqual(round(jl.approx_distinct(jl.range(n))), n)
+        self.assertEqual(jl.approx_distinct([]), 0)
+
+    def test_estimate(self):
+        for n in [1000, 100000]:
+            self.assert_close(jl.approx_distinct(jl.range(n)), n)
+            self.assert_close(jl.approx_distinct(str(i) for i in range(n)), n)
+
+        values = jl.jlist(self.random.random() for _ in range(20000))
+        self.assert_close(jl.approx_distinct(values), 20000)
+
+    def test_duplicates(self):
+        values = jl.jlist(self.random.randrange(500) for _ in range(100000))
+        self.assert_close(jl.approx_distinct(values), len(set(values)))
+
+    def test_types(self):
+        # equal ints and floats are one value
+        self.assertEqual(
+            jl.distinct_sketch([1, 2, 3])._registers,
+            jl.distinct_sketch([1.0, 2.0, 3.0])._registers,
+        )
+        self.assertEqual(
+            round(jl.approx_distinct(['a', b'a', 1, 1.5, None, (1, 2), 'a'])),
+            6,
+        )
+
+        # ints beyond int64 are one value with the float they equal
+        wide = [2 ** 63, -2 ** 63 - 2048, 2 ** 70, 3 * 2 ** 100]
+        self.assertEqual(
+            jl.distinct_sketch(wide)._registers,
+            jl.distinct_sketch([float(value) for value in wide])._registers,
+        )
+        self.assertEqual(
+            jl.distinct_sketch([2 ** 70, 'a'])._registers,
+            jl.distinct_sketch([2.0 ** 70, 'a'])._registers,
+        )
+        self.assertEqual(round(jl.approx_distinct([2 ** 70, 2 ** 70 + 1])), 2)
+        with self.assertRaises(TypeError):
+            jl.approx_distinct([[1]])
+
+    def test_hash_changes_list(self):
+        class Refill:
+            def __init__(self, target):
+                self.target = target
+
+            def __hash__(self):
+                self.target.clear()
+                self.target.extend(range(100000))
+                return 0
+
+        values = jl.jlist()
+        values.extend([Refill(values), 'a', 'b', 'c'])
+        with self.assertRaises(RuntimeError):
+            jl.ops._hll_update(bytearray(16), values)
+
+        values = jl.jlist()
+        values.extend([Refill(values), 'a'])
+        with self.assertRaises(RuntimeError):
+            jl.approx_distinct(values)
+
+    def test_merge(self):
+        left = jl.distinct_sketch(jl.range(0, 60000))
+        right = jl.distinct_sketch(jl.range(40000, 100000))
+        self.assert_close((left | right).estimate(), 100000)
+        self.assert_close(left.estimate(), 60000)
+
+        left.merge(right)
+        self.assertEqual(left._registers,
+                         jl.distinct_sketch(jl.range(100000))._registers)
+
+        with self.assertRaises(ValueError):
+            left.merge(jl.distinct_sketch(precision=10))
+
+    def test_precision(self):
+        sketch = jl.distinct_sketch(precision=10)
+        self.assertEqual(sketch.precision, 10)
+        self.assertEqual(len(sketch._registers), 1024)
+        for precision in [3, 19]:
+            with self.assertRaises(ValueError):
+                jl.distinct_sketch(precision=precision)
+
+    def test_pickle(self):
+        sketch = jl.distinct_sketch(['a', 'b', 'c'], precision=8)
+        roundtripped = pickle.loads(pickle.dumps(sketch))
+        self.assertEqual(roundtripped._registers, sketch._registers)
+        self.assertEqual(roundtripped.estimate(), sketch.estimate())
+
+
+class QuantileSketchTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'quantile', 'little')
+
+    def assert_rank_close(self, values, qs, estimates, tolerance=0.02):
+        ordered = sorted(values)
+        for q, estimate in zip(qs, estimates):
+            rank = sum(1 for value in ordered if value <= estimate) / len(ordered)
+            self.assertLessEqual(abs(rank - q), tolerance, (q, estimate, rank))
+
+    def test_exact_until_compacted(self):
+        values = [self.random.random() for _ in range(150)]
+        qs = [0, 0.1, 0.25, 0.5, 0.9, 1]
+        self.assertEqual(jl.approx_quantiles(values, qs), jl.quantile(values, qs))
+        self.assertEqual(jl.approx_quantiles([1, 2, 3, 4], 0.5), 2.5)
+
+    def test_estimate(self):
+        values = jl.jlist(self.random.gauss(0, 1) for _ in range(200000))
+        qs = [0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99]
+        sketch = jl.quantile_sketch(values)
+        self.assertEqual(len(sketch), len(values))
+        self.assertLess(sum(map(len, sketch._levels)), 1000)
+        self.assert_rank_close(values, qs, sketch.quantiles(qs))
+
+        self.assertEqual(sketch.quantile(0), min(values))
+        self.assertEqual(sketch.quantile(1), max(values))
+
+    def test_ints_and_nans(self):
+        values = jl.range(100000)
+        self.assertEqual(jl.approx_quantiles(values, 1), 99999)
+        self.assert_rank_close(values, [0.5], [jl.approx_quantiles(values, 0.5)])
+
+        sketch = jl.quantile_sketch([1.0, math.nan, 3.0])
+        self.assertEqual(len(sketch), 2)
+        self.assertEqual(sketch.quantile(0.5), 2.0)
+
+    def test_merge(self):
+        left_values = [self.random.random() for _ in range(50000)]
+        right_values = [self.random.random() + 1 for _ in range(30000)]
+        left = jl.quantile_sketch(left_values)
+        right = jl.quantile_sketch(right_values)
+
+        merged = left | right
+        self.assertEqual(len(merged), 80000)
+        self.assertEqual(len(left), 50000)
+        qs = [0.1, 0.5, 0.625, 0.9]
+        self.assert_rank_close(left_values + right_values, qs, merged.quantiles(qs))
+        self.assertEqual(merged.quantile(1), max(right_values))
+
+        left.merge(left)
+        self.assertEqual(len(left), 100000)
+        self.assert_rank_close(left_values, qs, left.quantiles(qs))
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.quantile_sketch().quantile(0.5)
+        with self.assertRaises(ValueError):
+            jl.quantile_sketch([1]).quantile(1.5)
+        with self.assertRaises(TypeError):
+            jl.quantile_sketch(['a'])
+        with self.assertRaises(ValueError):
+            jl.quantile_sketch(k=4)
+
+    def test_pickle(self):
+        sketch = jl.quantile_sketch(self.random.random() for _ in range(10000))
+        roundtripped = pickle.loads(pickle.dumps(sketch))
+        qs = [0, 0.5, 0.9, 1]
+        self.assertEqual(roundtripped.quantiles(qs), sketch.quantiles(qs))
+        self.assertEqual(len(roundtripped), len(sketch))
@@ -0,0 +1,39 @@
+import sys
+from unittest import TestCase
+
+import jlist as jl
+
+
+class SetSliceTestCase(TestCase):
+    def test_empty_rhs_references(self):
+        empty = jl.jlist()
+        before = sys.getrefcount(empty)
+        for _ in range(10):
+            values = jl.jlist()
+            values[:] = empty
+        self.assertEqual(sys.getrefcount(empty), before)
+
+    def test_references(self):
+        value = object()
+        before = sys.getrefcount(value)
+        for _ in range(10):
+            values = jl.jlist()
+            values[:] = jl.jlist([value])
+            values[:] = values
+
+            # a failed extended slice assignment releases the rhs
+            values = jl.jlist(['a', 'b', 'c', 'd'])
+            with self.assertRaises(ValueError):
+                values[::2] = jl.jlist([value])
+            values = jl.jlist([1, 2, 3, 4])
+            with self.assertRaises(ValueError):
+                values[::2] = [value]
+        del values
+        self.assertEqual(sys.getrefcount(value), before)
+
+    def test_assign_into_empty(self):
+        values = jl.jlist()
+        values[:] = jl.jlist(['a', 'b'])
+        self.assertEqual(list(values), ['a', 'b'])
+        values[:] = []
+        self.assertEqual(list(values), [])
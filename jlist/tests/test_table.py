@@ -0,0 +1,147 @@
+from unittest import TestCase
+
+import jlist as jl
+from jlist.tests.seeded import SeededTestCase
+
+
+class UnzipTestCase(TestCase):
+    def test_unzip(self):
+        rows = [(1, 'a', 1.5), (2, 'b', 2.5), (3, 'c', 3.5)]
+        a, b, c = jl.unzip(rows, 3)
+        self.assertEqual(list(a), [1, 2, 3])
+        self.assertEqual(a.tag, 'int')
+        self.assertEqual(list(b), ['a', 'b', 'c'])
+        self.assertEqual(b.tag, 'homogeneous_ob')
+        self.assertEqual(list(c), [1.5, 2.5, 3.5])
+        self.assertEqual(c.tag, 'double')
+
+    def test_mixed(self):
+        a, = jl.unzip(iter([(1,), ('a',), (2.5,)]), 1)
+        self.assertEqual(list(a), [1, 'a', 2.5])
+        self.assertEqual(a.tag, 'heterogeneous_ob')
+
+    def test_empty(self):
+        self.assertEqual(jl.unzip([], 2), (jl.jlist(), jl.jlist()))
+        self.assertEqual(jl.unzip([(), ()], 0), ())
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            jl.unzip([(1, 2), (3,)], 2)
+        with self.assertRaises(TypeError):
+            jl.unzip([1, 2], 1)
+
+
+class FilterMaskTestCase(TestCase):
+    def test_filter_mask(self):
+        values = [1, 2, 3, 4]
+        for mask in ([True, False, True, False], [1, 0, 1, 0], [1.0, 0.0, 2.0, 0.0]):
+            out = jl.filter_mask(jl.jlist(values), jl.jlist(mask))
+            self.assertEqual(list(out), [1, 3])
+            self.assertEqual(out.tag, 'int')
+
+        out = jl.filter_mask(['a', 'b'], [[], [1]])
+        self.assertEqual(list(out), ['b'])
+        self.assertEqual(out.tag, 'homogeneous_ob')
+
+    def test_length_mismatch(self):
+        with self.assertRaises(ValueError):
+            jl.filter_mask([1, 2], [True])
+
+    def test_mask_changed(self):
+        class Refill:
+            def __init__(self, target):
+                self.target = target
+
+            def __bool__(self):
+                self.target.clear()
+                self.target.extend(range(100000))
+                return True
+
+        mask = jl.jlist()
+        mask.extend([Refill(mask), [], [], []])
+        with self.assertRaises(RuntimeError):
+            jl.filter_mask(jl.jlist([1, 2, 3, 4]), mask)
+
+        values = jl.jlist([1, 2, 3, 4])
+        with self.assertRaises(RuntimeError):
+            jl.filter_mask(values, [Refill(values), [], [], []])
+
+
+class JtableTestCase(SeededTestCase):
+    RANDOM_SEED = int.from_bytes(b'jtable', 'little')
+
+    def rows(self, n):
+        return [
+            (ix, self.random.choice('abc'), self.random.randrange(5) / 2)
+            for ix in range(n)
+        ]
+
+    def test_from_rows(self):
+        rows = self.rows(20)
+        t = jl.jtable.from_rows(rows, ['id', 'name', 'score'])
+        self.assertEqual(len(t), 20)
+        self.assertEqual(t.names, ('id', 'name', 'score'))
+        self.assertEqual(t['id'].tag, 'int')
+        self.assertEqual(t['score'].tag, 'double')
+        self.assertEqual(list(t.rows()), rows)
+
+    def test_row_view(self):
+        t = jl.jtable({'a': [1, 2], 'b': ['x', 'y']})
+        rows = list(t)
+        self.assertEqual(rows[1].a, 2)
+        self.assertEqual(rows[1]['b'], 'y')
+        self.assertEqual(rows[0], (1, 'x'))
+        self.assertEqual(tuple(rows[0]), (1, 'x'))
+        with self.assertRaises(AttributeError):
+            rows[0].c
+
+    def test_sort_by(self):
+        rows = self.rows(50)
+        t = jl.jtable.from_rows(rows, ['id', 'name', 'score'])
+        for key, name in ((2, 'score'), (1, 'name')):
+            for reverse in (False, True):
+                expected = sorted(rows, key=lambda r: r[key], reverse=reverse)
+                actual = t.sort_by(name, reverse=reverse)
+                self.assertEqual(list(actual.rows()), expected)
+
+    def test_filter(self):
+        rows = self.rows(30)
+        t = jl.jtable.from_rows(rows, ['id', 'name', 'score'])
+        mask = [name == 'a' for _, name, _ in rows]
+        self.assertEqual(
+            list(t.filter(mask).rows()),
+            [r for r in rows if r[1] == 'a'],
+        )
+
+    def test_mismatched_columns(self):
+        with self.assertRaises(ValueError):
+            jl.jtable({'a': [1, 2], 'b': [1]})
+
+    def test_shared_columns(self):
+        a = jl.jlist([1, 2])
+        b = jl.jlist(['x', 'y'])
+        t = jl.jtable({'a': a, 'b': b})
+        self.assertIs(t['a'], a)
+
+        a.append(3)
+        b.append('z')
+        self.assertEqual(len(t), 3)
+        self.assertEqual([r.b for r in t], ['x', 'y', 'z'])
+        self.assertEqual(list(t.filter([True, False, True]).rows()),
+                         [(1, 'x'), (3, 'z')])
+
+        a.append(4)
+        with self.assertRaises(ValueError):
+            len(t)
+        with self.assertRaises(ValueError):
+            list(t.rows())
+
+        values = [1, 2]
+        t = jl.jtable({'a': values})
+        values.append(3)
+        self.assertEqual(len(t), 2)
+
+    def test_empty(self):
+        t = jl.jtable({})
+        self.assertEqual(len(t), 0)
+        self.assertEqual(list(t), [])
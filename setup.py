@@ -66,12 +66,12 @@ setup(
         extension(
             'jlist.jlist',
             ['jlist/jlist.cc'],
-            depends=['jlist/jlist.h'],
+            depends=['jlist/jlist.h', 'jlist/int_hash_table.h', 'jlist/mix64.h'],
         ),
         extension(
             'jlist.ops',
             ['jlist/ops.cc'],
-            depends=['jlist/jlist.h'],
+            depends=['jlist/jlist.h', 'jlist/int_hash_table.h', 'jlist/mix64.h'],
         ),
     ],
 )